@@ -117,10 +117,12 @@
 #include <atomic>
 #include <cmath>
 #include <cstring>
+#include <deque>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string>
 #include <vector>
@@ -211,6 +213,10 @@
 #endif
 #endif
 
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define JSON_STRUCT_LITTLE_ENDIAN 1
+#endif
+
 #if defined(__GNUC__) || defined(__clang__)
 #define JSON_STRUCT_LIKELY(x) __builtin_expect(!!(x), 1)
 #define JSON_STRUCT_UNLIKELY(x) __builtin_expect(!!(x), 0)
@@ -1366,11 +1372,14 @@ public:
   void addData(const std::vector<Token> *parsedData);
   void resetData(const char *data, size_t size, size_t index);
   void resetData(const std::vector<Token> *parsedData, size_t index);
+  void reset();
   size_t registeredBuffers() const;
 
   void setNeedMoreDataCallback(std::function<void(Tokenizer &)> callback);
   void setReleaseCallback(std::function<void(const char *)> &callback);
   Error nextToken(Token &next_token);
+  template <typename F>
+  bool scanNumberArray(Token &token, F &&on_number);
   const char *currentPosition() const;
 
   void copyFromValue(const Token &token, std::string &to_buffer);
@@ -1463,6 +1472,18 @@ constexpr StringLiteral<SIZE - 1> makeStringLiteral(const char (&literal)[SIZE])
 }
 } // namespace Internal
 
+/*!
+ * How floating point values are written. Shortest writes the shortest representation that parses back to the same
+ * value. FixedDecimals rounds to at most precision digits after the decimal point, and SignificantDigits rounds to at
+ * most precision significant digits. Rounding is done on the exact binary value and trailing zeros are not written.
+ */
+enum class FloatFormat : unsigned char
+{
+  Shortest,
+  FixedDecimals,
+  SignificantDigits
+};
+
 class SerializerOptions
 {
 public:
@@ -1483,9 +1504,18 @@ public:
   bool convertAsciiToString() const;
   void setConvertAsciiToString(bool set);
 
+  // Write every non-ASCII code point in strings as \uXXXX, or as a surrogate pair, so the output is 7-bit clean.
+  // Invalid UTF-8 is written as \ufffd.
+  bool escapeNonAscii() const;
+  void setEscapeNonAscii(bool set);
+
   unsigned char depth() const;
   void setDepth(int depth);
 
+  FloatFormat floatFormat() const;
+  int floatPrecision() const;
+  void setFloatFormat(FloatFormat format, int precision = 6);
+
   void skipDelimiter(bool skip);
 
   const std::string &prefix() const;
@@ -1498,6 +1528,9 @@ private:
   uint8_t m_depth;
   Style m_style;
   bool m_convert_ascii_to_string;
+  bool m_escape_non_ascii;
+  FloatFormat m_float_format;
+  uint8_t m_float_precision;
 
   std::string m_prefix;
   std::string m_token_delimiter;
@@ -1540,12 +1573,14 @@ public:
 
   void setBuffer(char *buffer, size_t size);
   void setOptions(const SerializerOptions &option);
-  SerializerOptions options() const
+  const SerializerOptions &options() const
   {
     return m_option;
   }
 
   bool write(const Token &token);
+  // Like write(const Token &), but a Type::String value is JSON escaped while it is copied to the output.
+  bool writeEscaped(const Token &token);
   bool write(const char *data, size_t size);
   bool write(const std::string &str)
   {
@@ -1553,24 +1588,301 @@ public:
   }
   template <size_t SIZE>
   inline bool write(const Internal::StringLiteral<SIZE> &strLiteral);
+  template <typename F>
+  bool writeArrayElements(size_t count, size_t max_element_size, F &&format);
 
   void setRequestBufferCallback(std::function<void(Serializer &)> callback);
   const SerializerBuffer &currentBuffer() const;
 
+  /*!
+   * \private
+   * Set by the JS_OBJ member serialization to the member's pre-quoted key. The next token whose name points into it is
+   * written with the key instead of quoting the name.
+   */
+  void setMemberKey(const char *key)
+  {
+    m_member_key = key;
+  }
+
+  /*!
+   * When set, JS_OBJ types only write the members that hold dirty Tracked values, see JS::serializeDelta.
+   */
+  bool deltaOnly() const
+  {
+    return m_delta_only;
+  }
+  void setDeltaOnly(bool set)
+  {
+    m_delta_only = set;
+  }
+
 private:
   void askForMoreBuffers();
   void markCurrentSerializerBufferFull();
   bool writeAsString(const DataRef &data);
   bool write(Type type, const DataRef &data);
+  bool writeCompact(const Token &token);
+  bool writeEscapedString(const DataRef &data, bool escape_json);
+  bool writeValue(const Token &token)
+  {
+    if (token.value_type == Type::String && (m_escape_value || m_option.escapeNonAscii()))
+      return writeEscapedString(token.value, m_escape_value);
+    return write(token.value_type, token.value);
+  }
+  bool isQuoted(Type type) const
+  {
+    return type == Type::String || (type == Type::Ascii && m_option.convertAsciiToString());
+  }
+  const char *takeMemberKey(const Token &token)
+  {
+    const char *key = m_member_key;
+    m_member_key = nullptr;
+    // Pre-baked keys are written as they are, so they can not be used when names need escaping
+    if (key && token.name.data == key + 1 && token.name_type == Type::Ascii && m_option.convertAsciiToString() &&
+        !m_option.escapeNonAscii())
+      return key;
+    return nullptr;
+  }
 
   std::function<void(Serializer &)> m_request_buffer_callback;
   SerializerBuffer m_current_buffer;
+  const char *m_member_key;
 
   bool m_first;
   bool m_token_start;
+  bool m_compact;
+  bool m_escape_value;
+  bool m_delta_only;
   SerializerOptions m_option;
 };
 
+/*!
+ * Where a Serializer writes its output. attach() hands the serializer the sink's first buffer and asks the sink for a
+ * new one every time the serializer fills it up. finish() has to be called when serialization is done, to commit the
+ * bytes written to the last buffer. failed() is set when the sink could not take more output, and the serializer's
+ * writes fail from that point on.
+ *
+ * A sink has to outlive the serializers attached to it, and can not be copied.
+ */
+class OutputSink
+{
+public:
+  OutputSink()
+    : m_committed(0)
+    , m_failed(false)
+  {
+  }
+  OutputSink(const OutputSink &) = delete;
+  OutputSink &operator=(const OutputSink &) = delete;
+  virtual ~OutputSink()
+  {
+  }
+
+  void attach(Serializer &serializer);
+  bool finish(Serializer &serializer);
+  // Hands the rest of the current buffer back, the next write asks nextBuffer() for a new one. Call it after a
+  // finish() that is followed by more output when flush() gives up the storage, like StringSink does.
+  void releaseBuffer(Serializer &serializer);
+  bool failed() const
+  {
+    return m_failed;
+  }
+
+protected:
+  // Returns the buffer to write into next, or an empty buffer when the sink can not take more output.
+  virtual SerializerBuffer nextBuffer() = 0;
+  // data and size is output written to the last buffer returned by nextBuffer.
+  virtual bool commit(const char *data, size_t size) = 0;
+  virtual bool flush()
+  {
+    return true;
+  }
+
+private:
+  void commitUpTo(size_t used);
+  void advance(Serializer &serializer);
+
+  SerializerBuffer m_buffer;
+  size_t m_committed;
+  bool m_failed;
+};
+
+/*!
+ * Writes into a std::string that is grown by doubling its size. Use it when the output has to end up in a
+ * std::string, otherwise BufferSink avoids zero filling the new space.
+ */
+class StringSink : public OutputSink
+{
+public:
+  explicit StringSink(std::string &out)
+    : m_out(out)
+    , m_size(0)
+  {
+  }
+
+protected:
+  SerializerBuffer nextBuffer() override;
+  bool commit(const char *data, size_t size) override;
+  bool flush() override;
+
+private:
+  std::string &m_out;
+  size_t m_size;
+};
+
+/*!
+ * Writes into a heap buffer that grows by doubling. Unlike a std::string the new space is not zero filled.
+ */
+class BufferSink : public OutputSink
+{
+public:
+  explicit BufferSink(size_t initial_capacity = 4096)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_capacity(0)
+    , m_initial_capacity(std::max(initial_capacity, size_t(1)))
+  {
+  }
+  ~BufferSink() override
+  {
+    free(m_data);
+  }
+
+  const char *data() const
+  {
+    return m_data;
+  }
+  size_t size() const
+  {
+    return m_size;
+  }
+  std::string toString() const
+  {
+    return std::string(m_data ? m_data : "", m_size);
+  }
+  // Keeps the allocation, so the sink can be reused for the next document.
+  void clear()
+  {
+    m_size = 0;
+  }
+
+protected:
+  SerializerBuffer nextBuffer() override;
+  bool commit(const char *data, size_t size) override;
+
+private:
+  char *m_data;
+  size_t m_size;
+  size_t m_capacity;
+  size_t m_initial_capacity;
+};
+
+/*!
+ * Writes into a fixed caller owned buffer. When the output does not fit, the sink fails and the buffer holds as much
+ * of the output as fits.
+ */
+class FixedBufferSink : public OutputSink
+{
+public:
+  FixedBufferSink(char *buffer, size_t size)
+    : m_buffer(buffer)
+    , m_capacity(size)
+    , m_size(0)
+  {
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+  bool overflow() const
+  {
+    return failed();
+  }
+
+protected:
+  SerializerBuffer nextBuffer() override;
+  bool commit(const char *data, size_t size) override;
+
+private:
+  char *m_buffer;
+  size_t m_capacity;
+  size_t m_size;
+};
+
+/*!
+ * Writes into a list of fixed size segments. Output is never moved when it grows, and the segments can be handed to
+ * a gather write as they are.
+ */
+class SegmentedSink : public OutputSink
+{
+public:
+  explicit SegmentedSink(size_t segment_size = 64 * 1024)
+    : m_segment_size(std::max(segment_size, size_t(1)))
+    , m_size(0)
+  {
+  }
+
+  size_t segmentCount() const
+  {
+    return m_segments.size();
+  }
+  DataRef segment(size_t index) const
+  {
+    return DataRef(m_segments[index].first.get(), m_segments[index].second);
+  }
+  size_t size() const
+  {
+    return m_size;
+  }
+  std::string toString() const;
+  void clear()
+  {
+    m_segments.clear();
+    m_size = 0;
+  }
+
+protected:
+  SerializerBuffer nextBuffer() override;
+  bool commit(const char *data, size_t size) override;
+
+private:
+  size_t m_segment_size;
+  size_t m_size;
+  std::vector<std::pair<std::unique_ptr<char[]>, size_t>> m_segments;
+};
+
+/*!
+ * Writes to a FILE * with fwrite every time its buffer fills up. finish() writes the rest, but does not fflush the
+ * file.
+ */
+class FileSink : public OutputSink
+{
+public:
+  explicit FileSink(FILE *file, size_t buffer_size = 64 * 1024)
+    : m_file(file)
+    , m_buffer(new char[std::max(buffer_size, size_t(1))])
+    , m_buffer_size(std::max(buffer_size, size_t(1)))
+    , m_written(0)
+  {
+  }
+
+  size_t written() const
+  {
+    return m_written;
+  }
+
+protected:
+  SerializerBuffer nextBuffer() override;
+  bool commit(const char *data, size_t size) override;
+
+private:
+  FILE *m_file;
+  std::unique_ptr<char[]> m_buffer;
+  size_t m_buffer_size;
+  size_t m_written;
+};
+
 // IMPLEMENTATION
 
 inline Token::Token()
@@ -1669,6 +1981,28 @@ inline void Tokenizer::resetData(const std::vector<Token> *parsedData, size_t in
   resetForNewToken();
 }
 
+inline void Tokenizer::reset()
+{
+  if (release_callback)
+  {
+    for (auto &data_buffer : data_list)
+      release_callback(data_buffer.data);
+  }
+  data_list.clear();
+  parsed_data_vector = nullptr;
+  cursor_index = 0;
+  token_state = InTokenState::FindingName;
+  is_escaped = false;
+  expecting_prop_or_anonymous_data = false;
+  continue_after_need_more_data = false;
+  scope_counter.clear();
+  container_stack.clear();
+  copy_buffers.clear();
+  error_context.clear();
+  error_context.custom_message.clear();
+  resetForNewToken();
+}
+
 inline size_t Tokenizer::registeredBuffers() const
 {
   return data_list.size();
@@ -1767,6 +2101,67 @@ inline Error Tokenizer::nextToken(Token &next_token)
   return error;
 }
 
+/*!
+ * Bulk path for arrays of plain numbers, called right after the ArrayStart token. Elements are scanned straight
+ * from the current data buffer and handed to on_number(const char *data, size_t size), which returns false to
+ * reject an element. Returns true when the whole array was consumed, in which case token is the ArrayEnd token.
+ * Otherwise the tokenizer is left at the start of the first element it did not consume, so nextToken continues
+ * from there; that happens for anything besides numbers, commas and whitespace, and at buffer boundaries.
+ */
+template <typename F>
+inline bool Tokenizer::scanNumberArray(Token &token, F &&on_number)
+{
+  if (parsed_data_vector || data_list.empty() || continue_after_need_more_data || allow_new_lines ||
+      token_state != InTokenState::FindingName || container_stack.empty() ||
+      container_stack.back() != Type::ArrayStart)
+    return false;
+  if (scope_counter.size() &&
+      (scope_counter.back().depth == 0 ||
+       (scope_counter.back().type != Type::ArrayStart && scope_counter.back().type != Type::ObjectStart)))
+    return false;
+
+  resetForNewToken();
+  const DataRef &json_data = data_list.front();
+  const char *data = json_data.data;
+  const size_t size = json_data.size;
+  const unsigned char *lookup = Internal::lookup();
+  size_t pos = cursor_index;
+  while (pos < size && (lookup[(unsigned char)data[pos]] & Internal::WhiteSpaceOrNull))
+    pos++;
+  bool array_end = pos < size && data[pos] == ']';
+  while (!array_end)
+  {
+    if (pos >= size || !(data[pos] == '-' || (lookup[(unsigned char)data[pos]] & Internal::Digits)))
+      return false;
+    const size_t number_start = pos;
+    pos++;
+    while (pos < size && (lookup[(unsigned char)data[pos]] & Internal::NumberEnd))
+      pos++;
+    const size_t number_end = pos;
+    while (pos < size && (lookup[(unsigned char)data[pos]] & Internal::WhiteSpaceOrNull))
+      pos++;
+    if (pos >= size || (data[pos] != ',' && data[pos] != ']'))
+      return false;
+    if (!on_number(data + number_start, number_end - number_start))
+      return false;
+    array_end = data[pos] == ']';
+    if (!array_end)
+    {
+      cursor_index = ++pos;
+      while (pos < size && (lookup[(unsigned char)data[pos]] & Internal::WhiteSpaceOrNull))
+        pos++;
+    }
+  }
+
+  cursor_index = pos + 1;
+  populate_anonymous_token(DataRef(data + pos, 1), Type::ArrayEnd, token);
+  token_state = InTokenState::FindingTokenEnd;
+  container_stack.pop_back();
+  if (scope_counter.size())
+    scope_counter.back().handleType(Type::ArrayEnd);
+  return true;
+}
+
 inline const char *Tokenizer::currentPosition() const
 {
   if (parsed_data_vector)
@@ -2902,8 +3297,12 @@ JSON_STRUCT_COLD inline Error Tokenizer::updateErrorContext(Error error, const s
   return error;
 }
 
-static inline JS::Error reformat(const char *data, size_t size, std::string &out,
-                                 const SerializerOptions &options = SerializerOptions())
+namespace Internal
+{
+static inline bool reformatRaw(const char *data, size_t size, std::string &out, const SerializerOptions &options);
+
+static inline JS::Error reformatTokens(const char *data, size_t size, std::string &out,
+                                       const SerializerOptions &options)
 {
   Token token;
   Tokenizer tokenizer;
@@ -2912,16 +3311,8 @@ static inline JS::Error reformat(const char *data, size_t size, std::string &out
 
   Serializer serializer;
   serializer.setOptions(options);
-  size_t last_pos = 0;
-  serializer.setRequestBufferCallback([&out, &last_pos](Serializer &serializer_p) {
-    size_t end = out.size();
-    out.resize(end * 2);
-    serializer_p.setBuffer(&out[0] + end, end);
-    last_pos = end;
-  });
-  if (out.empty())
-    out.resize(4096);
-  serializer.setBuffer(&out[0], out.size());
+  StringSink sink(out);
+  sink.attach(serializer);
 
   while (error == Error::NoError)
   {
@@ -2930,12 +3321,21 @@ static inline JS::Error reformat(const char *data, size_t size, std::string &out
       break;
     serializer.write(token);
   }
-  out.resize(last_pos + serializer.currentBuffer().used);
+  sink.finish(serializer);
   if (error == Error::NeedMoreData)
     return Error::NoError;
 
   return error;
 }
+} // namespace Internal
+
+static inline JS::Error reformat(const char *data, size_t size, std::string &out,
+                                 const SerializerOptions &options = SerializerOptions())
+{
+  if (Internal::reformatRaw(data, size, out, options))
+    return Error::NoError;
+  return Internal::reformatTokens(data, size, out, options);
+}
 static inline JS::Error reformat(const std::string &in, std::string &out,
                                  const SerializerOptions &options = SerializerOptions())
 {
@@ -3098,6 +3498,9 @@ inline SerializerOptions::SerializerOptions(Style style)
   , m_depth(0)
   , m_style(style)
   , m_convert_ascii_to_string(true)
+  , m_escape_non_ascii(false)
+  , m_float_format(FloatFormat::Shortest)
+  , m_float_precision(6)
   , m_token_delimiter(",")
   , m_value_delimiter(style == Pretty ? ": " : ":")
   , m_postfix(style == Pretty ? "\n" : "")
@@ -3134,6 +3537,32 @@ inline void SerializerOptions::setConvertAsciiToString(bool set)
   m_convert_ascii_to_string = set;
 }
 
+inline bool SerializerOptions::escapeNonAscii() const
+{
+  return m_escape_non_ascii;
+}
+
+inline void SerializerOptions::setEscapeNonAscii(bool set)
+{
+  m_escape_non_ascii = set;
+}
+
+inline FloatFormat SerializerOptions::floatFormat() const
+{
+  return m_float_format;
+}
+
+inline int SerializerOptions::floatPrecision() const
+{
+  return m_float_precision;
+}
+
+inline void SerializerOptions::setFloatFormat(FloatFormat format, int precision)
+{
+  m_float_format = format;
+  m_float_precision = uint8_t(std::min(std::max(precision, 0), 255));
+}
+
 inline void SerializerOptions::setStyle(Style style)
 {
   m_style = style;
@@ -3153,7 +3582,10 @@ inline void SerializerOptions::skipDelimiter(bool skip)
 inline void SerializerOptions::setDepth(int depth)
 {
   m_depth = (unsigned char)depth;
-  m_prefix = m_style == Pretty ? std::string(depth * size_t(m_shift_size), ' ') : std::string();
+  if (m_style == Pretty)
+    m_prefix.assign(depth * size_t(m_shift_size), ' ');
+  else
+    m_prefix.clear();
 }
 
 inline const std::string &SerializerOptions::prefix() const
@@ -3189,16 +3621,23 @@ inline void SerializerBuffer::append(const char *data)
 }
 
 inline Serializer::Serializer()
-  : m_first(true)
+  : m_member_key(nullptr)
+  , m_first(true)
   , m_token_start(true)
+  , m_compact(false)
+  , m_escape_value(false)
+  , m_delta_only(false)
 {
 }
 
 inline Serializer::Serializer(char *buffer, size_t size)
   : m_current_buffer(buffer, size)
+  , m_member_key(nullptr)
   , m_first(true)
   , m_token_start(true)
-
+  , m_compact(false)
+  , m_escape_value(false)
+  , m_delta_only(false)
 {
 }
 
@@ -3210,10 +3649,17 @@ inline void Serializer::setBuffer(char *buffer, size_t size)
 inline void Serializer::setOptions(const SerializerOptions &option)
 {
   m_option = option;
+  // Compact output without a custom delimiter, prefix or postfix never needs the layout logic in write(const Token &)
+  m_compact = m_option.style() == SerializerOptions::Compact && m_option.shiftSize() != 2 &&
+              m_option.tokenDelimiter() == "," && m_option.prefix().empty() && m_option.postfix().empty() &&
+              !m_option.escapeNonAscii();
 }
 
 inline bool Serializer::write(const Token &in_token)
 {
+  if (m_compact)
+    return writeCompact(in_token);
+
   auto begining_literals =
     makeTuple(JS::Internal::makeStringLiteral("\n  "), Internal::makeStringLiteral("\n    "),
               Internal::makeStringLiteral("\n      "), Internal::makeStringLiteral("\n        "),
@@ -3310,22 +3756,36 @@ inline bool Serializer::write(const Token &in_token)
   }
   if (token.name.size)
   {
-    if (!write(token.name_type, token.name))
-      return false;
-
-    if (m_option.style() == SerializerOptions::Pretty)
+    const char *key = takeMemberKey(token);
+    if (key)
     {
-      if (!write(Internal::makeStringLiteral(": ")))
+      if (!write(key, token.name.size + (m_option.style() == SerializerOptions::Pretty ? 4 : 3)))
         return false;
     }
     else
     {
-      if (!write(Internal::makeStringLiteral(":")))
+      if (m_option.escapeNonAscii() && isQuoted(token.name_type))
+      {
+        if (!writeEscapedString(token.name, false))
+          return false;
+      }
+      else if (!write(token.name_type, token.name))
         return false;
+
+      if (m_option.style() == SerializerOptions::Pretty)
+      {
+        if (!write(Internal::makeStringLiteral(": ")))
+          return false;
+      }
+      else
+      {
+        if (!write(Internal::makeStringLiteral(":")))
+          return false;
+      }
     }
   }
 
-  if (!write(token.value_type, token.value))
+  if (!writeValue(token))
     return false;
 
   m_token_start = (token.value_type == Type::ObjectStart || token.value_type == Type::ArrayStart);
@@ -3336,23 +3796,121 @@ inline bool Serializer::write(const Token &in_token)
   return true;
 }
 
-inline void Serializer::setRequestBufferCallback(std::function<void(Serializer &)> callback)
+inline bool Serializer::writeEscaped(const Token &token)
 {
-  m_request_buffer_callback = callback;
+  m_escape_value = true;
+  bool written = write(token);
+  m_escape_value = false;
+  return written;
 }
 
-inline const SerializerBuffer &Serializer::currentBuffer() const
+/*!
+ * The write(const Token &) path for compact options. The delimiter, name and value are written with a single buffer
+ * check when they fit in the current buffer.
+ */
+inline bool Serializer::writeCompact(const Token &token)
 {
-  return m_current_buffer;
-}
+  const bool is_end = token.value_type == Type::ObjectEnd || token.value_type == Type::ArrayEnd;
+  if (is_end)
+  {
+    if (m_option.depth() <= 0)
+      return false;
+    m_option.setDepth(m_option.depth() - 1);
+  }
 
-inline void Serializer::askForMoreBuffers()
-{
-  if (m_request_buffer_callback)
-    m_request_buffer_callback(*this);
-}
+  const size_t delimiter = !m_token_start && !is_end;
+  const char *key = token.name.size ? takeMemberKey(token) : nullptr;
+  const size_t name_quotes = token.name.size && isQuoted(token.name_type) ? 2 : 0;
+  // Escaped strings are written by writeEscapedString once the delimiter and name are out
+  const bool escape = m_escape_value && token.value_type == Type::String;
+  const size_t value_quotes = !escape && isQuoted(token.value_type) ? 2 : 0;
+  const bool is_null = token.value_type == Type::Null;
+  const size_t value_size = escape ? 0 : is_null ? 4 : token.value.size;
+  const size_t size =
+    delimiter + (token.name.size ? name_quotes + token.name.size + 1 : 0) + value_quotes + value_size;
+  // Short keys are copied as a whole 16 or 32 byte block, which may write past size
+  const size_t slack = key ? 32 : 0;
+  if (JSON_STRUCT_LIKELY(m_current_buffer.free() >= size + slack))
+  {
+    char *target = m_current_buffer.buffer + m_current_buffer.used;
+    if (delimiter)
+      *target++ = ',';
+    if (key)
+    {
+      const size_t key_size = token.name.size + 3;
+      if (key_size <= 16)
+        memcpy(target, key, 16);
+      else if (key_size <= 32)
+        memcpy(target, key, 32);
+      else
+        memcpy(target, key, key_size);
+      target += key_size;
+    }
+    else if (token.name.size)
+    {
+      if (name_quotes)
+        *target++ = '"';
+      memcpy(target, token.name.data, token.name.size);
+      target += token.name.size;
+      if (name_quotes)
+        *target++ = '"';
+      *target++ = ':';
+    }
+    if (value_quotes)
+      *target++ = '"';
+    if (is_null)
+      memcpy(target, "null", 4);
+    else if (value_size)
+      memcpy(target, token.value.data, value_size);
+    target += value_size;
+    if (value_quotes)
+      *target++ = '"';
+    m_current_buffer.used = size_t(target - m_current_buffer.buffer);
+  }
+  else
+  {
+    if (delimiter && !write(Internal::makeStringLiteral(",")))
+      return false;
+    if (key)
+    {
+      if (!write(key, token.name.size + 3))
+        return false;
+    }
+    else if (token.name.size)
+    {
+      if (!write(token.name_type, token.name) || !write(Internal::makeStringLiteral(":")))
+        return false;
+    }
+    if (!escape && !write(token.value_type, token.value))
+      return false;
+  }
+  if (escape && !writeEscapedString(token.value, true))
+    return false;
 
-inline void Serializer::markCurrentSerializerBufferFull()
+  m_first = false;
+  m_token_start = (token.value_type == Type::ObjectStart || token.value_type == Type::ArrayStart);
+  if (m_token_start)
+    m_option.setDepth(m_option.depth() + 1);
+  return true;
+}
+
+inline void Serializer::setRequestBufferCallback(std::function<void(Serializer &)> callback)
+{
+  m_request_buffer_callback = callback;
+}
+
+inline const SerializerBuffer &Serializer::currentBuffer() const
+{
+  return m_current_buffer;
+}
+
+inline void Serializer::askForMoreBuffers()
+{
+  if (m_request_buffer_callback)
+    m_request_buffer_callback(*this);
+}
+
+inline void Serializer::markCurrentSerializerBufferFull()
 {
   m_current_buffer = SerializerBuffer();
   askForMoreBuffers();
@@ -3430,6 +3988,178 @@ inline bool Serializer::write(const Internal::StringLiteral<SIZE> &strLiteral)
   return true;
 }
 
+/*!
+ * Bulk path for writing the elements of an array after its ArrayStart token. format(size_t index, char *target)
+ * writes element index to target, which has room for max_element_size bytes, and returns the number of bytes
+ * written. Elements and delimiters go straight into the current buffer while it has room. Returns false without
+ * writing anything when the options need per token layout, in which case the elements have to be written as tokens.
+ */
+template <typename F>
+inline bool Serializer::writeArrayElements(size_t count, size_t max_element_size, F &&format)
+{
+  if (m_option.shiftSize() == 2 || !m_option.prefix().empty() || !m_option.postfix().empty() ||
+      m_option.tokenDelimiter().empty())
+    return false;
+  char overflow[64];
+  assert(max_element_size < sizeof(overflow));
+  for (size_t i = 0; i < count; i++)
+  {
+    const size_t delimiter = !m_token_start || i;
+    if (JSON_STRUCT_LIKELY(m_current_buffer.free() >= max_element_size + 1))
+    {
+      char *target = m_current_buffer.buffer + m_current_buffer.used;
+      if (delimiter)
+        *target++ = ',';
+      m_current_buffer.used += delimiter + size_t(format(i, target));
+    }
+    else
+    {
+      overflow[0] = ',';
+      size_t size = size_t(format(i, overflow + 1));
+      write(overflow + !delimiter, size + delimiter);
+    }
+  }
+  if (count)
+    m_token_start = false;
+  return true;
+}
+
+inline void OutputSink::attach(Serializer &serializer)
+{
+  serializer.setRequestBufferCallback([this](Serializer &serializer_p) {
+    // The serializer only asks for a new buffer when the current one is full
+    commitUpTo(m_buffer.size);
+    advance(serializer_p);
+  });
+  advance(serializer);
+}
+
+inline bool OutputSink::finish(Serializer &serializer)
+{
+  commitUpTo(serializer.currentBuffer().used);
+  if (!m_failed && !flush())
+    m_failed = true;
+  return !m_failed;
+}
+
+inline void OutputSink::commitUpTo(size_t used)
+{
+  if (m_failed || used <= m_committed)
+    return;
+  if (!commit(m_buffer.buffer + m_committed, used - m_committed))
+    m_failed = true;
+  m_committed = used;
+}
+
+inline void OutputSink::releaseBuffer(Serializer &serializer)
+{
+  m_buffer = SerializerBuffer();
+  m_committed = 0;
+  serializer.setBuffer(nullptr, 0);
+}
+
+inline void OutputSink::advance(Serializer &serializer)
+{
+  m_buffer = m_failed ? SerializerBuffer() : nextBuffer();
+  m_committed = 0;
+  if (!m_buffer.size)
+    m_failed = true;
+  serializer.setBuffer(m_buffer.buffer, m_buffer.size);
+}
+
+inline SerializerBuffer StringSink::nextBuffer()
+{
+  if (m_size >= m_out.size())
+    m_out.resize(std::max(m_size * 2, size_t(4096)));
+  return SerializerBuffer(&m_out[0] + m_size, m_out.size() - m_size);
+}
+
+inline bool StringSink::commit(const char *data, size_t size)
+{
+  JS_UNUSED(data);
+  m_size += size;
+  return true;
+}
+
+inline bool StringSink::flush()
+{
+  m_out.resize(m_size);
+  return true;
+}
+
+inline SerializerBuffer BufferSink::nextBuffer()
+{
+  if (m_size == m_capacity)
+  {
+    size_t capacity = m_capacity ? m_capacity * 2 : m_initial_capacity;
+    char *data = static_cast<char *>(realloc(m_data, capacity));
+    if (!data)
+      return SerializerBuffer();
+    m_data = data;
+    m_capacity = capacity;
+  }
+  return SerializerBuffer(m_data + m_size, m_capacity - m_size);
+}
+
+inline bool BufferSink::commit(const char *data, size_t size)
+{
+  JS_UNUSED(data);
+  m_size += size;
+  return true;
+}
+
+inline SerializerBuffer FixedBufferSink::nextBuffer()
+{
+  if (m_size == m_capacity)
+    return SerializerBuffer();
+  return SerializerBuffer(m_buffer + m_size, m_capacity - m_size);
+}
+
+inline bool FixedBufferSink::commit(const char *data, size_t size)
+{
+  JS_UNUSED(data);
+  m_size += size;
+  return true;
+}
+
+inline SerializerBuffer SegmentedSink::nextBuffer()
+{
+  if (m_segments.empty() || m_segments.back().second == m_segment_size)
+    m_segments.emplace_back(std::unique_ptr<char[]>(new char[m_segment_size]), 0);
+  auto &segment = m_segments.back();
+  return SerializerBuffer(segment.first.get() + segment.second, m_segment_size - segment.second);
+}
+
+inline bool SegmentedSink::commit(const char *data, size_t size)
+{
+  JS_UNUSED(data);
+  m_segments.back().second += size;
+  m_size += size;
+  return true;
+}
+
+inline std::string SegmentedSink::toString() const
+{
+  std::string ret;
+  ret.reserve(m_size);
+  for (auto &segment : m_segments)
+    ret.append(segment.first.get(), segment.second);
+  return ret;
+}
+
+inline SerializerBuffer FileSink::nextBuffer()
+{
+  return SerializerBuffer(m_buffer.get(), m_buffer_size);
+}
+
+inline bool FileSink::commit(const char *data, size_t size)
+{
+  if (fwrite(data, 1, size, m_file) != size)
+    return false;
+  m_written += size;
+  return true;
+}
+
 template <typename T>
 struct Nullable
 {
@@ -3706,91 +4436,466 @@ struct SilentUniquePtr
   typedef bool IsOptionalType;
 };
 
-struct JsonObjectRef
+namespace Internal
 {
-  DataRef ref;
-};
+template <typename T, bool OBJECT>
+struct DeltaTraits;
+}
 
-struct JsonObject
+/*!
+ * Wraps a member and remembers if it was changed since the last clearDirty(). JS::serializeDelta only writes the
+ * dirty Tracked members of an object, and the JS_OBJ members that have dirty Tracked members of their own. Assigning
+ * or parsing marks the value dirty, while set() only does so when the new value is different.
+ */
+template <typename T>
+class Tracked
 {
-  std::string data;
-};
+public:
+  Tracked()
+    : m_value()
+    , m_dirty(false)
+  {
+  }
+  Tracked(const T &value)
+    : m_value(value)
+    , m_dirty(false)
+  {
+  }
+  Tracked(T &&value)
+    : m_value(std::move(value))
+    , m_dirty(false)
+  {
+  }
 
-struct JsonArrayRef
-{
-  DataRef ref;
-};
+  Tracked<T> &operator=(const T &value)
+  {
+    m_value = value;
+    m_dirty = true;
+    return *this;
+  }
+  Tracked<T> &operator=(T &&value)
+  {
+    m_value = std::move(value);
+    m_dirty = true;
+    return *this;
+  }
 
-struct JsonArray
-{
-  std::string data;
-};
+  // Assigns value and marks it dirty if it differs from the current value. Returns true when it did.
+  bool set(const T &value)
+  {
+    if (m_value == value)
+      return false;
+    m_value = value;
+    m_dirty = true;
+    return true;
+  }
 
-struct JsonObjectOrArrayRef
-{
-  DataRef ref;
+  const T &get() const
+  {
+    return m_value;
+  }
+  const T &operator()() const
+  {
+    return m_value;
+  }
+  // Marks the value dirty and returns it for changes in place.
+  T &edit()
+  {
+    m_dirty = true;
+    return m_value;
+  }
+
+  bool isDirty() const
+  {
+    return m_dirty;
+  }
+  void markDirty()
+  {
+    m_dirty = true;
+  }
+  void clearDirty()
+  {
+    m_dirty = false;
+  }
+
+private:
+  friend struct Internal::DeltaTraits<Tracked<T>, false>;
+  T m_value;
+  bool m_dirty;
 };
 
-struct JsonObjectOrArray
+/*!
+ * Serializes the wrapped floating point value with a fixed FloatFormat, overriding the SerializerOptions float format
+ * for this member only. Parsing is unaffected.
+ */
+template <typename T, FloatFormat FORMAT, int PRECISION>
+struct FormattedFloat
 {
-  std::string data;
+  static_assert(std::is_floating_point<T>::value, "FormattedFloat only supports floating point types");
+  FormattedFloat()
+    : data()
+  {
+  }
+  FormattedFloat(T t)
+    : data(t)
+  {
+  }
+  FormattedFloat &operator=(T t)
+  {
+    data = t;
+    return *this;
+  }
+  operator T() const
+  {
+    return data;
+  }
+  T &operator()()
+  {
+    return data;
+  }
+  const T &operator()() const
+  {
+    return data;
+  }
+  T data;
 };
 
-struct JsonTokens
+/*!
+ * The base64 alphabet BasicBase64Bytes is serialized with. Standard ("+/") output is padded with '=', UrlSafe ("-_")
+ * output is not. Parsing accepts both alphabets, with or without padding.
+ */
+enum class Base64Alphabet : unsigned char
 {
-  std::vector<JS::Token> data;
+  Standard,
+  UrlSafe
 };
 
-struct JsonMeta
+/*!
+ * Binary data that is serialized as a base64 JSON string instead of an array of numbers.
+ */
+template <Base64Alphabet ALPHABET>
+struct BasicBase64Bytes
 {
-  JsonMeta(size_t pos, bool is_array)
-    : position(pos)
-    , size(1)
-    , skip(1)
-    , children(0)
-    , complex_children(0)
-    , is_array(is_array)
-    , has_data(false)
+  BasicBase64Bytes()
+    : data()
   {
   }
-
-  size_t position;
-  uint32_t size;
-  uint32_t skip;
-  uint32_t children;
-  uint32_t complex_children;
-  bool is_array : 1;
-  bool has_data : 1;
+  BasicBase64Bytes(std::vector<uint8_t> bytes)
+    : data(std::move(bytes))
+  {
+  }
+  std::vector<uint8_t> data;
 };
 
-static inline std::vector<JsonMeta> metaForTokens(const JsonTokens &tokens)
+typedef BasicBase64Bytes<Base64Alphabet::Standard> Base64Bytes;
+typedef BasicBase64Bytes<Base64Alphabet::UrlSafe> Base64UrlBytes;
+
+/*!
+ * A string with room for INLINE_CAPACITY characters inside the object itself. libstdc++ std::string only keeps 15
+ * characters inline, so ids, codes and short names of 16-30 characters cost a heap allocation each. CompactString
+ * keeps 31 characters inline in the same 32 bytes. Longer strings are stored on the heap.
+ *
+ * The last byte of the inline buffer holds INLINE_CAPACITY - size, which becomes the null terminator when the inline
+ * buffer is full, or 0xff when the string is on the heap.
+ */
+template <size_t INLINE_CAPACITY>
+class BasicCompactString
 {
-  std::vector<JsonMeta> meta;
-  meta.reserve(tokens.data.size() / 4);
-  std::vector<size_t> parent;
-  for (size_t i = 0; i < tokens.data.size(); i++)
+  struct Heap
   {
-    for (size_t parent_index : parent)
-    {
-      meta[parent_index].size++;
-    }
-    const JS::Token &token = tokens.data.at(i);
-    if (token.value_type == Type::ArrayEnd || token.value_type == Type::ObjectEnd)
-    {
-      assert(parent.size());
-      assert(meta[parent.back()].is_array == (token.value_type == Type::ArrayEnd));
-      parent.pop_back();
-    }
-    else
+    char *data;
+    size_t size;
+    size_t capacity;
+  };
+  static_assert(INLINE_CAPACITY >= sizeof(Heap), "INLINE_CAPACITY has to fit the heap pointer, size and capacity");
+  static_assert(INLINE_CAPACITY < 0xff, "INLINE_CAPACITY has to be smaller than 255");
+
+public:
+  BasicCompactString()
+  {
+    setInlineSize(0);
+  }
+  BasicCompactString(const char *str)
+  {
+    setInlineSize(0);
+    append(str, strlen(str));
+  }
+  BasicCompactString(const char *str, size_t size)
+  {
+    setInlineSize(0);
+    append(str, size);
+  }
+  BasicCompactString(const std::string &str)
+  {
+    setInlineSize(0);
+    append(str.data(), str.size());
+  }
+  BasicCompactString(const BasicCompactString &other)
+  {
+    setInlineSize(0);
+    append(other.data(), other.size());
+  }
+  BasicCompactString(BasicCompactString &&other) noexcept
+  {
+    memcpy(m_buffer, other.m_buffer, sizeof(m_buffer));
+    other.setInlineSize(0);
+  }
+  ~BasicCompactString()
+  {
+    release();
+  }
+  BasicCompactString &operator=(const BasicCompactString &other)
+  {
+    if (this != &other)
+      assign(other.data(), other.size());
+    return *this;
+  }
+  BasicCompactString &operator=(BasicCompactString &&other) noexcept
+  {
+    if (this != &other)
     {
-      if (parent.size())
-        meta[parent.back()].children++;
+      release();
+      memcpy(m_buffer, other.m_buffer, sizeof(m_buffer));
+      other.setInlineSize(0);
     }
+    return *this;
+  }
 
-    if (token.value_type == Type::ArrayStart || token.value_type == Type::ObjectStart)
-    {
-      if (parent.size())
-        meta[parent.back()].complex_children++;
+  bool isInline() const
+  {
+    return static_cast<unsigned char>(m_buffer[INLINE_CAPACITY]) != heap_marker;
+  }
+  size_t size() const
+  {
+    return isInline() ? INLINE_CAPACITY - static_cast<unsigned char>(m_buffer[INLINE_CAPACITY]) : heap().size;
+  }
+  size_t capacity() const
+  {
+    return isInline() ? INLINE_CAPACITY : heap().capacity;
+  }
+  bool empty() const
+  {
+    return size() == 0;
+  }
+  const char *data() const
+  {
+    return isInline() ? m_buffer : heap().data;
+  }
+  char *data()
+  {
+    return isInline() ? m_buffer : heap().data;
+  }
+  const char *c_str() const
+  {
+    return data();
+  }
+  const char *begin() const
+  {
+    return data();
+  }
+  const char *end() const
+  {
+    return data() + size();
+  }
+  char operator[](size_t index) const
+  {
+    return data()[index];
+  }
+  std::string toString() const
+  {
+    return std::string(data(), size());
+  }
+
+  void clear()
+  {
+    setSize(0);
+  }
+  void reserve(size_t new_capacity)
+  {
+    if (new_capacity > capacity())
+      grow(new_capacity, nullptr, 0);
+  }
+  void assign(const char *str, size_t size)
+  {
+    setSize(0);
+    append(str, size);
+  }
+  void append(const char *str, size_t size)
+  {
+    const size_t old_size = this->size();
+    if (old_size + size > capacity())
+    {
+      grow(std::max(old_size + size, capacity() * 2), str, size);
+      return;
+    }
+    memcpy(data() + old_size, str, size);
+    setSize(old_size + size);
+  }
+  void push_back(char c)
+  {
+    append(&c, 1);
+  }
+
+  friend bool operator==(const BasicCompactString &a, const BasicCompactString &b)
+  {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size()) == 0;
+  }
+  friend bool operator!=(const BasicCompactString &a, const BasicCompactString &b)
+  {
+    return !(a == b);
+  }
+  friend bool operator==(const BasicCompactString &a, const char *b)
+  {
+    return strlen(b) == a.size() && memcmp(a.data(), b, a.size()) == 0;
+  }
+  friend bool operator!=(const BasicCompactString &a, const char *b)
+  {
+    return !(a == b);
+  }
+
+private:
+  static const unsigned char heap_marker = 0xff;
+
+  Heap heap() const
+  {
+    Heap heap;
+    memcpy(&heap, m_buffer, sizeof(heap));
+    return heap;
+  }
+  void setHeap(const Heap &heap)
+  {
+    memcpy(m_buffer, &heap, sizeof(heap));
+    m_buffer[INLINE_CAPACITY] = static_cast<char>(heap_marker);
+  }
+  void setInlineSize(size_t size)
+  {
+    m_buffer[size] = 0;
+    m_buffer[INLINE_CAPACITY] = static_cast<char>(INLINE_CAPACITY - size);
+  }
+  void setSize(size_t size)
+  {
+    if (isInline())
+    {
+      setInlineSize(size);
+      return;
+    }
+    Heap h = heap();
+    h.size = size;
+    h.data[size] = 0;
+    setHeap(h);
+  }
+  // The appended data is copied before the old buffer is released, since it may point into it.
+  void grow(size_t new_capacity, const char *append_data, size_t append_size)
+  {
+    const size_t old_size = size();
+    char *new_data = new char[new_capacity + 1];
+    memcpy(new_data, data(), old_size);
+    if (append_size)
+      memcpy(new_data + old_size, append_data, append_size);
+    new_data[old_size + append_size] = 0;
+    release();
+    Heap h;
+    h.data = new_data;
+    h.size = old_size + append_size;
+    h.capacity = new_capacity;
+    setHeap(h);
+  }
+  void release()
+  {
+    if (!isInline())
+      delete[] heap().data;
+  }
+
+  alignas(sizeof(void *)) char m_buffer[INLINE_CAPACITY + 1];
+};
+
+typedef BasicCompactString<31> CompactString;
+
+struct JsonObjectRef
+{
+  DataRef ref;
+};
+
+struct JsonObject
+{
+  std::string data;
+};
+
+struct JsonArrayRef
+{
+  DataRef ref;
+};
+
+struct JsonArray
+{
+  std::string data;
+};
+
+struct JsonObjectOrArrayRef
+{
+  DataRef ref;
+};
+
+struct JsonObjectOrArray
+{
+  std::string data;
+};
+
+struct JsonTokens
+{
+  std::vector<JS::Token> data;
+};
+
+struct JsonMeta
+{
+  JsonMeta(size_t pos, bool is_array)
+    : position(pos)
+    , size(1)
+    , skip(1)
+    , children(0)
+    , complex_children(0)
+    , is_array(is_array)
+    , has_data(false)
+  {
+  }
+
+  size_t position;
+  uint32_t size;
+  uint32_t skip;
+  uint32_t children;
+  uint32_t complex_children;
+  bool is_array : 1;
+  bool has_data : 1;
+};
+
+static inline std::vector<JsonMeta> metaForTokens(const JsonTokens &tokens)
+{
+  std::vector<JsonMeta> meta;
+  meta.reserve(tokens.data.size() / 4);
+  std::vector<size_t> parent;
+  for (size_t i = 0; i < tokens.data.size(); i++)
+  {
+    for (size_t parent_index : parent)
+    {
+      meta[parent_index].size++;
+    }
+    const JS::Token &token = tokens.data.at(i);
+    if (token.value_type == Type::ArrayEnd || token.value_type == Type::ObjectEnd)
+    {
+      assert(parent.size());
+      assert(meta[parent.back()].is_array == (token.value_type == Type::ArrayEnd));
+      parent.pop_back();
+    }
+    else
+    {
+      if (parent.size())
+        meta[parent.back()].children++;
+    }
+
+    if (token.value_type == Type::ArrayStart || token.value_type == Type::ObjectStart)
+    {
+      if (parent.size())
+        meta[parent.back()].complex_children++;
       for (size_t parent_index : parent)
       {
         meta[parent_index].skip++;
@@ -3861,6 +4966,149 @@ struct IsOptionalType<std::optional<T>>
 };
 #endif
 
+namespace Internal
+{
+inline uint64_t hashBytes(const char *data, size_t size)
+{
+  uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+  for (; size >= 8; data += 8, size -= 8)
+  {
+    uint64_t chunk;
+    memcpy(&chunk, data, 8);
+    hash = (hash ^ chunk) * 0xff51afd7ed558ccdull;
+    hash ^= hash >> 32;
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, data, size);
+  hash = (hash ^ tail) * 0xc4ceb9fe1a85ec53ull;
+  return hash ^ (hash >> 29);
+}
+} // namespace Internal
+
+/*!
+ * Deduplicates the strings parsed into InternedString members. Attach it to ParseContext::intern_pool. It has to
+ * outlive every InternedString parsed through it, and it is not thread safe. JS::parseBatch does not use the pool of
+ * its prototype ParseContext for that reason.
+ */
+class InternPool
+{
+public:
+  InternPool()
+    : m_count(0)
+  {
+  }
+  InternPool(const InternPool &) = delete;
+  InternPool &operator=(const InternPool &) = delete;
+
+  /// Returns the pooled copy of the string, adding it if it is new. The pointer stays valid until clear().
+  const std::string *intern(const char *data, size_t size)
+  {
+    if (m_table.size() < (m_count + 1) * 2)
+      grow();
+    const uint64_t hash = Internal::hashBytes(data, size);
+    const size_t mask = m_table.size() - 1;
+    for (size_t i = size_t(hash) & mask;; i = (i + 1) & mask)
+    {
+      Entry &entry = m_table[i];
+      if (!entry.str)
+      {
+        m_strings.emplace_back(data, size);
+        entry.hash = hash;
+        entry.str = &m_strings.back();
+        m_count++;
+        return entry.str;
+      }
+      if (entry.hash == hash && entry.str->size() == size && memcmp(entry.str->data(), data, size) == 0)
+        return entry.str;
+    }
+  }
+  const std::string *intern(const std::string &str)
+  {
+    return intern(str.data(), str.size());
+  }
+
+  size_t size() const
+  {
+    return m_count;
+  }
+
+  /// Drops every string, which leaves all InternedStrings from this pool dangling.
+  void clear()
+  {
+    m_strings.clear();
+    m_table.clear();
+    m_count = 0;
+  }
+
+private:
+  struct Entry
+  {
+    uint64_t hash;
+    const std::string *str;
+  };
+
+  void grow()
+  {
+    std::vector<Entry> table(m_table.empty() ? 64 : m_table.size() * 2, Entry{0, nullptr});
+    const size_t mask = table.size() - 1;
+    for (const Entry &entry : m_table)
+    {
+      if (!entry.str)
+        continue;
+      size_t i = size_t(entry.hash) & mask;
+      while (table[i].str)
+        i = (i + 1) & mask;
+      table[i] = entry;
+    }
+    m_table.swap(table);
+  }
+
+  std::deque<std::string> m_strings;
+  std::vector<Entry> m_table;
+  size_t m_count;
+};
+
+/*!
+ * A string member that is parsed through ParseContext::intern_pool, so equal values share one pooled copy and each
+ * member is only a pointer. Parsing fails with IllegalDataValue when no pool is attached.
+ */
+struct InternedString
+{
+  InternedString()
+    : str(nullptr)
+  {
+  }
+  explicit InternedString(const std::string *interned)
+    : str(interned)
+  {
+  }
+  const char *data() const
+  {
+    return str ? str->data() : "";
+  }
+  size_t size() const
+  {
+    return str ? str->size() : 0;
+  }
+  bool empty() const
+  {
+    return size() == 0;
+  }
+  std::string toString() const
+  {
+    return std::string(data(), size());
+  }
+  friend bool operator==(const InternedString &a, const InternedString &b)
+  {
+    return a.str == b.str || (a.size() == b.size() && memcmp(a.data(), b.data(), a.size()) == 0);
+  }
+  friend bool operator!=(const InternedString &a, const InternedString &b)
+  {
+    return !(a == b);
+  }
+  const std::string *str;
+};
+
 struct ParseContext
 {
   ParseContext()
@@ -3898,6 +5146,18 @@ struct ParseContext
   template <typename T>
   Error parseTo(T &to_type);
 
+  /// Reuse this context for a new document. Allocated capacity, tokenizer options
+  /// and callbacks are kept, while all parse state from the previous document is dropped.
+  void reset(const char *data, size_t size)
+  {
+    tokenizer.reset();
+    tokenizer.addData(data, size);
+    token = Token();
+    error = Error::NoError;
+    missing_members.clear();
+    unassigned_required_members.clear();
+  }
+
   Error nextToken()
   {
     error = tokenizer.nextToken(token);
@@ -3963,6 +5223,7 @@ struct ParseContext
   bool allow_unasigned_required_members = true;
   bool track_member_assignement_state = true;
   void *user_data = nullptr;
+  InternPool *intern_pool = nullptr;
 };
 
 /*! \def JS_MEMBER
@@ -4168,6 +5429,27 @@ struct JsonStructBaseDummy
 #define JS_OBJ_EXT_SUPER(Type, super_list, ...)                                                                        \
   JS_OBJECT_EXTERNAL_INTERNAL_IMPL(Type, super_list, JS::makeTuple(JS_INTERNAL_MAKE_MEMBERS(__VA_ARGS__)))
 
+namespace Internal
+{
+/*!
+ * \private
+ * The quoted member name followed by ": ", padded with zeros to a multiple of 16 bytes. The serializer writes the
+ * first SIZE + 3 bytes in compact mode and SIZE + 4 bytes in pretty mode. The padding lets it copy whole 16 and 32
+ * byte blocks for short names.
+ */
+template <size_t SIZE>
+struct MemberKey
+{
+  char data[(SIZE + 4 + 15) / 16 * 16];
+};
+
+template <size_t SIZE, size_t... INDEX>
+constexpr MemberKey<SIZE> makeMemberKey(const char (&name)[SIZE + 1], Sequence<INDEX...>)
+{
+  return {{'"', name[INDEX]..., '"', ':', ' '}};
+}
+} // namespace Internal
+
 /*!
  * \private
  */
@@ -4176,6 +5458,7 @@ struct MI
 {
   NAMETUPLE names;
   T U::*member;
+  Internal::MemberKey<size_t(TypeAt<0, NAMETUPLE>::type::size)> key;
   typedef T type;
 };
 
@@ -4204,7 +5487,8 @@ template <typename T, typename U, size_t NAME_SIZE, typename... Aliases>
 constexpr auto makeMemberInfo(const char (&name)[NAME_SIZE], T U::*member, Aliases &...aliases)
   -> MI<T, U, decltype(makeTuple(JS::Internal::makeStringLiteral(name), JS::Internal::makeStringLiteral(aliases)...))>
 {
-  return {makeTuple(JS::Internal::makeStringLiteral(name), JS::Internal::makeStringLiteral(aliases)...), member};
+  return {makeTuple(JS::Internal::makeStringLiteral(name), JS::Internal::makeStringLiteral(aliases)...), member,
+          Internal::makeMemberKey<NAME_SIZE - 1>(name, typename Internal::GenSequence<NAME_SIZE - 1>::type())};
 }
 
 template <typename T, size_t NAME_SIZE>
@@ -4218,6 +5502,8 @@ struct TypeHandler
 {
   static inline Error to(T &to_type, ParseContext &context);
   static inline void from(const T &from_type, Token &token, Serializer &serializer);
+  // Only the handler for JS_OBJ and JS_OBJECT_EXTERNAL types, see Internal::IsJsonObject
+  typedef bool IsJsonObjectHandler;
 };
 
 namespace Internal
@@ -4307,41 +5593,169 @@ inline Error verifyMember(const MemberInfo<MI_T, MI_M, MI_NC> &memberInfo, size_
   return Error::UnassignedRequiredMember;
 }
 
-template <typename T, typename MI_T, typename MI_M, typename MI_NC>
-inline void serializeMember(const T &from_type, const MemberInfo<MI_T, MI_M, MI_NC> &memberInfo, Token &token,
-                            Serializer &serializer, const char *super_name)
+template <typename T, typename Enable = bool>
+struct IsJsonObject
 {
-  JS_UNUSED(super_name);
-  token.name.data = memberInfo.names.template get<0>().data;
-  token.name.size = memberInfo.names.template get<0>().size;
-  token.name_type = Type::Ascii;
-
-  TypeHandler<MI_T>::from(from_type.*memberInfo.member, token, serializer);
-}
+  static const bool value = false;
+};
 
-template <typename T, size_t PAGE, size_t INDEX>
-struct SuperClassHandler
+template <typename T>
+struct IsJsonObject<T, typename TypeHandler<T>::IsJsonObjectHandler>
 {
-  static Error handleSuperClasses(T &to_type, ParseContext &context, bool primary, bool *assigned_members);
-  static Error verifyMembers(bool *assigned_members, bool track_missing_members,
-                             std::vector<std::string> &missing_members);
-  static constexpr size_t membersInSuperClasses();
-  static void serializeMembers(const T &from_type, Token &token, Serializer &serializer);
+  static const bool value = true;
 };
 
-template <typename T, size_t PAGE, size_t SIZE>
-struct StartSuperRecursion
+// Finds and clears the dirty Tracked values of a type for serializeDelta. Only Tracked values and the members of
+// JS_OBJ types are looked at, so a container is only written by serializeDelta as part of a dirty Tracked value.
+template <typename T, bool OBJECT = IsJsonObject<T>::value>
+struct DeltaTraits
 {
-  static Error start(T &to_type, ParseContext &context, bool primary, bool *assigned)
+  static bool dirty(const T &value)
   {
-    return SuperClassHandler<T, PAGE, SIZE - 1>::handleSuperClasses(to_type, context, primary, assigned);
+    JS_UNUSED(value);
+    return false;
   }
-
-  static Error verifyMembers(bool *assigned_members, bool track_missing_members,
-                             std::vector<std::string> &missing_members)
+  static void clear(T &value)
   {
-    return SuperClassHandler<T, PAGE, SIZE - 1>::verifyMembers(assigned_members, track_missing_members,
-                                                               missing_members);
+    JS_UNUSED(value);
+  }
+};
+
+template <typename T>
+struct DeltaTraits<Tracked<T>, false>
+{
+  static bool dirty(const Tracked<T> &value)
+  {
+    return value.isDirty() || DeltaTraits<T>::dirty(value.get());
+  }
+  static void clear(Tracked<T> &value)
+  {
+    value.m_dirty = false;
+    DeltaTraits<T>::clear(value.m_value);
+  }
+};
+
+template <typename T, typename Members, size_t INDEX>
+struct DeltaMembers
+{
+  static bool dirty(const T &value, const Members &members)
+  {
+    auto &member = members.template get<INDEX - 1>();
+    typedef typename std::remove_reference<decltype(member)>::type::type MemberType;
+    return DeltaTraits<MemberType>::dirty(value.*member.member) ||
+           DeltaMembers<T, Members, INDEX - 1>::dirty(value, members);
+  }
+  static void clear(T &value, const Members &members)
+  {
+    auto &member = members.template get<INDEX - 1>();
+    typedef typename std::remove_reference<decltype(member)>::type::type MemberType;
+    DeltaTraits<MemberType>::clear(value.*member.member);
+    DeltaMembers<T, Members, INDEX - 1>::clear(value, members);
+  }
+};
+
+template <typename T, typename Members>
+struct DeltaMembers<T, Members, 0>
+{
+  static bool dirty(const T &value, const Members &members)
+  {
+    JS_UNUSED(value);
+    JS_UNUSED(members);
+    return false;
+  }
+  static void clear(T &value, const Members &members)
+  {
+    JS_UNUSED(value);
+    JS_UNUSED(members);
+  }
+};
+
+template <typename T, typename Supers, size_t INDEX>
+struct DeltaSupers
+{
+  typedef typename TypeAt<INDEX - 1, Supers>::type::type Super;
+  static bool dirty(const T &value)
+  {
+    return DeltaTraits<Super, true>::dirty(value) || DeltaSupers<T, Supers, INDEX - 1>::dirty(value);
+  }
+  static void clear(T &value)
+  {
+    DeltaTraits<Super, true>::clear(value);
+    DeltaSupers<T, Supers, INDEX - 1>::clear(value);
+  }
+};
+
+template <typename T, typename Supers>
+struct DeltaSupers<T, Supers, 0>
+{
+  static bool dirty(const T &value)
+  {
+    JS_UNUSED(value);
+    return false;
+  }
+  static void clear(T &value)
+  {
+    JS_UNUSED(value);
+  }
+};
+
+template <typename T>
+struct DeltaTraits<T, true>
+{
+  typedef decltype(JsonStructBaseDummy<T, T>::js_static_meta_data_info()) Members;
+  typedef decltype(JsonStructBaseDummy<T, T>::js_static_meta_super_info()) Supers;
+  static bool dirty(const T &value)
+  {
+    return DeltaMembers<T, Members, Members::size>::dirty(value,
+                                                          JsonStructBaseDummy<T, T>::js_static_meta_data_info()) ||
+           DeltaSupers<T, Supers, Supers::size>::dirty(value);
+  }
+  static void clear(T &value)
+  {
+    DeltaMembers<T, Members, Members::size>::clear(value, JsonStructBaseDummy<T, T>::js_static_meta_data_info());
+    DeltaSupers<T, Supers, Supers::size>::clear(value);
+  }
+};
+
+template <typename T, typename MI_T, typename MI_M, typename MI_NC>
+inline void serializeMember(const T &from_type, const MemberInfo<MI_T, MI_M, MI_NC> &memberInfo, Token &token,
+                            Serializer &serializer, const char *super_name)
+{
+  JS_UNUSED(super_name);
+  if (serializer.deltaOnly() && !DeltaTraits<MI_T>::dirty(from_type.*memberInfo.member))
+    return;
+  token.name.data = memberInfo.key.data + 1;
+  token.name.size = memberInfo.names.template get<0>().size;
+  token.name_type = Type::Ascii;
+
+  serializer.setMemberKey(memberInfo.key.data);
+  TypeHandler<MI_T>::from(from_type.*memberInfo.member, token, serializer);
+  serializer.setMemberKey(nullptr);
+}
+
+template <typename T, size_t PAGE, size_t INDEX>
+struct SuperClassHandler
+{
+  static Error handleSuperClasses(T &to_type, ParseContext &context, bool primary, bool *assigned_members);
+  static Error verifyMembers(bool *assigned_members, bool track_missing_members,
+                             std::vector<std::string> &missing_members);
+  static constexpr size_t membersInSuperClasses();
+  static void serializeMembers(const T &from_type, Token &token, Serializer &serializer);
+};
+
+template <typename T, size_t PAGE, size_t SIZE>
+struct StartSuperRecursion
+{
+  static Error start(T &to_type, ParseContext &context, bool primary, bool *assigned)
+  {
+    return SuperClassHandler<T, PAGE, SIZE - 1>::handleSuperClasses(to_type, context, primary, assigned);
+  }
+
+  static Error verifyMembers(bool *assigned_members, bool track_missing_members,
+                             std::vector<std::string> &missing_members)
+  {
+    return SuperClassHandler<T, PAGE, SIZE - 1>::verifyMembers(assigned_members, track_missing_members,
+                                                               missing_members);
   }
 
   static constexpr size_t membersInSuperClasses()
@@ -4623,17 +6037,18 @@ struct SerializerContext
   SerializerContext(std::string &json_out_p)
     : serializer()
     , json_out(json_out_p)
-    , last_pos(0)
-  {
-    if (json_out.empty())
-      json_out.resize(4096);
-    serializer.setBuffer(&json_out[0], json_out.size());
-    serializer.setRequestBufferCallback([this](Serializer &serializer_p) {
-      size_t end = this->json_out.size();
-      this->json_out.resize(end * 2);
-      serializer_p.setBuffer(&(this->json_out[0]) + end, end);
-      this->last_pos = end;
-    });
+    , sink(json_out_p)
+  {
+    sink.attach(serializer);
+  }
+
+  SerializerContext(std::string &json_out_p, const SerializerOptions &options)
+    : serializer()
+    , json_out(json_out_p)
+    , sink(json_out_p)
+  {
+    serializer.setOptions(options);
+    sink.attach(serializer);
   }
 
   ~SerializerContext()
@@ -4651,12 +6066,13 @@ struct SerializerContext
 
   void flush()
   {
-    json_out.resize(last_pos + serializer.currentBuffer().used);
+    sink.finish(serializer);
+    sink.releaseBuffer(serializer);
   }
 
   Serializer serializer;
   std::string &json_out;
-  size_t last_pos;
+  StringSink sink;
 };
 
 template <typename T>
@@ -4674,14 +6090,207 @@ template <typename T>
 JS_NODISCARD std::string serializeStruct(const T &from_type, const SerializerOptions &options)
 {
   std::string ret_string;
-  SerializerContext serializeContext(ret_string);
-  serializeContext.serializer.setOptions(options);
+  SerializerContext serializeContext(ret_string, options);
+  Token token;
+  TypeHandler<T>::from(from_type, token, serializeContext.serializer);
+  serializeContext.flush();
+  return ret_string;
+}
+
+/*!
+ * Serializes from_type into buffer and returns the size of the complete output, like snprintf. When that is larger
+ * than size the buffer holds the first size bytes and the rest was only counted. Nothing is allocated, so this can
+ * write straight into shared memory or a socket buffer.
+ */
+template <typename T>
+size_t serializeTo(const T &from_type, char *buffer, size_t size,
+                   const SerializerOptions &options = SerializerOptions())
+{
+  char scratch[1024];
+  size_t full_buffers = 0;
+  size_t current_size = size;
+  Serializer serializer(buffer, size);
+  serializer.setOptions(options);
+  // Only called when the current buffer is full, so everything after buffer is counted through scratch
+  serializer.setRequestBufferCallback([&](Serializer &serializer_p) {
+    full_buffers += current_size;
+    current_size = sizeof(scratch);
+    serializer_p.setBuffer(scratch, sizeof(scratch));
+  });
+  Token token;
+  TypeHandler<T>::from(from_type, token, serializer);
+  return full_buffers + serializer.currentBuffer().used;
+}
+
+/*!
+ * The size of the output serializeStruct would produce for from_type and options, found by a serialization pass that
+ * counts instead of storing the output.
+ */
+template <typename T>
+JS_NODISCARD size_t serializedSize(const T &from_type, const SerializerOptions &options = SerializerOptions())
+{
+  return serializeTo(from_type, nullptr, 0, options);
+}
+
+/*!
+ * Serializes only what changed in from_type since the last clearDirty: the dirty Tracked members, and the nested
+ * JS_OBJ members that contain dirty Tracked members, recursively. Members that are not Tracked are left out. Parsing
+ * the result into a copy of the previous state applies the changes. An object without changes is written as {}.
+ */
+template <typename T>
+JS_NODISCARD std::string serializeDelta(const T &from_type, const SerializerOptions &options = SerializerOptions())
+{
+  std::string ret_string;
+  SerializerContext serializeContext(ret_string, options);
+  serializeContext.serializer.setDeltaOnly(true);
   Token token;
   TypeHandler<T>::from(from_type, token, serializeContext.serializer);
   serializeContext.flush();
   return ret_string;
 }
 
+/*!
+ * Returns true when value, or a JS_OBJ member of it, holds a dirty Tracked value.
+ */
+template <typename T>
+bool isDirty(const T &value)
+{
+  return Internal::DeltaTraits<T>::dirty(value);
+}
+
+/*!
+ * Marks all the Tracked values in value clean, so the next serializeDelta starts from here.
+ */
+template <typename T>
+void clearDirty(T &value)
+{
+  Internal::DeltaTraits<T>::clear(value);
+}
+
+/*!
+ * Serializes a document piece by piece into an OutputSink, so that a huge array can be written element by element
+ * from a range or a generator while the sink hands the output on, for example to a FileSink or FdSink. Only the
+ * element being serialized and the sink's buffer have to be in memory.
+ *
+ * \code
+ * JS::FdSink sink(fd);
+ * JS::StreamSerializer stream(sink, JS::SerializerOptions(JS::SerializerOptions::Compact));
+ * stream.beginObject();
+ * stream.write("count", count);
+ * stream.writeArrayFrom<Row>("rows", [&](Row &row) { return cursor.next(row); });
+ * stream.endObject();
+ * bool ok = stream.finish();
+ * \endcode
+ */
+class StreamSerializer
+{
+public:
+  explicit StreamSerializer(OutputSink &sink, const SerializerOptions &options = SerializerOptions())
+    : m_sink(sink)
+  {
+    m_serializer.setOptions(options);
+    m_sink.attach(m_serializer);
+  }
+  StreamSerializer(const StreamSerializer &) = delete;
+  StreamSerializer &operator=(const StreamSerializer &) = delete;
+
+  void beginObject(const char *name = nullptr)
+  {
+    writeStart(name, Type::ObjectStart, DataRef("{"));
+  }
+  void endObject()
+  {
+    writeStart(nullptr, Type::ObjectEnd, DataRef("}"));
+  }
+  void beginArray(const char *name = nullptr)
+  {
+    writeStart(name, Type::ArrayStart, DataRef("["));
+  }
+  void endArray()
+  {
+    writeStart(nullptr, Type::ArrayEnd, DataRef("]"));
+  }
+
+  // Writes value as an array element or a top level value.
+  template <typename T>
+  void write(const T &value)
+  {
+    setName(nullptr);
+    TypeHandler<T>::from(value, m_token, m_serializer);
+  }
+  // Writes value as the member name of the current object.
+  template <typename T>
+  void write(const char *name, const T &value)
+  {
+    setName(name);
+    TypeHandler<T>::from(value, m_token, m_serializer);
+  }
+
+  // Writes every element of range, anything that works with a range based for loop, as an array.
+  template <typename Range>
+  void writeArray(const char *name, const Range &range)
+  {
+    beginArray(name);
+    for (const auto &element : range)
+    {
+      if (failed())
+        break;
+      write(element);
+    }
+    endArray();
+  }
+  template <typename Range>
+  void writeArray(const Range &range)
+  {
+    writeArray(nullptr, range);
+  }
+
+  // Writes an array of T produced by generator, a callable taking T & that returns false when there are no more
+  // elements. The same T is reused for every element. Stops asking for elements once the sink has failed.
+  template <typename T, typename Generator>
+  void writeArrayFrom(const char *name, Generator &&generator)
+  {
+    beginArray(name);
+    T element;
+    while (!failed() && generator(element))
+      write(element);
+    endArray();
+  }
+  template <typename T, typename Generator>
+  void writeArrayFrom(Generator &&generator)
+  {
+    writeArrayFrom<T>(nullptr, std::forward<Generator>(generator));
+  }
+
+  // Hands the rest of the output to the sink. Returns false when the sink failed.
+  bool finish()
+  {
+    return m_sink.finish(m_serializer);
+  }
+  bool failed() const
+  {
+    return m_sink.failed();
+  }
+
+private:
+  void setName(const char *name)
+  {
+    m_token.name = name ? DataRef(name, strlen(name)) : DataRef();
+    m_token.name_type = Type::String;
+  }
+  void writeStart(const char *name, Type type, const DataRef &value)
+  {
+    setName(name);
+    m_token.value_type = type;
+    m_token.value = value;
+    m_serializer.write(m_token);
+  }
+
+  OutputSink &m_sink;
+  Serializer m_serializer;
+  Token m_token;
+};
+
 template <>
 struct TypeHandler<Error>
 {
@@ -5557,44 +7166,194 @@ struct FunctionalSuperRecursion<T, 0>
 } // namespace Internal
 namespace Internal
 {
-enum class ParseEnumStringState
+constexpr bool isEnumNameStart(char c)
+{
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+constexpr bool isEnumNameChar(char c)
+{
+  return isEnumNameStart(c) || (c >= '0' && c <= '9');
+}
+
+constexpr size_t enumNameLength(const char *names, size_t start)
+{
+  return isEnumNameChar(names[start]) ? 1 + enumNameLength(names, start + 1) : 0;
+}
+
+// Position of the next name at or after pos, or of the terminating null.
+constexpr size_t enumNameFind(const char *names, size_t pos)
+{
+  return names[pos] == '\0' || isEnumNameStart(names[pos]) ? pos : enumNameFind(names, pos + 1);
+}
+
+// Skips past the separator following the name that ends at pos.
+constexpr size_t enumNameSkipSeparator(const char *names, size_t pos)
+{
+  return names[pos] == '\0' ? pos : names[pos] == ',' ? pos + 1 : enumNameSkipSeparator(names, pos + 1);
+}
+
+constexpr size_t enumNameNext(const char *names, size_t start)
+{
+  return enumNameFind(names, enumNameSkipSeparator(names, start + enumNameLength(names, start)));
+}
+
+// True if [begin, end) of the stringified enumerator list has an initializer. Halves the range like enumFindHash to
+// keep the recursion depth logarithmic in the length of the list.
+constexpr bool enumNamesHaveInitializer(const char *names, size_t begin, size_t end)
+{
+  return end - begin <= 32 ? begin != end && (names[begin] == '=' || enumNamesHaveInitializer(names, begin + 1, end))
+                           : enumNamesHaveInitializer(names, begin, begin + (end - begin) / 2) ||
+                               enumNamesHaveInitializer(names, begin + (end - begin) / 2, end);
+}
+
+constexpr uint32_t enumNameHash(const char *name, size_t size, uint32_t hash = 2166136261u)
+{
+  return size ? enumNameHash(name + 1, size - 1, (hash ^ uint32_t(uint8_t(*name))) * 16777619u) : hash;
+}
+
+constexpr size_t enumHashTableSize(size_t count, size_t size = 1)
+{
+  return size >= count ? size : enumHashTableSize(count, size * 2);
+}
+
+template <typename F, bool END, size_t POS, size_t... STARTS>
+struct EnumNameStarts
+{
+  using type = typename EnumNameStarts<F, F::names()[enumNameNext(F::names(), POS)] == '\0',
+                                       enumNameNext(F::names(), POS), STARTS..., POS>::type;
+};
+
+template <typename F, size_t POS, size_t... STARTS>
+struct EnumNameStarts<F, true, POS, STARTS...>
 {
-  FindingNameStart,
-  FindingNameEnd,
-  FindingSeperator
+  using type = Sequence<STARTS...>;
 };
-template <size_t N>
-void populateEnumNames(std::vector<DataRef> &names, const char (&data)[N])
+
+template <typename F, typename CHARS>
+struct EnumQuotedNames;
+
+// The stringified enumerator list with every character between names replaced by a quote, and one more quote in
+// front. A name starting at pos in the list is then found quoted at the same pos in this buffer.
+template <typename F, size_t... CHARS>
+struct EnumQuotedNames<F, Sequence<CHARS...>>
+{
+  static constexpr char data[sizeof...(CHARS)] = {
+    (CHARS == 0 || !isEnumNameChar(F::names()[CHARS - 1]) ? '"' : F::names()[CHARS - 1])...};
+};
+template <typename F, size_t... CHARS>
+constexpr char EnumQuotedNames<F, Sequence<CHARS...>>::data[sizeof...(CHARS)];
+
+// First name index in [begin, end) with hashes[index] == hash, or none. Splits the range in halves to keep the
+// recursion depth logarithmic, and scans short ranges linearly.
+constexpr size_t enumFindHashLinear(const uint32_t *hashes, uint32_t hash, size_t begin, size_t end, size_t none)
+{
+  return begin == end ? none : hashes[begin] == hash ? begin : enumFindHashLinear(hashes, hash, begin + 1, end, none);
+}
+constexpr size_t enumFindHash(const uint32_t *hashes, uint32_t hash, size_t begin, size_t end, size_t none);
+constexpr size_t enumFindHashOr(size_t found, const uint32_t *hashes, uint32_t hash, size_t begin, size_t end,
+                                size_t none)
+{
+  return found != none ? found : enumFindHash(hashes, hash, begin, end, none);
+}
+constexpr size_t enumFindHash(const uint32_t *hashes, uint32_t hash, size_t begin, size_t end, size_t none)
+{
+  return end - begin <= 32 ? enumFindHashLinear(hashes, hash, begin, end, none)
+                           : enumFindHashOr(enumFindHash(hashes, hash, begin, begin + (end - begin) / 2, none), hashes,
+                                            hash, begin + (end - begin) / 2, end, none);
+}
+
+template <typename F, typename STARTS>
+struct EnumNameData;
+
+template <typename F, size_t... STARTS>
+struct EnumNameData<F, Sequence<STARTS...>>
+{
+  static_assert(!enumNamesHaveInitializer(F::names(), 0, F::size()),
+                "JS_ENUM names are indexed by value, so enumerators can not have initializers");
+  using Quoted = EnumQuotedNames<F, typename GenSequence<F::size() + 1>::type>;
+  static constexpr size_t count = sizeof...(STARTS);
+  static constexpr size_t table_size = enumHashTableSize(count);
+  // The extra entry keeps the arrays valid for enums without names.
+  static constexpr DataRef names[count + 1] = {DataRef(F::names() + STARTS, enumNameLength(F::names(), STARTS))...,
+                                               DataRef()};
+  static constexpr DataRef quoted[count + 1] = {
+    DataRef(Quoted::data + STARTS, enumNameLength(F::names(), STARTS) + 2)..., DataRef()};
+  static constexpr uint32_t hashes[count + 1] = {
+    uint32_t(enumNameHash(F::names() + STARTS, enumNameLength(F::names(), STARTS)) & (table_size - 1))..., 0};
+};
+template <typename F, size_t... STARTS>
+constexpr DataRef EnumNameData<F, Sequence<STARTS...>>::names[count + 1];
+template <typename F, size_t... STARTS>
+constexpr DataRef EnumNameData<F, Sequence<STARTS...>>::quoted[count + 1];
+template <typename F, size_t... STARTS>
+constexpr uint32_t EnumNameData<F, Sequence<STARTS...>>::hashes[count + 1];
+
+template <size_t COUNT, size_t TABLE_SIZE>
+struct EnumHashIndex
+{
+  size_t bucket[TABLE_SIZE];
+  size_t next[COUNT + 1];
+};
+
+#if __cplusplus >= 201402L
+template <size_t COUNT, size_t TABLE_SIZE, size_t... INDICES, size_t... BUCKETS>
+constexpr EnumHashIndex<COUNT, TABLE_SIZE> makeEnumHashIndex(const uint32_t *hashes, Sequence<INDICES...>,
+                                                             Sequence<BUCKETS...>)
+{
+  EnumHashIndex<COUNT, TABLE_SIZE> index{};
+  for (size_t bucket = 0; bucket < TABLE_SIZE; bucket++)
+    index.bucket[bucket] = COUNT;
+  index.next[COUNT] = COUNT;
+  for (size_t i = COUNT; i-- > 0;)
+  {
+    index.next[i] = index.bucket[hashes[i]];
+    index.bucket[hashes[i]] = i;
+  }
+  return index;
+}
+#else
+// C++11 constexpr functions can not loop, so every entry is searched for separately.
+template <size_t COUNT, size_t TABLE_SIZE, size_t... INDICES, size_t... BUCKETS>
+constexpr EnumHashIndex<COUNT, TABLE_SIZE> makeEnumHashIndex(const uint32_t *hashes, Sequence<INDICES...>,
+                                                             Sequence<BUCKETS...>)
 {
-  size_t name_starts_at = 0;
-  ParseEnumStringState state = ParseEnumStringState::FindingNameStart;
-  for (size_t i = 0; i < N; i++)
+  return {{enumFindHash(hashes, uint32_t(BUCKETS), 0, COUNT, COUNT)...},
+          {enumFindHash(hashes, hashes[INDICES], INDICES + 1, COUNT, COUNT)..., COUNT}};
+}
+#endif
+
+/*!
+ * Compile time name table for a JS_ENUM, indexed by enum value. Parsing looks names up through a hash table with
+ * chaining, where the bucket and next entries are name indices and count ends a chain.
+ */
+template <typename Data>
+struct EnumNameTable : Data
+{
+  static constexpr EnumHashIndex<Data::count, Data::table_size> index =
+    makeEnumHashIndex<Data::count, Data::table_size>(Data::hashes, typename GenSequence<Data::count>::type(),
+                                                     typename GenSequence<Data::table_size>::type());
+
+  static size_t find(const DataRef &name)
   {
-    char c = data[i];
-    assert(c != '=');
-    switch (state)
+    size_t i = index.bucket[enumNameHash(name.data, name.size) & (Data::table_size - 1)];
+    while (i != Data::count)
     {
-    case ParseEnumStringState::FindingNameStart:
-      if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
-      {
-        name_starts_at = i;
-        state = ParseEnumStringState::FindingNameEnd;
-      }
-      break;
-    case ParseEnumStringState::FindingNameEnd:
-      if (c == '\0' || c == '\t' || c == '\n' || c == '\r' || c == ' ' || c == ',')
-      {
-        names.push_back(DataRef(data + name_starts_at, i - name_starts_at));
-        state = c == ',' ? ParseEnumStringState::FindingNameStart : ParseEnumStringState::FindingSeperator;
-      }
-      break;
-    case ParseEnumStringState::FindingSeperator:
-      if (c == ',')
-        state = ParseEnumStringState::FindingNameStart;
-      break;
+      const DataRef &candidate = Data::names[i];
+      if (candidate.size == name.size && memcmp(candidate.data, name.data, name.size) == 0)
+        return i;
+      i = index.next[i];
     }
+    return i;
   }
-}
+};
+template <typename Data>
+constexpr EnumHashIndex<Data::count, Data::table_size> EnumNameTable<Data>::index;
+
+template <typename F>
+using EnumNames = EnumNameTable<
+  EnumNameData<F, typename EnumNameStarts<F, F::names()[enumNameFind(F::names(), 0)] == '\0',
+                                          enumNameFind(F::names(), 0)>::type>>;
 } // namespace Internal
 } // namespace JS
 
@@ -5605,17 +7364,22 @@ void populateEnumNames(std::vector<DataRef> &names, const char (&data)[N])
   };                                                                                                                   \
   struct js_##name##_string_struct                                                                                     \
   {                                                                                                                    \
-    template <size_t N>                                                                                                \
-    explicit js_##name##_string_struct(const char (&data)[N])                                                          \
+    static constexpr const char *names()                                                                               \
+    {                                                                                                                  \
+      return #__VA_ARGS__;                                                                                             \
+    }                                                                                                                  \
+    static constexpr size_t size()                                                                                     \
     {                                                                                                                  \
-      JS::Internal::populateEnumNames(_strings, data);                                                                 \
+      return sizeof(#__VA_ARGS__);                                                                                     \
     }                                                                                                                  \
-    std::vector<JS::DataRef> _strings;                                                                                 \
                                                                                                                        \
+    /* A template, so enums with initializers only fail the name table check when names are used */                    \
+    template <typename Self = js_##name##_string_struct>                                                               \
     static const std::vector<JS::DataRef> &strings()                                                                   \
     {                                                                                                                  \
-      static js_##name##_string_struct ret(#__VA_ARGS__);                                                              \
-      return ret._strings;                                                                                             \
+      using Names = JS::Internal::EnumNames<Self>;                                                                     \
+      static const std::vector<JS::DataRef> ret(Names::names, Names::names + Names::count);                            \
+      return ret;                                                                                                      \
     }                                                                                                                  \
   };
 
@@ -5790,22 +7554,17 @@ namespace Internal
 template <typename T, typename F>
 struct EnumHandler
 {
+  typedef EnumNames<F> Names;
+
   static inline Error to(T &to_type, ParseContext &context)
   {
     if (context.token.value_type == Type::String)
     {
-      auto &strings = F::strings();
-      for (size_t i = 0; i < strings.size(); i++)
+      size_t index = Names::find(context.token.value);
+      if (index != Names::count)
       {
-        const DataRef &ref = strings[i];
-        if (ref.size == context.token.value.size)
-        {
-          if (memcmp(ref.data, context.token.value.data, ref.size) == 0)
-          {
-            to_type = static_cast<T>(i);
-            return Error::NoError;
-          }
-        }
+        to_type = static_cast<T>(index);
+        return Error::NoError;
       }
     }
     else if (context.token.value_type == Type::Number)
@@ -5824,9 +7583,9 @@ struct EnumHandler
 
   static inline void from(const T &from_type, Token &token, Serializer &serializer)
   {
-    size_t i = static_cast<size_t>(from_type);
-    token.value = F::strings()[i];
-    token.value_type = Type::String;
+    // The quoted names are written as they are.
+    token.value = Names::quoted[static_cast<size_t>(from_type)];
+    token.value_type = Type::Verbatim;
     serializer.write(token);
   }
 };
@@ -5834,7 +7593,8 @@ struct EnumHandler
 
 namespace Internal
 {
-static void push_back_escape(char current_char, std::string &to_type)
+template <typename String>
+static void push_back_escape(char current_char, String &to_type)
 {
   static const char escaped_table[] = {'b', 'f', 'n', 'r', 't', '\"', '\\', '/'};
   static const char replace_table[] = {'\b', '\f', '\n', '\r', '\t', '\"', '\\', '/'};
@@ -5851,7 +7611,8 @@ static void push_back_escape(char current_char, std::string &to_type)
   }
 }
 
-static void handle_json_escapes_in(const DataRef &ref, std::string &to_type)
+template <typename String>
+static void handle_json_escapes_in(const DataRef &ref, String &to_type)
 {
   to_type.reserve(ref.size);
   const char *it = ref.data;
@@ -5861,10 +7622,10 @@ static void handle_json_escapes_in(const DataRef &ref, std::string &to_type)
     const char *next_it = static_cast<const char *>(memchr(it, '\\', size));
     if (!next_it)
     {
-      to_type.insert(to_type.end(), it, it + size);
+      to_type.append(it, size);
       break;
     }
-    to_type.insert(to_type.end(), it, next_it);
+    to_type.append(it, size_t(next_it - it));
     size -= next_it - it;
     if (size < 2)
     {
@@ -5976,60 +7737,227 @@ static void handle_json_escapes_in(const DataRef &ref, std::string &to_type)
   }
 }
 
+// Bytes that need escaping in JSON strings: control characters below 0x20, '"' and '\\'.
+static JSON_STRUCT_FORCE_INLINE bool needsEscapeOut(unsigned char c)
+{
+  return c < 0x20 || c == '"' || c == '\\';
+}
+
+#if defined(JSON_STRUCT_HAS_AVX2)
+static JSON_STRUCT_FORCE_INLINE unsigned int escapeOutMask(__m256i chunk)
+{
+  __m256i is_ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, _mm256_set1_epi8(0x1f)), chunk);
+  __m256i is_q = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+  __m256i is_b = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+  return (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(is_ctrl, is_q), is_b));
+}
+#endif
+#if defined(JSON_STRUCT_HAS_SSE2)
+static JSON_STRUCT_FORCE_INLINE unsigned int escapeOutMask(__m128i chunk)
+{
+  __m128i is_ctrl = _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8(0x1f)), chunk);
+  __m128i is_q = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'));
+  __m128i is_b = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'));
+  return (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(is_ctrl, is_q), is_b));
+}
+#elif defined(JSON_STRUCT_HAS_NEON) && defined(__aarch64__)
+static JSON_STRUCT_FORCE_INLINE bool hasEscapeOut(uint8x16_t chunk)
+{
+  uint8x16_t special = vorrq_u8(vcltq_u8(chunk, vdupq_n_u8(0x20)),
+                                vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('"')), vceqq_u8(chunk, vdupq_n_u8('\\'))));
+  return vmaxvq_u8(special) != 0;
+}
+#endif
+
 // Returns the offset of the first character in [data, data+len) that needs
-// JSON string escaping (byte <= 0x0d, '"', or '\\'), or len if none. The clean
-// (no-escape) run is by far the common case, so scan it with SIMD when possible.
+// JSON string escaping, or len if none. The clean (no-escape) run is by far
+// the common case, so scan it with SIMD when possible.
 static JSON_STRUCT_FORCE_INLINE size_t findFirstEscapeOut(const char *JSON_STRUCT_RESTRICT data, size_t len)
 {
   size_t i = 0;
 #if defined(JSON_STRUCT_HAS_AVX2)
+  for (; i + 32 <= len; i += 32)
   {
-    const __m256i vquote = _mm256_set1_epi8('"');
-    const __m256i vbackslash = _mm256_set1_epi8('\\');
-    const __m256i vctrl = _mm256_set1_epi8(0x0d);
-    for (; i + 32 <= len; i += 32)
-    {
-      __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
-      __m256i le_ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, vctrl), chunk);
-      __m256i is_q = _mm256_cmpeq_epi8(chunk, vquote);
-      __m256i is_b = _mm256_cmpeq_epi8(chunk, vbackslash);
-      __m256i sp = _mm256_or_si256(_mm256_or_si256(le_ctrl, is_q), is_b);
-      int mask = _mm256_movemask_epi8(sp);
-      if (mask != 0)
-        return i + bit_scan_forward((unsigned int)mask);
-    }
+    unsigned int mask = escapeOutMask(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+    if (mask != 0)
+      return i + bit_scan_forward(mask);
   }
 #elif defined(JSON_STRUCT_HAS_SSE2)
+  for (; i + 16 <= len; i += 16)
   {
-    const __m128i vquote = _mm_set1_epi8('"');
-    const __m128i vbackslash = _mm_set1_epi8('\\');
-    const __m128i vctrl = _mm_set1_epi8(0x0d);
-    for (; i + 16 <= len; i += 16)
-    {
-      __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
-      __m128i le_ctrl = _mm_cmpeq_epi8(_mm_min_epu8(chunk, vctrl), chunk);
-      __m128i is_q = _mm_cmpeq_epi8(chunk, vquote);
-      __m128i is_b = _mm_cmpeq_epi8(chunk, vbackslash);
-      __m128i sp = _mm_or_si128(_mm_or_si128(le_ctrl, is_q), is_b);
-      int mask = _mm_movemask_epi8(sp);
-      if (mask != 0)
-        return i + bit_scan_forward((unsigned int)mask);
-    }
+    unsigned int mask = escapeOutMask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+    if (mask != 0)
+      return i + bit_scan_forward(mask);
+  }
+#endif
+  for (; i < len; i++)
+  {
+    if (needsEscapeOut(static_cast<unsigned char>(data[i])))
+      return i;
+  }
+  return len;
+}
+
+// Copies [data, data+len) to out up to the first character that needs escaping, and returns the number of bytes
+// copied. ESCAPE_JSON stops at needsEscapeOut characters and ASCII_ONLY at bytes >= 0x80. Clean 32 and 16 byte
+// blocks are stored as they are loaded, so there is only one pass over the string.
+template <bool ESCAPE_JSON, bool ASCII_ONLY>
+static JSON_STRUCT_FORCE_INLINE size_t copyUntilEscapeOut(const char *JSON_STRUCT_RESTRICT data, size_t len,
+                                                          char *JSON_STRUCT_RESTRICT out)
+{
+  size_t i = 0;
+#if defined(JSON_STRUCT_HAS_AVX2)
+  for (; i + 32 <= len; i += 32)
+  {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), chunk);
+    unsigned int mask = (ESCAPE_JSON ? escapeOutMask(chunk) : 0u) |
+                        (ASCII_ONLY ? (unsigned int)_mm256_movemask_epi8(chunk) : 0u);
+    if (mask != 0)
+      return i + bit_scan_forward(mask);
+  }
+#endif
+#if defined(JSON_STRUCT_HAS_SSE2)
+  for (; i + 16 <= len; i += 16)
+  {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), chunk);
+    unsigned int mask =
+      (ESCAPE_JSON ? escapeOutMask(chunk) : 0u) | (ASCII_ONLY ? (unsigned int)_mm_movemask_epi8(chunk) : 0u);
+    if (mask != 0)
+      return i + bit_scan_forward(mask);
+  }
+#elif defined(JSON_STRUCT_HAS_NEON) && defined(__aarch64__)
+  for (; i + 16 <= len; i += 16)
+  {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(data + i));
+    if ((ESCAPE_JSON && hasEscapeOut(chunk)) || (ASCII_ONLY && vmaxvq_u8(chunk) >= 0x80))
+      break;
+    vst1q_u8(reinterpret_cast<uint8_t *>(out + i), chunk);
   }
 #endif
   for (; i < len; i++)
   {
-    unsigned char c = static_cast<unsigned char>(data[i]);
-    if (c <= 0x0d || c == '"' || c == '\\')
+    const unsigned char c = static_cast<unsigned char>(data[i]);
+    if ((ESCAPE_JSON && needsEscapeOut(c)) || (ASCII_ONLY && c >= 0x80))
       return i;
+    out[i] = data[i];
   }
   return len;
 }
 
-static DataRef handle_json_escapes_out(const std::string &data, std::string &buffer)
+// Writes the escape sequence for c, which needsEscapeOut, to out and returns its size, at most 6.
+static inline size_t escapeOut(char c, char *out)
+{
+  static const char hex[] = "0123456789abcdef";
+  out[0] = '\\';
+  switch (c)
+  {
+  case '\b':
+    out[1] = 'b';
+    return 2;
+  case '\t':
+    out[1] = 't';
+    return 2;
+  case '\n':
+    out[1] = 'n';
+    return 2;
+  case '\f':
+    out[1] = 'f';
+    return 2;
+  case '\r':
+    out[1] = 'r';
+    return 2;
+  case '"':
+    out[1] = '"';
+    return 2;
+  case '\\':
+    out[1] = '\\';
+    return 2;
+  default:
+    out[1] = 'u';
+    out[2] = '0';
+    out[3] = '0';
+    out[4] = hex[(static_cast<unsigned char>(c) >> 4) & 0xf];
+    out[5] = hex[static_cast<unsigned char>(c) & 0xf];
+    return 6;
+  }
+}
+
+static inline void writeUnicodeEscape(unsigned int unit, char *out)
+{
+  static const char hex[] = "0123456789abcdef";
+  out[0] = '\\';
+  out[1] = 'u';
+  out[2] = hex[(unit >> 12) & 0xf];
+  out[3] = hex[(unit >> 8) & 0xf];
+  out[4] = hex[(unit >> 4) & 0xf];
+  out[5] = hex[unit & 0xf];
+}
+
+// Decodes the UTF-8 sequence starting at data, whose first byte is >= 0x80, and writes it to out as \uXXXX, or as
+// a surrogate pair for code points above 0xffff. Returns the size written, 6 or 12, and sets consumed to the number
+// of input bytes used. A byte that does not start a valid, shortest form sequence is consumed alone as \ufffd.
+static inline size_t escapeNonAsciiOut(const char *data, size_t size, char *out, size_t *consumed)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  const unsigned char lead = bytes[0];
+  size_t length = 0;
+  unsigned int cp = 0;
+  // The valid range of the second byte depends on the lead byte, which rules out overlong forms and surrogates
+  unsigned char second_min = 0x80;
+  unsigned char second_max = 0xbf;
+  if (lead >= 0xc2 && lead <= 0xdf)
+  {
+    length = 2;
+    cp = lead & 0x1f;
+  }
+  else if (lead >= 0xe0 && lead <= 0xef)
+  {
+    length = 3;
+    cp = lead & 0x0f;
+    if (lead == 0xe0)
+      second_min = 0xa0;
+    else if (lead == 0xed)
+      second_max = 0x9f;
+  }
+  else if (lead >= 0xf0 && lead <= 0xf4)
+  {
+    length = 4;
+    cp = lead & 0x07;
+    if (lead == 0xf0)
+      second_min = 0x90;
+    else if (lead == 0xf4)
+      second_max = 0x8f;
+  }
+
+  bool valid = length && length <= size && bytes[1] >= second_min && bytes[1] <= second_max;
+  for (size_t k = 1; valid && k < length; k++)
+  {
+    valid = (bytes[k] & 0xc0) == 0x80;
+    cp = (cp << 6) | (bytes[k] & 0x3f);
+  }
+  if (!valid)
+  {
+    *consumed = 1;
+    writeUnicodeEscape(0xfffd, out);
+    return 6;
+  }
+
+  *consumed = length;
+  if (cp < 0x10000)
+  {
+    writeUnicodeEscape(cp, out);
+    return 6;
+  }
+  cp -= 0x10000;
+  writeUnicodeEscape(0xd800 + (cp >> 10), out);
+  writeUnicodeEscape(0xdc00 + (cp & 0x3ff), out + 6);
+  return 12;
+}
+
+static inline DataRef handle_json_escapes_out(const char *d, size_t n, std::string &buffer)
 {
-  const char *d = data.data();
-  const size_t n = data.size();
   size_t start_index = 0;
   size_t i = 0;
   while (i < n)
@@ -6048,33 +7976,8 @@ static DataRef handle_json_escapes_out(const std::string &data, std::string &buf
     }
     start_index = i + 1;
 
-    switch (cur)
-    {
-    case '\b':
-      buffer.append("\\b", 2);
-      break;
-    case '\t':
-      buffer.append("\\t", 2);
-      break;
-    case '\n':
-      buffer.append("\\n", 2);
-      break;
-    case '\f':
-      buffer.append("\\f", 2);
-      break;
-    case '\r':
-      buffer.append("\\r", 2);
-      break;
-    case '\"':
-      buffer.append("\\\"", 2);
-      break;
-    case '\\':
-      buffer.append("\\\\", 2);
-      break;
-    default:
-      buffer.push_back(cur);
-      break;
-    }
+    char escape[6];
+    buffer.append(escape, escapeOut(cur, escape));
     i++;
   }
   if (buffer.size())
@@ -6085,7 +7988,353 @@ static DataRef handle_json_escapes_out(const std::string &data, std::string &buf
     }
     return DataRef(buffer.data(), buffer.size());
   }
-  return DataRef(data.data(), data.size());
+  return DataRef(d, n);
+}
+
+static inline DataRef handle_json_escapes_out(const std::string &data, std::string &buffer)
+{
+  return handle_json_escapes_out(data.data(), data.size(), buffer);
+}
+} // namespace Internal
+
+inline bool Serializer::writeEscapedString(const DataRef &data, bool escape_json)
+{
+  if (!write(Internal::makeStringLiteral("\"")))
+    return false;
+  const bool ascii_only = m_option.escapeNonAscii();
+  size_t i = 0;
+  while (i < data.size)
+  {
+    const size_t free = m_current_buffer.free();
+    if (!free)
+    {
+      markCurrentSerializerBufferFull();
+      if (!m_current_buffer.free())
+        return false;
+      continue;
+    }
+    const size_t chunk = std::min(data.size - i, free);
+    const char *from = data.data + i;
+    char *to = m_current_buffer.buffer + m_current_buffer.used;
+    const size_t copied = !ascii_only ? Internal::copyUntilEscapeOut<true, false>(from, chunk, to)
+                          : escape_json ? Internal::copyUntilEscapeOut<true, true>(from, chunk, to)
+                                        : Internal::copyUntilEscapeOut<false, true>(from, chunk, to);
+    m_current_buffer.used += copied;
+    i += copied;
+    if (copied == chunk)
+      continue;
+    char escape[12];
+    size_t consumed = 1;
+    const size_t escape_size = static_cast<unsigned char>(data.data[i]) >= 0x80
+                                 ? Internal::escapeNonAsciiOut(data.data + i, data.size - i, escape, &consumed)
+                                 : Internal::escapeOut(data.data[i], escape);
+    if (!write(escape, escape_size))
+      return false;
+    i += consumed;
+  }
+  return write(Internal::makeStringLiteral("\""));
+}
+
+namespace Internal
+{
+static JSON_STRUCT_FORCE_INLINE bool isJsonWhitespace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static JSON_STRUCT_FORCE_INLINE size_t skipJsonWhitespace(const char *data, size_t size)
+{
+  if (!size || !isJsonWhitespace(data[0]))
+    return 0;
+  size_t i = 0;
+#if defined(JSON_STRUCT_HAS_AVX2)
+  if (size >= 32)
+    i = skipWhitespaceAVX2(data, size);
+#elif defined(JSON_STRUCT_HAS_NEON)
+  if (size >= 16)
+    i = skipWhitespaceNEON(data, size);
+#elif defined(JSON_STRUCT_HAS_SSE2)
+  if (size >= 16)
+    i = skipWhitespaceSIMD(data, size);
+#endif
+  while (i < size && isJsonWhitespace(data[i]))
+    i++;
+  return i;
+}
+
+// Returns the size of the strict JSON number at the start of data, or 0 if there is none.
+static inline size_t scanJsonNumber(const char *data, size_t size)
+{
+  size_t i = 0;
+  if (i < size && data[i] == '-')
+    i++;
+  if (i == size)
+    return 0;
+  if (data[i] == '0')
+    i++;
+  else if (data[i] >= '1' && data[i] <= '9')
+    while (i < size && data[i] >= '0' && data[i] <= '9')
+      i++;
+  else
+    return 0;
+  if (i < size && data[i] == '.')
+  {
+    size_t digits = ++i;
+    while (i < size && data[i] >= '0' && data[i] <= '9')
+      i++;
+    if (i == digits)
+      return 0;
+  }
+  if (i < size && (data[i] == 'e' || data[i] == 'E'))
+  {
+    i++;
+    if (i < size && (data[i] == '+' || data[i] == '-'))
+      i++;
+    size_t digits = i;
+    while (i < size && data[i] >= '0' && data[i] <= '9')
+      i++;
+    if (i == digits)
+      return 0;
+  }
+  return i;
+}
+
+/*!
+ * Minifies or pretty prints strict JSON straight from the input bytes, giving the same output as running the tokens
+ * through a Serializer. Whitespace is skipped and string contents are copied with SIMD, and only the structure is
+ * looked at one byte at a time. The input is validated on the way, and run() returns false for anything that is not
+ * a plain JSON object or array, like comments, unquoted names or a syntax error. reformat then takes the token path,
+ * which reports the error or handles the input like it always has.
+ */
+class RawReformatter
+{
+public:
+  RawReformatter(const char *data, size_t size, std::string &out, bool pretty, size_t shift_size)
+    : m_data(data)
+    , m_size(size)
+    , m_pos(0)
+    , m_out(out)
+    , m_used(0)
+    , m_pretty(pretty)
+    , m_shift_size(shift_size)
+  {
+  }
+
+  bool run()
+  {
+    // Minified output is never larger than the input, so the buffer only grows for pretty output
+    m_out.resize(std::max(m_size, size_t(64)));
+    bool ok = parse();
+    m_out.resize(ok ? m_used : 0);
+    return ok;
+  }
+
+private:
+  enum Expect
+  {
+    Value,
+    FirstValue,
+    Name,
+    FirstName,
+    Next
+  };
+
+  bool parse()
+  {
+    skipWhitespace();
+    if (m_pos == m_size || (m_data[m_pos] != '{' && m_data[m_pos] != '['))
+      return false;
+    Expect expect = Value;
+    while (true)
+    {
+      skipWhitespace();
+      if (m_pos == m_size)
+        return false;
+      const char c = m_data[m_pos];
+      if (expect == Next)
+      {
+        const char close = m_stack.back() == '{' ? '}' : ']';
+        if (c == close)
+        {
+          if (!closeContainer(close))
+            return false;
+          if (m_stack.empty())
+          {
+            skipWhitespace();
+            return m_pos == m_size;
+          }
+          continue;
+        }
+        if (c != ',')
+          return false;
+        write(',');
+        m_pos++;
+        expect = m_stack.back() == '{' ? Name : Value;
+        continue;
+      }
+      if (expect == FirstName || expect == FirstValue)
+      {
+        if (c == (expect == FirstName ? '}' : ']'))
+        {
+          if (!closeContainer(c))
+            return false;
+          if (m_stack.empty())
+          {
+            skipWhitespace();
+            return m_pos == m_size;
+          }
+          expect = Next;
+          continue;
+        }
+      }
+      if (!m_stack.empty())
+        newline(m_stack.size());
+      if (expect == Name || expect == FirstName)
+      {
+        if (c != '"' || !copyString())
+          return false;
+        skipWhitespace();
+        if (m_pos == m_size || m_data[m_pos] != ':')
+          return false;
+        m_pos++;
+        if (m_pretty)
+          write(": ", 2);
+        else
+          write(':');
+        skipWhitespace();
+        if (m_pos == m_size)
+          return false;
+      }
+      if (!copyValue(expect))
+        return false;
+    }
+  }
+
+  // Copies the value at m_pos and sets expect to what has to follow it.
+  bool copyValue(Expect &expect)
+  {
+    const char c = m_data[m_pos];
+    if (c == '{' || c == '[')
+    {
+      write(c);
+      m_stack.push_back(c);
+      m_pos++;
+      expect = c == '{' ? FirstName : FirstValue;
+      return true;
+    }
+    expect = Next;
+    if (c == '"')
+      return copyString();
+    size_t size = 0;
+    if (c == 't' && m_size - m_pos >= 4 && memcmp(m_data + m_pos, "true", 4) == 0)
+      size = 4;
+    else if (c == 'f' && m_size - m_pos >= 5 && memcmp(m_data + m_pos, "false", 5) == 0)
+      size = 5;
+    else if (c == 'n' && m_size - m_pos >= 4 && memcmp(m_data + m_pos, "null", 4) == 0)
+      size = 4;
+    else
+      size = scanJsonNumber(m_data + m_pos, m_size - m_pos);
+    if (!size || m_pos + size == m_size)
+      return false;
+    const char after = m_data[m_pos + size];
+    if (!isJsonWhitespace(after) && after != ',' && after != '}' && after != ']')
+      return false;
+    write(m_data + m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+  bool copyString()
+  {
+    write('"');
+    m_pos++;
+    while (true)
+    {
+      const size_t remaining = m_size - m_pos;
+      reserve(remaining);
+      const size_t copied = copyUntilEscapeOut<true, false>(m_data + m_pos, remaining, &m_out[m_used]);
+      m_used += copied;
+      m_pos += copied;
+      if (m_pos == m_size)
+        return false;
+      const char c = m_data[m_pos];
+      if (c == '"')
+      {
+        write('"');
+        m_pos++;
+        return true;
+      }
+      // Raw control characters are left to the tokenizer
+      if (c != '\\' || m_pos + 1 == m_size)
+        return false;
+      write(m_data + m_pos, 2);
+      m_pos += 2;
+    }
+  }
+
+  bool closeContainer(char close)
+  {
+    m_stack.pop_back();
+    newline(m_stack.size());
+    write(close);
+    m_pos++;
+    return true;
+  }
+
+  void newline(size_t depth)
+  {
+    if (!m_pretty)
+      return;
+    const size_t indent = depth * m_shift_size;
+    reserve(indent + 1);
+    m_out[m_used++] = '\n';
+    memset(&m_out[m_used], ' ', indent);
+    m_used += indent;
+  }
+
+  void skipWhitespace()
+  {
+    m_pos += skipJsonWhitespace(m_data + m_pos, m_size - m_pos);
+  }
+
+  void reserve(size_t size)
+  {
+    if (JSON_STRUCT_UNLIKELY(m_out.size() - m_used < size))
+      m_out.resize(std::max(m_out.size() * 2, m_used + size));
+  }
+
+  void write(char c)
+  {
+    reserve(1);
+    m_out[m_used++] = c;
+  }
+
+  void write(const char *data, size_t size)
+  {
+    reserve(size);
+    memcpy(&m_out[m_used], data, size);
+    m_used += size;
+  }
+
+  const char *m_data;
+  size_t m_size;
+  size_t m_pos;
+  std::string &m_out;
+  size_t m_used;
+  bool m_pretty;
+  size_t m_shift_size;
+  std::string m_stack;
+};
+
+static inline bool reformatRaw(const char *data, size_t size, std::string &out, const SerializerOptions &options)
+{
+  // The options where the Serializer writes plain minified or pretty printed output
+  if (options.depth() || options.escapeNonAscii() || options.tokenDelimiter() != ",")
+    return false;
+  const bool pretty = options.style() == SerializerOptions::Pretty;
+  if (pretty ? options.postfix() != "\n" : options.shiftSize() == 2 || !options.postfix().empty())
+    return false;
+  return RawReformatter(data, size, out, pretty, size_t(options.shiftSize())).run();
 }
 } // namespace Internal
 /// \private
@@ -6101,15 +8350,69 @@ struct TypeHandler<std::string>
 
   static inline void from(const std::string &str, Token &token, Serializer &serializer)
   {
-    std::string buffer;
-    DataRef ref = Internal::handle_json_escapes_out(str, buffer);
     token.value_type = Type::String;
-    token.value.data = ref.data;
-    token.value.size = ref.size;
+    token.value.data = str.data();
+    token.value.size = str.size();
+    serializer.writeEscaped(token);
+  }
+};
+
+/// \private
+template <>
+struct TypeHandler<InternedString>
+{
+  static inline Error to(InternedString &to_type, ParseContext &context)
+  {
+    if (!context.intern_pool)
+      return context.tokenizer.updateErrorContext(Error::IllegalDataValue,
+                                                  "InternedString requires ParseContext::intern_pool to be set");
+    const DataRef &value = context.token.value;
+    if (memchr(value.data, '\\', value.size))
+    {
+      std::string unescaped;
+      Internal::handle_json_escapes_in(value, unescaped);
+      to_type.str = context.intern_pool->intern(unescaped);
+    }
+    else
+    {
+      to_type.str = context.intern_pool->intern(value.data, value.size);
+    }
+    return Error::NoError;
+  }
+
+  static inline void from(const InternedString &str, Token &token, Serializer &serializer)
+  {
+    if (str.str)
+    {
+      TypeHandler<std::string>::from(*str.str, token, serializer);
+      return;
+    }
+    token.value_type = Type::String;
+    token.value = DataRef("");
     serializer.write(token);
   }
 };
 
+/// \private
+template <size_t INLINE_CAPACITY>
+struct TypeHandler<BasicCompactString<INLINE_CAPACITY>>
+{
+  static inline Error to(BasicCompactString<INLINE_CAPACITY> &to_type, ParseContext &context)
+  {
+    to_type.clear();
+    Internal::handle_json_escapes_in(context.token.value, to_type);
+    return Error::NoError;
+  }
+
+  static inline void from(const BasicCompactString<INLINE_CAPACITY> &str, Token &token, Serializer &serializer)
+  {
+    token.value_type = Type::String;
+    token.value.data = str.data();
+    token.value.size = str.size();
+    serializer.writeEscaped(token);
+  }
+};
+
 namespace Internal
 {
 // This code is taken from https://github.com/jorgen/float_tools
@@ -6130,6 +8433,7 @@ template <typename T>
 struct parsed_string : float_base10<T>
 {
   const char *endptr;
+  bool digits_truncated;
 };
 
 enum class parse_string_error
@@ -7903,7 +10207,8 @@ inline parse_string_error parseNumber(const char *number, size_t size, parsed_st
 {
   const char *current;
   set_end_ptr<T> setendptr(parsedString, current);
-  int desimal_position = -1;
+  bool seen_decimal_point = false;
+  int exp_adjustment = 0;
   bool increase_significand = true;
 
   parsedString.negative = false;
@@ -7912,6 +10217,7 @@ inline parse_string_error parseNumber(const char *number, size_t size, parsed_st
   parsedString.significand_digit_count = 0;
   parsedString.significand = 0;
   parsedString.exp = 0;
+  parsedString.digits_truncated = false;
 
   const char *number_end = number + size;
   current = find_if(number, number_end, [](const char a) { return !is_space(a); });
@@ -7932,43 +10238,50 @@ inline parse_string_error parseNumber(const char *number, size_t size, parsed_st
 
     if (c == '.')
     {
-      if (desimal_position >= 0)
+      if (seen_decimal_point)
         return parse_string_error::multiple_commas;
-      desimal_position = parsedString.significand_digit_count;
+      seen_decimal_point = true;
+    }
+    else if (c == '0' && parsedString.significand == 0)
+    {
+      // Leading zeros are not significant digits
+      if (seen_decimal_point)
+        exp_adjustment--;
     }
     else
     {
       bool keep_digit = NoDigitCount;
       if (!keep_digit)
         keep_digit = parsedString.significand_digit_count < 19;
-      if (keep_digit)
-      {
-        parsedString.significand = parsedString.significand * T(10) + T(int(c) - '0');
-        parsedString.significand_digit_count++;
-      }
-      else if (increase_significand && parsedString.significand_digit_count < 20)
+      if (!keep_digit && increase_significand && parsedString.significand_digit_count < 20)
       {
         increase_significand = false;
-        uint64_t digit = uint64_t(c) - '0';
         static_assert(NoDigitCount || std::is_same<T, uint64_t>::value,
                       "When NoDigitCount is used the significand type has to be uint64_t");
+        uint64_t digit = uint64_t(c) - '0';
         auto biggest_multiplier = (std::numeric_limits<uint64_t>::max() - digit) / parsedString.significand;
-
-        if (biggest_multiplier >= 10)
-        {
-          parsedString.significand = parsedString.significand * uint64_t(10) + digit;
-          parsedString.significand_digit_count++;
-        }
+        keep_digit = biggest_multiplier >= 10;
+      }
+      if (keep_digit)
+      {
+        parsedString.significand = parsedString.significand * T(10) + T(int(c) - '0');
+        parsedString.significand_digit_count++;
+        if (seen_decimal_point)
+          exp_adjustment--;
+      }
+      else
+      {
+        if (!seen_decimal_point)
+          exp_adjustment++;
+        if (c != '0')
+          parsedString.digits_truncated = true;
       }
     }
     current++;
   }
   if (current == number_end || (*current != 'e' && *current != 'E'))
   {
-    if (desimal_position >= 0)
-      parsedString.exp = desimal_position - parsedString.significand_digit_count;
-    else
-      parsedString.exp = 0;
+    parsedString.exp = exp_adjustment;
     return parse_string_error::ok;
   }
   current++;
@@ -8009,10 +10322,7 @@ inline parse_string_error parseNumber(const char *number, size_t size, parsed_st
   if (exponent_nagative)
     exponent = -exponent;
 
-  if (desimal_position >= 0)
-    parsedString.exp = desimal_position - parsedString.significand_digit_count + exponent;
-  else
-    parsedString.exp = exponent;
+  parsedString.exp = exp_adjustment + exponent;
   return parse_string_error::ok;
 }
 
@@ -8041,9 +10351,494 @@ inline uint64_t getPow10(uint32_t pow)
   return data[pow];
 }
 
+// Eisel-Lemire conversion as described in "Number Parsing at a Gigabyte per Second" by
+// Daniel Lemire, following the fast_float implementation. It is exact whenever the
+// significand holds all the digits of the input. When digits were truncated both the
+// significand and the significand + 1 are converted, and the caller falls back to the slow
+// path when they disagree.
+inline const uint64_t *power_of_five_128()
+{
+  // 128 bit truncated approximations of 5^q for q in [-342, 308]
+  static const uint64_t table[] = {
+    0xeef453d6923bd65a, 0x113faa2906a13b3f, 0x9558b4661b6565f8, 0x4ac7ca59a424c507,
+    0xbaaee17fa23ebf76, 0x5d79bcf00d2df649, 0xe95a99df8ace6f53, 0xf4d82c2c107973dc,
+    0x91d8a02bb6c10594, 0x79071b9b8a4be869, 0xb64ec836a47146f9, 0x9748e2826cdee284,
+    0xe3e27a444d8d98b7, 0xfd1b1b2308169b25, 0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7,
+    0xb208ef855c969f4f, 0xbdbd2d335e51a935, 0xde8b2b66b3bc4723, 0xad2c788035e61382,
+    0x8b16fb203055ac76, 0x4c3bcb5021afcc31, 0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d,
+    0xd953e8624b85dd78, 0xd71d6dad34a2af0d, 0x87d4713d6f33aa6b, 0x8672648c40e5ad68,
+    0xa9c98d8ccb009506, 0x680efdaf511f18c2, 0xd43bf0effdc0ba48, 0x0212bd1b2566def2,
+    0x84a57695fe98746d, 0x014bb630f7604b57, 0xa5ced43b7e3e9188, 0x419ea3bd35385e2d,
+    0xcf42894a5dce35ea, 0x52064cac828675b9, 0x818995ce7aa0e1b2, 0x7343efebd1940993,
+    0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8, 0xca66fa129f9b60a6, 0xd41a26e077774ef6,
+    0xfd00b897478238d0, 0x8920b098955522b4, 0x9e20735e8cb16382, 0x55b46e5f5d5535b0,
+    0xc5a890362fddbc62, 0xeb2189f734aa831d, 0xf712b443bbd52b7b, 0xa5e9ec7501d523e4,
+    0x9a6bb0aa55653b2d, 0x47b233c92125366e, 0xc1069cd4eabe89f8, 0x999ec0bb696e840a,
+    0xf148440a256e2c76, 0xc00670ea43ca250d, 0x96cd2a865764dbca, 0x380406926a5e5728,
+    0xbc807527ed3e12bc, 0xc605083704f5ecf2, 0xeba09271e88d976b, 0xf7864a44c633682e,
+    0x93445b8731587ea3, 0x7ab3ee6afbe0211d, 0xb8157268fdae9e4c, 0x5960ea05bad82964,
+    0xe61acf033d1a45df, 0x6fb92487298e33bd, 0x8fd0c16206306bab, 0xa5d3b6d479f8e056,
+    0xb3c4f1ba87bc8696, 0x8f48a4899877186c, 0xe0b62e2929aba83c, 0x331acdabfe94de87,
+    0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14, 0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9,
+    0xdb71e91432b1a24a, 0xc9e82cd9f69d6150, 0x892731ac9faf056e, 0xbe311c083a225cd2,
+    0xab70fe17c79ac6ca, 0x6dbd630a48aaf406, 0xd64d3d9db981787d, 0x092cbbccdad5b108,
+    0x85f0468293f0eb4e, 0x25bbf56008c58ea5, 0xa76c582338ed2621, 0xaf2af2b80af6f24e,
+    0xd1476e2c07286faa, 0x1af5af660db4aee1, 0x82cca4db847945ca, 0x50d98d9fc890ed4d,
+    0xa37fce126597973c, 0xe50ff107bab528a0, 0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8,
+    0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a, 0x9faacf3df73609b1, 0x77b191618c54e9ac,
+    0xc795830d75038c1d, 0xd59df5b9ef6a2417, 0xf97ae3d0d2446f25, 0x4b0573286b44ad1d,
+    0x9becce62836ac577, 0x4ee367f9430aec32, 0xc2e801fb244576d5, 0x229c41f793cda73f,
+    0xf3a20279ed56d48a, 0x6b43527578c1110f, 0x9845418c345644d6, 0x830a13896b78aaa9,
+    0xbe5691ef416bd60c, 0x23cc986bc656d553, 0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8,
+    0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9, 0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53,
+    0xe858ad248f5c22c9, 0xd1b3400f8f9cff68, 0x91376c36d99995be, 0x23100809b9c21fa1,
+    0xb58547448ffffb2d, 0xabd40a0c2832a78a, 0xe2e69915b3fff9f9, 0x16c90c8f323f516c,
+    0x8dd01fad907ffc3b, 0xae3da7d97f6792e3, 0xb1442798f49ffb4a, 0x99cd11cfdf41779c,
+    0xdd95317f31c7fa1d, 0x40405643d711d583, 0x8a7d3eef7f1cfc52, 0x482835ea666b2572,
+    0xad1c8eab5ee43b66, 0xda3243650005eecf, 0xd863b256369d4a40, 0x90bed43e40076a82,
+    0x873e4f75e2224e68, 0x5a7744a6e804a291, 0xa90de3535aaae202, 0x711515d0a205cb36,
+    0xd3515c2831559a83, 0x0d5a5b44ca873e03, 0x8412d9991ed58091, 0xe858790afe9486c2,
+    0xa5178fff668ae0b6, 0x626e974dbe39a872, 0xce5d73ff402d98e3, 0xfb0a3d212dc8128f,
+    0x80fa687f881c7f8e, 0x7ce66634bc9d0b99, 0xa139029f6a239f72, 0x1c1fffc1ebc44e80,
+    0xc987434744ac874e, 0xa327ffb266b56220, 0xfbe9141915d7a922, 0x4bf1ff9f0062baa8,
+    0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9, 0xc4ce17b399107c22, 0xcb550fb4384d21d3,
+    0xf6019da07f549b2b, 0x7e2a53a146606a48, 0x99c102844f94e0fb, 0x2eda7444cbfc426d,
+    0xc0314325637a1939, 0xfa911155fefb5308, 0xf03d93eebc589f88, 0x793555ab7eba27ca,
+    0x96267c7535b763b5, 0x4bc1558b2f3458de, 0xbbb01b9283253ca2, 0x9eb1aaedfb016f16,
+    0xea9c227723ee8bcb, 0x465e15a979c1cadc, 0x92a1958a7675175f, 0x0bfacd89ec191ec9,
+    0xb749faed14125d36, 0xcef980ec671f667b, 0xe51c79a85916f484, 0x82b7e12780e7401a,
+    0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810, 0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15,
+    0xdfbdcece67006ac9, 0x67a791e093e1d49a, 0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0,
+    0xaecc49914078536d, 0x58fae9f773886e18, 0xda7f5bf590966848, 0xaf39a475506a899e,
+    0x888f99797a5e012d, 0x6d8406c952429603, 0xaab37fd7d8f58178, 0xc8e5087ba6d33b83,
+    0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64, 0x855c3be0a17fcd26, 0x5cf2eea09a55067f,
+    0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e, 0xd0601d8efc57b08b, 0xf13b94daf124da26,
+    0x823c12795db6ce57, 0x76c53d08d6b70858, 0xa2cb1717b52481ed, 0x54768c4b0c64ca6e,
+    0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09, 0xfe5d54150b090b02, 0xd3f93b35435d7c4c,
+    0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf, 0xc6b8e9b0709f109a, 0x359ab6419ca1091b,
+    0xf867241c8cc6d4c0, 0xc30163d203c94b62, 0x9b407691d7fc44f8, 0x79e0de63425dcf1d,
+    0xc21094364dfb5636, 0x985915fc12f542e4, 0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d,
+    0x979cf3ca6cec5b5a, 0xa705992ceecf9c42, 0xbd8430bd08277231, 0x50c6ff782a838353,
+    0xece53cec4a314ebd, 0xa4f8bf5635246428, 0x940f4613ae5ed136, 0x871b7795e136be99,
+    0xb913179899f68584, 0x28e2557b59846e3f, 0xe757dd7ec07426e5, 0x331aeada2fe589cf,
+    0x9096ea6f3848984f, 0x3ff0d2c85def7621, 0xb4bca50b065abe63, 0x0fed077a756b53a9,
+    0xe1ebce4dc7f16dfb, 0xd3e8495912c62894, 0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c,
+    0xb080392cc4349dec, 0xbd8d794d96aacfb3, 0xdca04777f541c567, 0xecf0d7a0fc5583a0,
+    0x89e42caaf9491b60, 0xf41686c49db57244, 0xac5d37d5b79b6239, 0x311c2875c522ced5,
+    0xd77485cb25823ac7, 0x7d633293366b828b, 0x86a8d39ef77164bc, 0xae5dff9c02033197,
+    0xa8530886b54dbdeb, 0xd9f57f830283fdfc, 0xd267caa862a12d66, 0xd072df63c324fd7b,
+    0x8380dea93da4bc60, 0x4247cb9e59f71e6d, 0xa46116538d0deb78, 0x52d9be85f074e608,
+    0xcd795be870516656, 0x67902e276c921f8b, 0x806bd9714632dff6, 0x00ba1cd8a3db53b6,
+    0xa086cfcd97bf97f3, 0x80e8a40eccd228a4, 0xc8a883c0fdaf7df0, 0x6122cd128006b2cd,
+    0xfad2a4b13d1b5d6c, 0x796b805720085f81, 0x9cc3a6eec6311a63, 0xcbe3303674053bb0,
+    0xc3f490aa77bd60fc, 0xbedbfc4411068a9c, 0xf4f1b4d515acb93b, 0xee92fb5515482d44,
+    0x991711052d8bf3c5, 0x751bdd152d4d1c4a, 0xbf5cd54678eef0b6, 0xd262d45a78a0635d,
+    0xef340a98172aace4, 0x86fb897116c87c34, 0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0,
+    0xbae0a846d2195712, 0x8974836059cca109, 0xe998d258869facd7, 0x2bd1a438703fc94b,
+    0x91ff83775423cc06, 0x7b6306a34627ddcf, 0xb67f6455292cbf08, 0x1a3bc84c17b1d542,
+    0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93, 0x8e938662882af53e, 0x547eb47b7282ee9c,
+    0xb23867fb2a35b28d, 0xe99e619a4f23aa43, 0xdec681f9f4c31f31, 0x6405fa00e2ec94d4,
+    0x8b3c113c38f9f37e, 0xde83bc408dd3dd04, 0xae0b158b4738705e, 0x9624ab50b148d445,
+    0xd98ddaee19068c76, 0x3badd624dd9b0957, 0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6,
+    0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c, 0xd47487cc8470652b, 0x7647c3200069671f,
+    0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073, 0xa5fb0a17c777cf09, 0xf468107100525890,
+    0xcf79cc9db955c2cc, 0x7182148d4066eeb4, 0x81ac1fe293d599bf, 0xc6f14cd848405530,
+    0xa21727db38cb002f, 0xb8ada00e5a506a7c, 0xca9cf1d206fdc03b, 0xa6d90811f0e4851c,
+    0xfd442e4688bd304a, 0x908f4a166d1da663, 0x9e4a9cec15763e2e, 0x9a598e4e043287fe,
+    0xc5dd44271ad3cdba, 0x40eff1e1853f29fd, 0xf7549530e188c128, 0xd12bee59e68ef47c,
+    0x9a94dd3e8cf578b9, 0x82bb74f8301958ce, 0xc13a148e3032d6e7, 0xe36a52363c1faf01,
+    0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1, 0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9,
+    0xbcb2b812db11a5de, 0x7415d448f6b6f0e7, 0xebdf661791d60f56, 0x111b495b3464ad21,
+    0x936b9fcebb25c995, 0xcab10dd900beec34, 0xb84687c269ef3bfb, 0x3d5d514f40eea742,
+    0xe65829b3046b0afa, 0x0cb4a5a3112a5112, 0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab,
+    0xb3f4e093db73a093, 0x59ed216765690f56, 0xe0f218b8d25088b8, 0x306869c13ec3532c,
+    0x8c974f7383725573, 0x1e414218c73a13fb, 0xafbd2350644eeacf, 0xe5d1929ef90898fa,
+    0xdbac6c247d62a583, 0xdf45f746b74abf39, 0x894bc396ce5da772, 0x6b8bba8c328eb783,
+    0xab9eb47c81f5114f, 0x066ea92f3f326564, 0xd686619ba27255a2, 0xc80a537b0efefebd,
+    0x8613fd0145877585, 0xbd06742ce95f5f36, 0xa798fc4196e952e7, 0x2c48113823b73704,
+    0xd17f3b51fca3a7a0, 0xf75a15862ca504c5, 0x82ef85133de648c4, 0x9a984d73dbe722fb,
+    0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba, 0xcc963fee10b7d1b3, 0x318df905079926a8,
+    0xffbbcfe994e5c61f, 0xfdf17746497f7052, 0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633,
+    0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0, 0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0,
+    0x9c1661a651213e2d, 0x06bea10ca65c084e, 0xc31bfa0fe5698db8, 0x486e494fcff30a62,
+    0xf3e2f893dec3f126, 0x5a89dba3c3efccfa, 0x986ddb5c6b3a76b7, 0xf89629465a75e01c,
+    0xbe89523386091465, 0xf6bbb397f1135823, 0xee2ba6c0678b597f, 0x746aa07ded582e2c,
+    0x94db483840b717ef, 0xa8c2a44eb4571cdc, 0xba121a4650e4ddeb, 0x92f34d62616ce413,
+    0xe896a0d7e51e1566, 0x77b020baf9c81d17, 0x915e2486ef32cd60, 0x0ace1474dc1d122e,
+    0xb5b5ada8aaff80b8, 0x0d819992132456ba, 0xe3231912d5bf60e6, 0x10e1fff697ed6c69,
+    0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1, 0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2,
+    0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde, 0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b,
+    0xad4ab7112eb3929d, 0x86c16c98d2c953c6, 0xd89d64d57a607744, 0xe871c7bf077ba8b7,
+    0x87625f056c7c4a8b, 0x11471cd764ad4972, 0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf,
+    0xd389b47879823479, 0x4aff1d108d4ec2c3, 0x843610cb4bf160cb, 0xcedf722a585139ba,
+    0xa54394fe1eedb8fe, 0xc2974eb4ee658828, 0xce947a3da6a9273e, 0x733d226229feea32,
+    0x811ccc668829b887, 0x0806357d5a3f525f, 0xa163ff802a3426a8, 0xca07c2dcb0cf26f7,
+    0xc9bcff6034c13052, 0xfc89b393dd02f0b5, 0xfc2c3f3841f17c67, 0xbbac2078d443ace2,
+    0x9d9ba7832936edc0, 0xd54b944b84aa4c0d, 0xc5029163f384a931, 0x0a9e795e65d4df11,
+    0xf64335bcf065d37d, 0x4d4617b5ff4a16d5, 0x99ea0196163fa42e, 0x504bced1bf8e4e45,
+    0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6, 0xf07da27a82c37088, 0x5d767327bb4e5a4c,
+    0x964e858c91ba2655, 0x3a6a07f8d510f86f, 0xbbe226efb628afea, 0x890489f70a55368b,
+    0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e, 0x92c8ae6b464fc96f, 0x3b0b8bc90012929d,
+    0xb77ada0617e3bbcb, 0x09ce6ebb40173744, 0xe55990879ddcaabd, 0xcc420a6a101d0515,
+    0x8f57fa54c2a9eab6, 0x9fa946824a12232d, 0xb32df8e9f3546564, 0x47939822dc96abf9,
+    0xdff9772470297ebd, 0x59787e2b93bc56f7, 0x8bfbea76c619ef36, 0x57eb4edb3c55b65a,
+    0xaefae51477a06b03, 0xede622920b6b23f1, 0xdab99e59958885c4, 0xe95fab368e45eced,
+    0x88b402f7fd75539b, 0x11dbcb0218ebb414, 0xaae103b5fcd2a881, 0xd652bdc29f26a119,
+    0xd59944a37c0752a2, 0x4be76d3346f0495f, 0x857fcae62d8493a5, 0x6f70a4400c562ddb,
+    0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952, 0xd097ad07a71f26b2, 0x7e2000a41346a7a7,
+    0x825ecc24c873782f, 0x8ed400668c0c28c8, 0xa2f67f2dfa90563b, 0x728900802f0f32fa,
+    0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9, 0xfea126b7d78186bc, 0xe2f610c84987bfa8,
+    0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9, 0xc6ede63fa05d3143, 0x91503d1c79720dbb,
+    0xf8a95fcf88747d94, 0x75a44c6397ce912a, 0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba,
+    0xc24452da229b021b, 0xfbe85badce996168, 0xf2d56790ab41c2a2, 0xfae27299423fb9c3,
+    0x97c560ba6b0919a5, 0xdccd879fc967d41a, 0xbdb6b8e905cb600f, 0x5400e987bbc1c920,
+    0xed246723473e3813, 0x290123e9aab23b68, 0x9436c0760c86e30b, 0xf9a0b6720aaf6521,
+    0xb94470938fa89bce, 0xf808e40e8d5b3e69, 0xe7958cb87392c2c2, 0xb60b1d1230b20e04,
+    0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2, 0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3,
+    0xe2280b6c20dd5232, 0x25c6da63c38de1b0, 0x8d590723948a535f, 0x579c487e5a38ad0e,
+    0xb0af48ec79ace837, 0x2d835a9df0c6d851, 0xdcdb1b2798182244, 0xf8e431456cf88e65,
+    0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff, 0xac8b2d36eed2dac5, 0xe272467e3d222f3f,
+    0xd7adf884aa879177, 0x5b0ed81dcc6abb0f, 0x86ccbb52ea94baea, 0x98e947129fc2b4e9,
+    0xa87fea27a539e9a5, 0x3f2398d747b36224, 0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,
+    0x83a3eeeef9153e89, 0x1953cf68300424ac, 0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,
+    0xcdb02555653131b6, 0x3792f412cb06794d, 0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,
+    0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4, 0xc8de047564d20a8b, 0xf245825a5a445275,
+    0xfb158592be068d2e, 0xeed6e2f0f0d56712, 0x9ced737bb6c4183d, 0x55464dd69685606b,
+    0xc428d05aa4751e4c, 0xaa97e14c3c26b886, 0xf53304714d9265df, 0xd53dd99f4b3066a8,
+    0x993fe2c6d07b7fab, 0xe546a8038efe4029, 0xbf8fdb78849a5f96, 0xde98520472bdd033,
+    0xef73d256a5c0f77c, 0x963e66858f6d4440, 0x95a8637627989aad, 0xdde7001379a44aa8,
+    0xbb127c53b17ec159, 0x5560c018580d5d52, 0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,
+    0x9226712162ab070d, 0xcab3961304ca70e8, 0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,
+    0xe45c10c42a2b3b05, 0x8cb89a7db77c506a, 0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,
+    0xb267ed1940f1c61c, 0x55f038b237591ed3, 0xdf01e85f912e37a3, 0x6b6c46dec52f6688,
+    0x8b61313bbabce2c6, 0x2323ac4b3b3da015, 0xae397d8aa96c1b77, 0xabec975e0a0d081a,
+    0xd9c7dced53c72255, 0x96e7bd358c904a21, 0x881cea14545c7575, 0x7e50d64177da2e54,
+    0xaa242499697392d2, 0xdde50bd1d5d0b9e9, 0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,
+    0x84ec3c97da624ab4, 0xbd5af13bef0b113e, 0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,
+    0xcfb11ead453994ba, 0x67de18eda5814af2, 0x81ceb32c4b43fcf4, 0x80eacf948770ced7,
+    0xa2425ff75e14fc31, 0xa1258379a94d028d, 0xcad2f7f5359a3b3e, 0x096ee45813a04330,
+    0xfd87b5f28300ca0d, 0x8bca9d6e188853fc, 0x9e74d1b791e07e48, 0x775ea264cf55347e,
+    0xc612062576589dda, 0x95364afe032a819e, 0xf79687aed3eec551, 0x3a83ddbd83f52205,
+    0x9abe14cd44753b52, 0xc4926a9672793543, 0xc16d9a0095928a27, 0x75b7053c0f178294,
+    0xf1c90080baf72cb1, 0x5324c68b12dd6339, 0x971da05074da7bee, 0xd3f6fc16ebca5e04,
+    0xbce5086492111aea, 0x88f4bb1ca6bcf585, 0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,
+    0x9392ee8e921d5d07, 0x3aff322e62439fd0, 0xb877aa3236a4b449, 0x09befeb9fad487c3,
+    0xe69594bec44de15b, 0x4c2ebe687989a9b4, 0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,
+    0xb424dc35095cd80f, 0x538484c19ef38c95, 0xe12e13424bb40e13, 0x2865a5f206b06fba,
+    0x8cbccc096f5088cb, 0xf93f87b7442e45d4, 0xafebff0bcb24aafe, 0xf78f69a51539d749,
+    0xdbe6fecebdedd5be, 0xb573440e5a884d1c, 0x89705f4136b4a597, 0x31680a88f8953031,
+    0xabcc77118461cefc, 0xfdc20d2b36ba7c3e, 0xd6bf94d5e57a42bc, 0x3d32907604691b4d,
+    0x8637bd05af6c69b5, 0xa63f9a49c2c1b110, 0xa7c5ac471b478423, 0x0fcf80dc33721d54,
+    0xd1b71758e219652b, 0xd3c36113404ea4a9, 0x83126e978d4fdf3b, 0x645a1cac083126ea,
+    0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4, 0xcccccccccccccccc, 0xcccccccccccccccd,
+    0x8000000000000000, 0x0000000000000000, 0xa000000000000000, 0x0000000000000000,
+    0xc800000000000000, 0x0000000000000000, 0xfa00000000000000, 0x0000000000000000,
+    0x9c40000000000000, 0x0000000000000000, 0xc350000000000000, 0x0000000000000000,
+    0xf424000000000000, 0x0000000000000000, 0x9896800000000000, 0x0000000000000000,
+    0xbebc200000000000, 0x0000000000000000, 0xee6b280000000000, 0x0000000000000000,
+    0x9502f90000000000, 0x0000000000000000, 0xba43b74000000000, 0x0000000000000000,
+    0xe8d4a51000000000, 0x0000000000000000, 0x9184e72a00000000, 0x0000000000000000,
+    0xb5e620f480000000, 0x0000000000000000, 0xe35fa931a0000000, 0x0000000000000000,
+    0x8e1bc9bf04000000, 0x0000000000000000, 0xb1a2bc2ec5000000, 0x0000000000000000,
+    0xde0b6b3a76400000, 0x0000000000000000, 0x8ac7230489e80000, 0x0000000000000000,
+    0xad78ebc5ac620000, 0x0000000000000000, 0xd8d726b7177a8000, 0x0000000000000000,
+    0x878678326eac9000, 0x0000000000000000, 0xa968163f0a57b400, 0x0000000000000000,
+    0xd3c21bcecceda100, 0x0000000000000000, 0x84595161401484a0, 0x0000000000000000,
+    0xa56fa5b99019a5c8, 0x0000000000000000, 0xcecb8f27f4200f3a, 0x0000000000000000,
+    0x813f3978f8940984, 0x4000000000000000, 0xa18f07d736b90be5, 0x5000000000000000,
+    0xc9f2c9cd04674ede, 0xa400000000000000, 0xfc6f7c4045812296, 0x4d00000000000000,
+    0x9dc5ada82b70b59d, 0xf020000000000000, 0xc5371912364ce305, 0x6c28000000000000,
+    0xf684df56c3e01bc6, 0xc732000000000000, 0x9a130b963a6c115c, 0x3c7f400000000000,
+    0xc097ce7bc90715b3, 0x4b9f100000000000, 0xf0bdc21abb48db20, 0x1e86d40000000000,
+    0x96769950b50d88f4, 0x1314448000000000, 0xbc143fa4e250eb31, 0x17d955a000000000,
+    0xeb194f8e1ae525fd, 0x5dcfab0800000000, 0x92efd1b8d0cf37be, 0x5aa1cae500000000,
+    0xb7abc627050305ad, 0xf14a3d9e40000000, 0xe596b7b0c643c719, 0x6d9ccd05d0000000,
+    0x8f7e32ce7bea5c6f, 0xe4820023a2000000, 0xb35dbf821ae4f38b, 0xdda2802c8a800000,
+    0xe0352f62a19e306e, 0xd50b2037ad200000, 0x8c213d9da502de45, 0x4526f422cc340000,
+    0xaf298d050e4395d6, 0x9670b12b7f410000, 0xdaf3f04651d47b4c, 0x3c0cdd765f114000,
+    0x88d8762bf324cd0f, 0xa5880a69fb6ac800, 0xab0e93b6efee0053, 0x8eea0d047a457a00,
+    0xd5d238a4abe98068, 0x72a4904598d6d880, 0x85a36366eb71f041, 0x47a6da2b7f864750,
+    0xa70c3c40a64e6c51, 0x999090b65f67d924, 0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d,
+    0x82818f1281ed449f, 0xbff8f10e7a8921a4, 0xa321f2d7226895c7, 0xaff72d52192b6a0d,
+    0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490, 0xfee50b7025c36a08, 0x02f236d04753d5b4,
+    0x9f4f2726179a2245, 0x01d762422c946590, 0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5,
+    0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2, 0x9b934c3b330c8577, 0x63cc55f49f88eb2f,
+    0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb, 0xf316271c7fc3908a, 0x8bef464e3945ef7a,
+    0x97edd871cfda3a56, 0x97758bf0e3cbb5ac, 0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317,
+    0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd, 0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a,
+    0xb975d6b6ee39e436, 0xb3e2fd538e122b44, 0xe7d34c64a9c85d44, 0x60dbbca87196b616,
+    0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd, 0xb51d13aea4a488dd, 0x6babab6398bdbe41,
+    0xe264589a4dcdab14, 0xc696963c7eed2dd1, 0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2,
+    0xb0de65388cc8ada8, 0x3b25a55f43294bcb, 0xdd15fe86affad912, 0x49ef0eb713f39ebe,
+    0x8a2dbf142dfcc7ab, 0x6e3569326c784337, 0xacb92ed9397bf996, 0x49c2c37f07965404,
+    0xd7e77a8f87daf7fb, 0xdc33745ec97be906, 0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3,
+    0xa8acd7c0222311bc, 0xc40832ea0d68ce0c, 0xd2d80db02aabd62b, 0xf50a3fa490c30190,
+    0x83c7088e1aab65db, 0x792667c6da79e0fa, 0xa4b8cab1a1563f52, 0x577001b891185938,
+    0xcde6fd5e09abcf26, 0xed4c0226b55e6f86, 0x80b05e5ac60b6178, 0x544f8158315b05b4,
+    0xa0dc75f1778e39d6, 0x696361ae3db1c721, 0xc913936dd571c84c, 0x03bc3a19cd1e38e9,
+    0xfb5878494ace3a5f, 0x04ab48a04065c723, 0x9d174b2dcec0e47b, 0x62eb0d64283f9c76,
+    0xc45d1df942711d9a, 0x3ba5d0bd324f8394, 0xf5746577930d6500, 0xca8f44ec7ee36479,
+    0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb, 0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e,
+    0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e, 0x95d04aee3b80ece5, 0xbba1f1d158724a12,
+    0xbb445da9ca61281f, 0x2a8a6e45ae8edc97, 0xea1575143cf97226, 0xf52d09d71a3293bd,
+    0x924d692ca61be758, 0x593c2626705f9c56, 0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c,
+    0xe498f455c38b997a, 0x0b6dfb9c0f956447, 0x8edf98b59a373fec, 0x4724bd4189bd5eac,
+    0xb2977ee300c50fe7, 0x58edec91ec2cb657, 0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed,
+    0x8b865b215899f46c, 0xbd79e0d20082ee74, 0xae67f1e9aec07187, 0xecd8590680a3aa11,
+    0xda01ee641a708de9, 0xe80e6f4820cc9495, 0x884134fe908658b2, 0x3109058d147fdcdd,
+    0xaa51823e34a7eede, 0xbd4b46f0599fd415, 0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a,
+    0x850fadc09923329e, 0x03e2cf6bc604ddb0, 0xa6539930bf6bff45, 0x84db8346b786151c,
+    0xcfe87f7cef46ff16, 0xe612641865679a63, 0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e,
+    0xa26da3999aef7749, 0xe3be5e330f38f09d, 0xcb090c8001ab551c, 0x5cadf5bfd3072cc5,
+    0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6, 0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa,
+    0xc646d63501a1511d, 0xb281e1fd541501b8, 0xf7d88bc24209a565, 0x1f225a7ca91a4226,
+    0x9ae757596946075f, 0x3375788de9b06958, 0xc1a12d2fc3978937, 0x0052d6b1641c83ae,
+    0xf209787bb47d6b84, 0xc0678c5dbd23a49a, 0x9745eb4d50ce6332, 0xf840b7ba963646e0,
+    0xbd176620a501fbff, 0xb650e5a93bc3d898, 0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe,
+    0x93ba47c980e98cdf, 0xc66f336c36b10137, 0xb8a8d9bbe123f017, 0xb80b0047445d4184,
+    0xe6d3102ad96cec1d, 0xa60dc059157491e5, 0x9043ea1ac7e41392, 0x87c89837ad68db2f,
+    0xb454e4a179dd1877, 0x29babe4598c311fb, 0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a,
+    0x8ce2529e2734bb1d, 0x1899e4a65f58660c, 0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f,
+    0xdc21a1171d42645d, 0x76707543f4fa1f73, 0x899504ae72497eba, 0x6a06494a791c53a8,
+    0xabfa45da0edbde69, 0x0487db9d17636892, 0xd6f8d7509292d603, 0x45a9d2845d3c42b6,
+    0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2, 0xa7f26836f282b732, 0x8e6cac7768d7141e,
+    0xd1ef0244af2364ff, 0x3207d795430cd926, 0x8335616aed761f1f, 0x7f44e6bd49e807b8,
+    0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6, 0xcd036837130890a1, 0x36dba887c37a8c0f,
+    0x802221226be55a64, 0xc2494954da2c9789, 0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c,
+    0xc83553c5c8965d3d, 0x6f92829494e5acc7, 0xfa42a8b73abbf48c, 0xcb772339ba1f17f9,
+    0x9c69a97284b578d7, 0xff2a760414536efb, 0xc38413cf25e2d70d, 0xfef5138519684aba,
+    0xf46518c2ef5b8cd1, 0x7eb258665fc25d69, 0x98bf2f79d5993802, 0xef2f773ffbd97a61,
+    0xbeeefb584aff8603, 0xaafb550ffacfd8fa, 0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38,
+    0x952ab45cfa97a0b2, 0xdd945a747bf26183, 0xba756174393d88df, 0x94f971119aeef9e4,
+    0xe912b9d1478ceb17, 0x7a37cd5601aab85d, 0x91abb422ccb812ee, 0xac62e055c10ab33a,
+    0xb616a12b7fe617aa, 0x577b986b314d6009, 0xe39c49765fdf9d94, 0xed5a7e85fda0b80b,
+    0x8e41ade9fbebc27d, 0x14588f13be847307, 0xb1d219647ae6b31c, 0x596eb2d8ae258fc8,
+    0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb, 0x8aec23d680043bee, 0x25de7bb9480d5854,
+    0xada72ccc20054ae9, 0xaf561aa79a10ae6a, 0xd910f7ff28069da4, 0x1b2ba1518094da04,
+    0x87aa9aff79042286, 0x90fb44d2f05d0842, 0xa99541bf57452b28, 0x353a1607ac744a53,
+    0xd3fa922f2d1675f2, 0x42889b8997915ce8, 0x847c9b5d7c2e09b7, 0x69956135febada11,
+    0xa59bc234db398c25, 0x43fab9837e699095, 0xcf02b2c21207ef2e, 0x94f967e45e03f4bb,
+    0x8161afb94b44f57d, 0x1d1be0eebac278f5, 0xa1ba1ba79e1632dc, 0x6462d92a69731732,
+    0xca28a291859bbf93, 0x7d7b8f7503cfdcfe, 0xfcb2cb35e702af78, 0x5cda735244c3d43e,
+    0x9defbf01b061adab, 0x3a0888136afa64a7, 0xc56baec21c7a1916, 0x088aaa1845b8fdd0,
+    0xf6c69a72a3989f5b, 0x8aad549e57273d45, 0x9a3c2087a63f6399, 0x36ac54e2f678864b,
+    0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd, 0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5,
+    0x969eb7c47859e743, 0x9f644ae5a4b1b325, 0xbc4665b596706114, 0x873d5d9f0dde1fee,
+    0xeb57ff22fc0c7959, 0xa90cb506d155a7ea, 0x9316ff75dd87cbd8, 0x09a7f12442d588f2,
+    0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f, 0xe5d3ef282a242e81, 0x8f1668c8a86da5fa,
+    0x8fa475791a569d10, 0xf96e017d694487bc, 0xb38d92d760ec4455, 0x37c981dcc395a9ac,
+    0xe070f78d3927556a, 0x85bbe253f47b1417, 0x8c469ab843b89562, 0x93956d7478ccec8e,
+    0xaf58416654a6babb, 0x387ac8d1970027b2, 0xdb2e51bfe9d0696a, 0x06997b05fcc0319e,
+    0x88fcf317f22241e2, 0x441fece3bdf81f03, 0xab3c2fddeeaad25a, 0xd527e81cad7626c3,
+    0xd60b3bd56a5586f1, 0x8a71e223d8d3b074, 0x85c7056562757456, 0xf6872d5667844e49,
+    0xa738c6bebb12d16c, 0xb428f8ac016561db, 0xd106f86e69d785c7, 0xe13336d701beba52,
+    0x82a45b450226b39c, 0xecc0024661173473, 0xa34d721642b06084, 0x27f002d7f95d0190,
+    0xcc20ce9bd35c78a5, 0x31ec038df7b441f4, 0xff290242c83396ce, 0x7e67047175a15271,
+    0x9f79a169bd203e41, 0x0f0062c6e984d386, 0xc75809c42c684dd1, 0x52c07b78a3e60868,
+    0xf92e0c3537826145, 0xa7709a56ccdf8a82, 0x9bbcc7a142b17ccb, 0x88a66076400bb691,
+    0xc2abf989935ddbfe, 0x6acff893d00ea435, 0xf356f7ebf83552fe, 0x0583f6b8c4124d43,
+    0x98165af37b2153de, 0xc3727a337a8b704a, 0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c,
+    0xeda2ee1c7064130c, 0x1162def06f79df73, 0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8,
+    0xb9a74a0637ce2ee1, 0x6d953e2bd7173692, 0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437,
+    0x910ab1d4db9914a0, 0x1d9c9892400a22a2, 0xb54d5e4a127f59c8, 0x2503beb6d00cab4b,
+    0xe2a0b5dc971f303a, 0x2e44ae64840fd61d, 0x8da471a9de737e24, 0x5ceaecfed289e5d2,
+    0xb10d8e1456105dad, 0x7425a83e872c5f47, 0xdd50f1996b947518, 0xd12f124e28f77719,
+    0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f, 0xace73cbfdc0bfb7b, 0x636cc64d1001550b,
+    0xd8210befd30efa5a, 0x3c47f7e05401aa4e, 0x8714a775e3e95c78, 0x65acfaec34810a71,
+    0xa8d9d1535ce3b396, 0x7f1839a741a14d0d, 0xd31045a8341ca07c, 0x1ede48111209a050,
+    0x83ea2b892091e44d, 0x934aed0aab460432, 0xa4e4b66b68b65d60, 0xf81da84d5617853f,
+    0xce1de40642e3f4b9, 0x36251260ab9d668e, 0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019,
+    0xa1075a24e4421730, 0xb24cf65b8612f81f, 0xc94930ae1d529cfc, 0xdee033f26797b627,
+    0xfb9b7cd9a4a7443c, 0x169840ef017da3b1, 0x9d412e0806e88aa5, 0x8e1f289560ee864e,
+    0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2, 0xf5b5d7ec8acb58a2, 0xae10af696774b1db,
+    0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29, 0xbff610b0cc6edd3f, 0x17fd090a58d32af3,
+    0xeff394dcff8a948e, 0xddfc4b4cef07f5b0, 0x95f83d0a1fb69cd9, 0x4abdaf101564f98e,
+    0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1, 0xea53df5fd18d5513, 0x84c86189216dc5ed,
+    0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4, 0xb7118682dbb66a77, 0x3fbc8c33221dc2a1,
+    0xe4d5e82392a40515, 0x0fabaf3feaa5334a, 0x8f05b1163ba6832d, 0x29cb4d87f2a7400e,
+    0xb2c71d5bca9023f8, 0x743e20e9ef511012, 0xdf78e4b2bd342cf6, 0x914da9246b255416,
+    0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e, 0xae9672aba3d0c320, 0xa184ac2473b529b1,
+    0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e, 0x8865899617fb1871, 0x7e2fa67c7a658892,
+    0xaa7eebfb9df9de8d, 0xddbb901b98feeab7, 0xd51ea6fa85785631, 0x552a74227f3ea565,
+    0x8533285c936b35de, 0xd53a88958f87275f, 0xa67ff273b8460356, 0x8a892abaf368f137,
+    0xd01fef10a657842c, 0x2d2b7569b0432d85, 0x8213f56a67f6b29b, 0x9c3b29620e29fc73,
+    0xa298f2c501f45f42, 0x8349f3ba91b47b8f, 0xcb3f2f7642717713, 0x241c70a936219a73,
+    0xfe0efb53d30dd4d7, 0xed238cd383aa0110, 0x9ec95d1463e8a506, 0xf4363804324a40aa,
+    0xc67bb4597ce2ce48, 0xb143c6053edcd0d5, 0xf81aa16fdc1b81da, 0xdd94b7868e94050a,
+    0x9b10a4e5e9913128, 0xca7cf2b4191c8326, 0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0,
+    0xf24a01a73cf2dccf, 0xbc633b39673c8cec, 0x976e41088617ca01, 0xd5be0503e085d813,
+    0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18, 0xec9c459d51852ba2, 0xddf8e7d60ed1219e,
+    0x93e1ab8252f33b45, 0xcabb90e5c942b503, 0xb8da1662e7b00a17, 0x3d6a751f3b936243,
+    0xe7109bfba19c0c9d, 0x0cc512670a783ad4, 0x906a617d450187e2, 0x27fb2b80668b24c5,
+    0xb484f9dc9641e9da, 0xb1f9f660802dedf6, 0xe1a63853bbd26451, 0x5e7873f8a0396973,
+    0x8d07e33455637eb2, 0xdb0b487b6423e1e8, 0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62,
+    0xdc5c5301c56b75f7, 0x7641a140cc7810fb, 0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d,
+    0xac2820d9623bf429, 0x546345fa9fbdcd44, 0xd732290fbacaf133, 0xa97c177947ad4095,
+    0x867f59a9d4bed6c0, 0x49ed8eabcccc485d, 0xa81f301449ee8c70, 0x5c68f256bfff5a74,
+    0xd226fc195c6a2f8c, 0x73832eec6fff3111, 0x83585d8fd9c25db7, 0xc831fd53c5ff7eab,
+    0xa42e74f3d032f525, 0xba3e7ca8b77f5e55, 0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb,
+    0x80444b5e7aa7cf85, 0x7980d163cf5b81b3, 0xa0555e361951c366, 0xd7e105bcc332621f,
+    0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7, 0xfa856334878fc150, 0xb14f98f6f0feb951,
+    0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3, 0xc3b8358109e84f07, 0x0a862f80ec4700c8,
+    0xf4a642e14c6262c8, 0xcd27bb612758c0fa, 0x98e7e9cccfbd7dbd, 0x8038d51cb897789c,
+    0xbf21e44003acdd2c, 0xe0470a63e6bd56c3, 0xeeea5d5004981478, 0x1858ccfce06cac74,
+    0x95527a5202df0ccb, 0x0f37801e0c43ebc8, 0xbaa718e68396cffd, 0xd30560258f54e6ba,
+    0xe950df20247c83fd, 0x47c6b82ef32a2069, 0x91d28b7416cdd27e, 0x4cdc331d57fa5441,
+    0xb6472e511c81471d, 0xe0133fe4adf8e952, 0xe3d8f9e563a198e5, 0x58180fddd97723a6,
+    0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648,
+  };
+  return table;
+}
+
+template <typename T>
+struct eisel_lemire_info;
+
+template <>
+struct eisel_lemire_info<double>
+{
+  using bits_type = uint64_t;
+  static constexpr int mantissa_explicit_bits = 52;
+  static constexpr int minimum_exponent = -1023;
+  static constexpr int infinite_power = 0x7FF;
+  static constexpr int smallest_power_of_ten = -342;
+  static constexpr int largest_power_of_ten = 308;
+  static constexpr int min_exponent_round_to_even = -4;
+  static constexpr int max_exponent_round_to_even = 23;
+};
+
+template <>
+struct eisel_lemire_info<float>
+{
+  using bits_type = uint32_t;
+  static constexpr int mantissa_explicit_bits = 23;
+  static constexpr int minimum_exponent = -127;
+  static constexpr int infinite_power = 0xFF;
+  static constexpr int smallest_power_of_ten = -65;
+  static constexpr int largest_power_of_ten = 38;
+  static constexpr int min_exponent_round_to_even = -17;
+  static constexpr int max_exponent_round_to_even = 10;
+};
+
+struct adjusted_mantissa
+{
+  uint64_t mantissa;
+  int power2;
+  bool operator==(const adjusted_mantissa &other) const
+  {
+    return mantissa == other.mantissa && power2 == other.power2;
+  }
+};
+
+template <typename T>
+inline adjusted_mantissa eisel_lemire_compute(int q, uint64_t w)
+{
+  using info = eisel_lemire_info<T>;
+  adjusted_mantissa answer;
+  if (w == 0 || q < info::smallest_power_of_ten)
+  {
+    answer.mantissa = 0;
+    answer.power2 = 0;
+    return answer;
+  }
+  if (q > info::largest_power_of_ten)
+  {
+    answer.mantissa = 0;
+    answer.power2 = info::infinite_power;
+    return answer;
+  }
+
+  int lz = 63 - bit_scan_reverse(w);
+  w <<= lz;
+
+  const uint64_t *pow5 = power_of_five_128() + 2 * (q - eisel_lemire_info<double>::smallest_power_of_ten);
+  uint64_t high;
+  uint64_t low = ryu::umul128(w, pow5[0], &high);
+  const uint64_t precision_mask = ~uint64_t(0) >> (info::mantissa_explicit_bits + 3);
+  if ((high & precision_mask) == precision_mask)
+  {
+    uint64_t second_high;
+    ryu::umul128(w, pow5[1], &second_high);
+    low += second_high;
+    if (second_high > low)
+      high++;
+  }
+
+  int upperbit = int(high >> 63);
+  int shift = upperbit + 64 - info::mantissa_explicit_bits - 3;
+  answer.mantissa = high >> shift;
+  answer.power2 = int((((152170 + 65536) * q) >> 16) + 63) + upperbit - lz - info::minimum_exponent;
+  if (answer.power2 <= 0)
+  {
+    if (-answer.power2 + 1 >= 64)
+    {
+      answer.mantissa = 0;
+      answer.power2 = 0;
+      return answer;
+    }
+    answer.mantissa >>= -answer.power2 + 1;
+    answer.mantissa += (answer.mantissa & 1);
+    answer.mantissa >>= 1;
+    answer.power2 = answer.mantissa < (uint64_t(1) << info::mantissa_explicit_bits) ? 0 : 1;
+    return answer;
+  }
+
+  // Exactly between two floats, round to even instead of up
+  if (low <= 1 && q >= info::min_exponent_round_to_even && q <= info::max_exponent_round_to_even &&
+      (answer.mantissa & 3) == 1)
+  {
+    if ((answer.mantissa << shift) == high)
+      answer.mantissa &= ~uint64_t(1);
+  }
+
+  answer.mantissa += (answer.mantissa & 1);
+  answer.mantissa >>= 1;
+  if (answer.mantissa >= (uint64_t(2) << info::mantissa_explicit_bits))
+  {
+    answer.mantissa = uint64_t(1) << info::mantissa_explicit_bits;
+    answer.power2++;
+  }
+  answer.mantissa &= ~(uint64_t(1) << info::mantissa_explicit_bits);
+  if (answer.power2 >= info::infinite_power)
+  {
+    answer.mantissa = 0;
+    answer.power2 = info::infinite_power;
+  }
+  return answer;
+}
+
+template <typename T, typename SignificandType>
+inline bool eisel_lemire(const parsed_string<SignificandType> &, T &)
+{
+  return false;
+}
+
+template <typename T>
+inline bool eisel_lemire(const parsed_string<uint64_t> &parsed, T &target)
+{
+  using info = eisel_lemire_info<T>;
+  adjusted_mantissa answer = eisel_lemire_compute<T>(parsed.exp, parsed.significand);
+  if (parsed.digits_truncated)
+  {
+    if (parsed.significand == std::numeric_limits<uint64_t>::max() ||
+        !(answer == eisel_lemire_compute<T>(parsed.exp, parsed.significand + 1)))
+      return false;
+  }
+  typename info::bits_type bits = typename info::bits_type(answer.mantissa) |
+                                  (typename info::bits_type(answer.power2) << info::mantissa_explicit_bits);
+  if (parsed.negative)
+    bits |= typename info::bits_type(1) << (sizeof(bits) * 8 - 1);
+  static_assert(sizeof(bits) == sizeof(T), "Wrong bits type for floating point type");
+  memcpy(&target, &bits, sizeof(target));
+  return true;
+}
+
 template <typename T, typename SignificandType>
 inline T convertToNumber(const parsed_string<SignificandType> &parsed)
 {
+  if (parsed.significand == 0)
+  {
+    return make_zero<T>(parsed.negative);
+  }
   int base10exponent = parsed.exp + parsed.significand_digit_count - 1;
   if (base10exponent > float_info<T>::max_base10_exponent())
   {
@@ -8053,10 +10848,6 @@ inline T convertToNumber(const parsed_string<SignificandType> &parsed)
   {
     return make_zero<T>(parsed.negative);
   }
-  if (parsed.significand == 0)
-  {
-    return make_zero<T>(parsed.negative);
-  }
 
 #if 1
   if (parsed.significand < ((uint64_t(1) << 53)) && iabs<int>(parsed.exp) < count_chars((uint64_t(1) << 53)))
@@ -8069,6 +10860,10 @@ inline T convertToNumber(const parsed_string<SignificandType> &parsed)
   }
 #endif
 
+  T eisel_lemire_result;
+  if (eisel_lemire(parsed, eisel_lemire_result))
+    return eisel_lemire_result;
+
   using uint_conversion_type = typename float_info<T>::str_to_float_conversion_type;
   uint_conversion_type a;
   uint_conversion_type b;
@@ -8118,6 +10913,9 @@ inline T convertToNumber(const parsed_string<SignificandType> &parsed)
 template <>
 inline float convertToNumber<float, uint64_t>(const parsed_string<uint64_t> &parsed)
 {
+  float eisel_lemire_result;
+  if (eisel_lemire(parsed, eisel_lemire_result))
+    return eisel_lemire_result;
   return float(convertToNumber<double, uint64_t>(parsed));
 }
 
@@ -8143,13 +10941,120 @@ inline std::string to_string(T f)
 
 namespace integer
 {
+inline const char *two_digits_lut()
+{
+  static const char data[201] = "00010203040506070809"
+                                "10111213141516171819"
+                                "20212223242526272829"
+                                "30313233343536373839"
+                                "40414243444546474849"
+                                "50515253545556575859"
+                                "60616263646566676869"
+                                "70717273747576777879"
+                                "80818283848586878889"
+                                "90919293949596979899";
+  return data;
+}
+
+inline int count_digits(uint64_t value)
+{
+  static const uint64_t powers_of_10[20] = {UINT64_C(1),
+                                            UINT64_C(10),
+                                            UINT64_C(100),
+                                            UINT64_C(1000),
+                                            UINT64_C(10000),
+                                            UINT64_C(100000),
+                                            UINT64_C(1000000),
+                                            UINT64_C(10000000),
+                                            UINT64_C(100000000),
+                                            UINT64_C(1000000000),
+                                            UINT64_C(10000000000),
+                                            UINT64_C(100000000000),
+                                            UINT64_C(1000000000000),
+                                            UINT64_C(10000000000000),
+                                            UINT64_C(100000000000000),
+                                            UINT64_C(1000000000000000),
+                                            UINT64_C(10000000000000000),
+                                            UINT64_C(100000000000000000),
+                                            UINT64_C(1000000000000000000),
+                                            UINT64_C(10000000000000000000)};
+  // log10(2) ~= 1233 / 4096, which gives a digit count that is at most one short.
+  value |= 1;
+  int approximation = ((bit_scan_reverse(value) + 1) * 1233) >> 12;
+  return approximation + (value >= powers_of_10[approximation]);
+}
+
+template <typename T, typename U>
+inline typename std::enable_if<(sizeof(U) <= sizeof(uint64_t)), int>::type count_magnitude_digits(T, U magnitude)
+{
+  return count_digits(uint64_t(magnitude));
+}
+
+template <typename T, typename U>
+inline typename std::enable_if<(sizeof(U) > sizeof(uint64_t)), int>::type count_magnitude_digits(T integer, U)
+{
+  return ft::count_chars(integer);
+}
+
+// Writes exactly count digits of value ending at end, zero padded on the left.
+template <typename U>
+inline void write_digits(U value, char *end, int count)
+{
+  const char *lut = two_digits_lut();
+  while (count >= 2)
+  {
+    const char *pair = lut + (value % 100) * 2;
+    value /= 100;
+    end -= 2;
+    end[0] = pair[0];
+    end[1] = pair[1];
+    count -= 2;
+  }
+  if (count)
+    end[-1] = char('0' + value % 10);
+}
+
+template <typename U>
+inline typename std::enable_if<(sizeof(U) <= sizeof(uint64_t)), void>::type write_digits_unsigned(U value, char *end,
+                                                                                                    int count)
+{
+  // Peel off eight digits at a time so the remaining work runs on independent 32 bit chains.
+  while (sizeof(U) > sizeof(uint32_t) && count > 9)
+  {
+    U quotient = U(value / 100000000);
+    write_digits(uint32_t(value - quotient * 100000000), end, 8);
+    value = quotient;
+    end -= 8;
+    count -= 8;
+  }
+  write_digits(uint32_t(value), end, count);
+}
+
+// Wider types are split into 19 digit chunks so that all the per digit work happens on 64 bit integers.
+template <typename U>
+inline typename std::enable_if<(sizeof(U) > sizeof(uint64_t)), void>::type write_digits_unsigned(U value, char *end,
+                                                                                                   int count)
+{
+  const uint64_t chunk_divisor = UINT64_C(10000000000000000000);
+  while (count > 19)
+  {
+    U quotient = value / chunk_divisor;
+    write_digits(uint64_t(value - quotient * chunk_divisor), end, 19);
+    value = quotient;
+    end -= 19;
+    count -= 19;
+  }
+  write_digits_unsigned(uint64_t(value), end, count);
+}
+
 template <typename T>
 inline int to_buffer(T integer, char *buffer, int buffer_size, int *digits_truncated = nullptr)
 {
   static_assert(std::is_integral<T>::value, "Tryint to convert non int to string");
-  int chars_to_write = ft::count_chars(integer);
+  typedef typename std::make_unsigned<T>::type UnsignedType;
   char *target_buffer = buffer;
   bool negative = false;
+  UnsignedType magnitude = UnsignedType(integer);
   if (std::is_signed<T>::value)
   {
     if (integer < 0)
@@ -8158,14 +11063,16 @@ inline int to_buffer(T integer, char *buffer, int buffer_size, int *digits_trunc
       target_buffer++;
       buffer_size--;
       negative = true;
+      magnitude = UnsignedType(0) - magnitude;
     }
   }
+  int chars_to_write = count_magnitude_digits(integer, magnitude);
   int to_remove = chars_to_write - buffer_size;
   if (to_remove > 0)
   {
     for (int i = 0; i < to_remove; i++)
     {
-      integer /= 10;
+      magnitude /= 10;
     }
     if (digits_truncated)
       *digits_truncated = to_remove;
@@ -8174,17 +11081,8 @@ inline int to_buffer(T integer, char *buffer, int buffer_size, int *digits_trunc
   else if (digits_truncated)
     *digits_truncated = 0;
 
-  for (int i = 0; i < chars_to_write; i++)
-  {
-    int remainder = integer % 10;
-    if (std::is_signed<T>::value)
-    {
-      if (negative)
-        remainder = -remainder;
-    }
-    integer /= 10;
-    target_buffer[chars_to_write - 1 - i] = '0' + char(remainder);
-  }
+  if (chars_to_write > 0)
+    write_digits_unsigned(magnitude, target_buffer + chars_to_write, chars_to_write);
 
   return chars_to_write + negative;
 }
@@ -8249,9 +11147,74 @@ inline T convert_to_integer(const parsed_string<SignificandType> &parsed)
   return make_integer_return_value<T>(significand, bool(parsed.negative));
 }
 
+// SWAR digit parsing, see "Fast integer parsing" in the fast_float and simdjson code bases.
+inline bool is_made_of_eight_digits(uint64_t val)
+{
+  return !(((val + UINT64_C(0x4646464646464646)) | (val - UINT64_C(0x3030303030303030))) &
+           UINT64_C(0x8080808080808080));
+}
+
+inline uint32_t parse_eight_digits(uint64_t val)
+{
+  const uint64_t mask = UINT64_C(0x000000FF000000FF);
+  const uint64_t mul1 = UINT64_C(0x000F424000000064); // 100 + (1000000 << 32)
+  const uint64_t mul2 = UINT64_C(0x0000271000000001); // 1 + (10000 << 32)
+  val -= UINT64_C(0x3030303030303030);
+  val = (val * 10) + (val >> 8);
+  val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+  return uint32_t(val);
+}
+
+// Handles the common case of an optional minus followed by at most 19 digits, which can
+// not overflow uint64_t. Returns false for anything else (fractions, exponents, whitespace,
+// longer numbers) so that the caller can use the general parser.
+template <typename T>
+inline bool to_integer_fast(const char *str, size_t size, T &target, const char *(&endptr))
+{
+  const char *current = str;
+  const char *end = str + size;
+  bool negative = false;
+  if (current < end && *current == '-')
+  {
+    negative = true;
+    current++;
+  }
+  const char *digits_start = current;
+  uint64_t value = 0;
+#if defined(JSON_STRUCT_LITTLE_ENDIAN)
+  for (int i = 0; i < 2 && end - current >= 8; i++)
+  {
+    uint64_t chunk;
+    memcpy(&chunk, current, sizeof(chunk));
+    if (!is_made_of_eight_digits(chunk))
+      break;
+    value = value * 100000000 + parse_eight_digits(chunk);
+    current += 8;
+  }
+#endif
+  while (current < end && uint8_t(*current - '0') < 10)
+  {
+    if (current - digits_start >= 19)
+      return false;
+    value = value * 10 + uint64_t(*current - '0');
+    current++;
+  }
+  if (current == digits_start)
+    return false;
+  if (current < end && (*current == '.' || *current == 'e' || *current == 'E'))
+    return false;
+  using SignificandType =
+    typename std::conditional<sizeof(T) <= sizeof(uint64_t), uint64_t, typename std::make_unsigned<T>::type>::type;
+  target = make_integer_return_value<T>(SignificandType(value), negative);
+  endptr = current;
+  return true;
+}
+
 template <typename T>
 inline parse_string_error to_integer(const char *str, size_t size, T &target, const char *(&endptr))
 {
+  if (to_integer_fast(str, size, target, endptr))
+    return parse_string_error::ok;
   using SignificandType =
     typename std::conditional<sizeof(T) <= sizeof(uint64_t), uint64_t, typename std::make_unsigned<T>::type>::type;
   parsed_string<SignificandType> ps;
@@ -8371,7 +11334,20 @@ inline void float_to_int_pow2(float g, big_uint_cmp &m, int &e2)
   e2 = ce ? int(ce) - 150 : -149;
 }
 
-inline void float_pair_midpoint(float g1, float g2, big_uint_cmp &mid_int, int &mid_pow2)
+inline void float_to_int_pow2(double g, big_uint_cmp &m, int &e2)
+{
+  uint64_t b;
+  memcpy(&b, &g, sizeof(b));
+  uint64_t ce = (b >> 52) & 0x7ff, mant = b & ((uint64_t(1) << 52) - 1);
+  uint64_t v = ce ? (mant | (uint64_t(1) << 52)) : mant;
+  m = big_uint_cmp();
+  m.w[0] = uint32_t(v);
+  m.w.push_back(uint32_t(v >> 32));
+  e2 = ce ? int(ce) - 1075 : -1074;
+}
+
+template <typename F>
+inline void float_pair_midpoint(F g1, F g2, big_uint_cmp &mid_int, int &mid_pow2)
 {
   big_uint_cmp m1, m2;
   int e1, e2;
@@ -8402,48 +11378,21 @@ inline bool float_mantissa_is_even(float g)
   return (b & 1) == 0;
 }
 
-// Clang builds compiled with -ffast-math (see the zero-value-test-fp-fast test
-// target) enable -Wnan-infinity-disabled and reject the isnan/isinf/infinity()
-// uses below. Those checks are intentional: json_struct keeps detecting and
-// handling non-finite values so the emitted JSON stays valid even in fast-math
-// builds. Suppress the warning locally (guarded against older clang that does
-// not know the option).
-#if defined(__clang__)
-#define JS_FP_NONFINITE_DIAG_PUSH                                                                                      \
-  _Pragma("clang diagnostic push") _Pragma("clang diagnostic ignored \"-Wunknown-warning-option\"")                    \
-    _Pragma("clang diagnostic ignored \"-Wnan-infinity-disabled\"")
-#define JS_FP_NONFINITE_DIAG_POP _Pragma("clang diagnostic pop")
-#else
-#define JS_FP_NONFINITE_DIAG_PUSH
-#define JS_FP_NONFINITE_DIAG_POP
-#endif
-
-inline float correctly_round_float(const char *str, size_t size, double d, float f)
+inline bool float_mantissa_is_even(double g)
 {
-  if (f != f || f == 0.0f)
-    return f;
-  float af = f < 0.0f ? -f : f;
-  JS_FP_NONFINITE_DIAG_PUSH
-  if (!std::isfinite(af))
-    return f;
-  double ad = d < 0.0 ? -d : d;
-  float up = std::nextafter(af, std::numeric_limits<float>::infinity());
-  float dn = std::nextafter(af, 0.0f);
-  bool have_up = up > af && std::isfinite(up);
-  double ulp_d = std::nextafter(ad, std::numeric_limits<double>::infinity()) - ad;
-  JS_FP_NONFINITE_DIAG_POP
-  bool near_hi = have_up && std::fabs(ad - 0.5 * (double(af) + double(up))) <= 4.0 * ulp_d;
-  bool near_lo = std::fabs(ad - 0.5 * (double(dn) + double(af))) <= 4.0 * ulp_d;
-  if (!near_hi && !near_lo)
-    return f;
+  uint64_t b;
+  memcpy(&b, &g, sizeof(b));
+  return (b & 1) == 0;
+}
 
+inline void decimal_string_to_big_uint(const char *str, size_t size, big_uint_cmp &digits, int &decimal_exp)
+{
   const char *p = str;
   const char *end = str + size;
   while (p < end && is_space(*p))
     p++;
   if (p < end && (*p == '-' || *p == '+'))
     p++;
-  big_uint_cmp digits;
   int fracdigits = 0;
   bool seen_dot = false;
   for (; p < end; ++p)
@@ -8463,7 +11412,7 @@ inline float correctly_round_float(const char *str, size_t size, double d, float
     if (seen_dot)
       fracdigits++;
   }
-  int decimal_exp = -fracdigits;
+  decimal_exp = -fracdigits;
   if (p < end && (*p == 'e' || *p == 'E'))
   {
     p++;
@@ -8481,6 +11430,46 @@ inline float correctly_round_float(const char *str, size_t size, double d, float
     }
     decimal_exp += en ? -ex : ex;
   }
+}
+
+// Clang builds compiled with -ffast-math (see the zero-value-test-fp-fast test
+// target) enable -Wnan-infinity-disabled and reject the isnan/isinf/infinity()
+// uses below. Those checks are intentional: json_struct keeps detecting and
+// handling non-finite values so the emitted JSON stays valid even in fast-math
+// builds. Suppress the warning locally (guarded against older clang that does
+// not know the option).
+#if defined(__clang__)
+#define JS_FP_NONFINITE_DIAG_PUSH                                                                                      \
+  _Pragma("clang diagnostic push") _Pragma("clang diagnostic ignored \"-Wunknown-warning-option\"")                    \
+    _Pragma("clang diagnostic ignored \"-Wnan-infinity-disabled\"")
+#define JS_FP_NONFINITE_DIAG_POP _Pragma("clang diagnostic pop")
+#else
+#define JS_FP_NONFINITE_DIAG_PUSH
+#define JS_FP_NONFINITE_DIAG_POP
+#endif
+
+inline float correctly_round_float(const char *str, size_t size, double d, float f)
+{
+  if (f != f || f == 0.0f)
+    return f;
+  float af = f < 0.0f ? -f : f;
+  JS_FP_NONFINITE_DIAG_PUSH
+  if (!std::isfinite(af))
+    return f;
+  double ad = d < 0.0 ? -d : d;
+  float up = std::nextafter(af, std::numeric_limits<float>::infinity());
+  float dn = std::nextafter(af, 0.0f);
+  bool have_up = up > af && std::isfinite(up);
+  double ulp_d = std::nextafter(ad, std::numeric_limits<double>::infinity()) - ad;
+  JS_FP_NONFINITE_DIAG_POP
+  bool near_hi = have_up && std::fabs(ad - 0.5 * (double(af) + double(up))) <= 4.0 * ulp_d;
+  bool near_lo = std::fabs(ad - 0.5 * (double(dn) + double(af))) <= 4.0 * ulp_d;
+  if (!near_hi && !near_lo)
+    return f;
+
+  big_uint_cmp digits;
+  int decimal_exp;
+  decimal_string_to_big_uint(str, size, digits, decimal_exp);
 
   float mag = af;
   if (near_hi)
@@ -8508,6 +11497,39 @@ inline float correctly_round_float(const char *str, size_t size, double d, float
   return std::signbit(f) ? -mag : mag;
 }
 
+// With more than 19-20 significant digits the significand is truncated, and the true value lies
+// between significand * 10^exp and (significand + 1) * 10^exp. When Eisel-Lemire gives different
+// results for these bounds the two candidates are adjacent, and the full decimal string is compared
+// against their midpoint.
+template <typename T>
+inline T correctly_round_truncated(const char *str, size_t size, const parsed_string<uint64_t> &parsed, T value)
+{
+  if (parsed.significand == std::numeric_limits<uint64_t>::max())
+    return value;
+  adjusted_mantissa lower = eisel_lemire_compute<T>(parsed.exp, parsed.significand);
+  adjusted_mantissa upper = eisel_lemire_compute<T>(parsed.exp, parsed.significand + 1);
+  parsed_string<uint64_t> bound = parsed;
+  bound.negative = false;
+  bound.digits_truncated = false;
+  T low;
+  T high;
+  eisel_lemire(bound, low);
+  if (lower == upper)
+    return parsed.negative ? -low : low;
+  bound.significand++;
+  eisel_lemire(bound, high);
+
+  big_uint_cmp digits;
+  int decimal_exp;
+  decimal_string_to_big_uint(str, size, digits, decimal_exp);
+  big_uint_cmp mid;
+  int e2;
+  float_pair_midpoint(low, high, mid, e2);
+  int c = compare_value_scaled(digits, decimal_exp, mid, e2);
+  T mag = c > 0 || (c == 0 && !float_mantissa_is_even(low)) ? high : low;
+  return parsed.negative ? -mag : mag;
+}
+
 template <typename T>
 inline parse_string_error to_ieee_t(const char *str, size_t size, T &target, const char *(&endptr))
 {
@@ -8521,6 +11543,8 @@ inline parse_string_error to_ieee_t(const char *str, size_t size, T &target, con
   else
   {
     target = convertToNumber<T>(ps);
+    if (JSON_STRUCT_UNLIKELY(ps.digits_truncated))
+      target = correctly_round_truncated(str, size, ps, target);
   }
   return parseResult;
 }
@@ -8535,7 +11559,7 @@ inline parse_string_error to_ieee_t<float>(const char *str, size_t size, float &
   {
     target = make_nan<float>(true, 1);
   }
-  else
+  else if (!eisel_lemire(ps, target))
   {
     double d = convertToNumber<double, uint64_t>(ps);
     target = correctly_round_float(str, size, d, float(d));
@@ -8553,30 +11577,222 @@ inline parse_string_error to_double(const char *str, size_t size, double &target
   return to_ieee_t(str, size, target, endptr);
 }
 
-} // namespace ft
-} // namespace Internal
-/// \private
-template <>
-struct TypeHandler<double>
+namespace ryu
 {
-  static inline Error to(double &to_type, ParseContext &context)
+// Rounds m * 2^e2 to the nearest multiple of 10^-decimals, ties to even, on the exact binary value. Returns false
+// when the result can not be computed with 128 bit intermediates.
+inline bool round_binary_to_decimals(uint64_t m, int e2, int decimals, uint64_t &rounded)
+{
+  if (decimals >= 0)
   {
-    const char *pointer;
-    auto result = Internal::ft::to_double(context.token.value.data, context.token.value.size, to_type, pointer);
-    if (result != Internal::ft::parse_string_error::ok ||
-        context.token.value.data + context.token.value.size != pointer)
-      return Error::FailedToParseDouble;
-    return Error::NoError;
+    if (decimals > 27)
+      return false;
+    uint64_t hi;
+    uint64_t lo = umul128(m, pow_int(5, decimals), &hi);
+    int shift = -(e2 + decimals);
+    if (shift <= 0)
+      return false;
+    if (shift >= 128)
+    {
+      rounded = 0;
+      return true;
+    }
+    uint64_t quotient_hi;
+    uint64_t quotient;
+    uint64_t remainder_hi;
+    uint64_t remainder;
+    uint64_t half_hi;
+    uint64_t half;
+    if (shift < 64)
+    {
+      quotient_hi = hi >> shift;
+      quotient = (lo >> shift) | (hi << (64 - shift));
+      remainder_hi = 0;
+      remainder = lo & ((uint64_t(1) << shift) - 1);
+      half_hi = 0;
+      half = uint64_t(1) << (shift - 1);
+    }
+    else
+    {
+      int high_shift = shift - 64;
+      quotient_hi = 0;
+      quotient = high_shift ? hi >> high_shift : hi;
+      remainder_hi = high_shift ? hi & ((uint64_t(1) << high_shift) - 1) : 0;
+      remainder = lo;
+      half_hi = high_shift ? uint64_t(1) << (high_shift - 1) : 0;
+      half = high_shift ? 0 : uint64_t(1) << 63;
+    }
+    if (quotient_hi)
+      return false;
+    bool above = remainder_hi > half_hi || (remainder_hi == half_hi && remainder > half);
+    bool tie = remainder_hi == half_hi && remainder == half;
+    rounded = quotient + (above || (tie && (quotient & 1)));
+    return true;
   }
 
-  static inline void from(const double &d, Token &token, Serializer &serializer)
+  int integer_decimals = -decimals;
+  if (integer_decimals > 19)
+    return false;
+  uint64_t divisor = pow_int(10, integer_decimals);
+  uint64_t integer_part;
+  bool has_fraction = false;
+  if (e2 >= 0)
   {
-    JS_FP_NONFINITE_DIAG_PUSH
-    if (std::isnan(d) || std::isinf(d))
-    {
-      // JSON has no NaN/Infinity literal; emit null so the output stays valid JSON
-      // instead of the bare "nan"/"inf" text ft::ryu produces.
-      static const char nullChar[] = "null";
+    if (e2 > 11)
+      return false;
+    integer_part = m << e2;
+  }
+  else if (-e2 >= 64)
+  {
+    integer_part = 0;
+    has_fraction = m != 0;
+  }
+  else
+  {
+    integer_part = m >> -e2;
+    has_fraction = (m & ((uint64_t(1) << -e2) - 1)) != 0;
+  }
+  uint64_t quotient = integer_part / divisor;
+  uint64_t remainder = integer_part % divisor;
+  uint64_t half = divisor / 2;
+  bool above = remainder > half || (remainder == half && has_fraction);
+  bool tie = remainder == half && !has_fraction;
+  rounded = quotient + (above || (tie && (quotient & 1)));
+  return true;
+}
+
+// Same as decode, but limits the result to a number of decimals or significant digits. Values that are already
+// short enough are returned as their shortest round trip representation.
+template <typename T>
+inline float_base10<uint64_t> decode_rounded(T f, bool fixed_decimals, int precision)
+{
+  if (fixed_decimals && !is_nan(f) && !is_inf(f))
+  {
+    int decimals = max(precision, 0);
+    bool negative;
+    int e2;
+    uint64_t m;
+    get_parts(f, negative, e2, m);
+    normalize<T>(e2, m);
+    uint64_t rounded;
+    // When 10^-decimals is wider than the gap between adjacent values, the correctly rounded value is also the
+    // shortest representation whenever that has fewer decimals, so the shortest search can be skipped.
+    if (m && decimals <= 27 && e2 + (decimals * 3322 + 999) / 1000 < 0 &&
+        round_binary_to_decimals(m, e2, decimals, rounded))
+    {
+      if (rounded == 0)
+        return {false, false, false, 1, 0, 0};
+      int exp = -decimals;
+      while (rounded % 10 == 0)
+      {
+        rounded /= 10;
+        exp++;
+      }
+      return {negative, false, false, uint8_t(count_chars(rounded)), exp, rounded};
+    }
+  }
+
+  float_base10<uint64_t> result = decode<T, uint64_t>(f);
+  if (result.nan || result.inf || result.significand == 0)
+    return result;
+  int decimals = fixed_decimals ? max(precision, 0) : max(precision, 1) - (result.significand_digit_count + result.exp);
+  if (-result.exp <= decimals)
+    return result;
+
+  bool negative;
+  int e2;
+  uint64_t m;
+  get_parts(f, negative, e2, m);
+  normalize<T>(e2, m);
+  uint64_t rounded;
+  if (!round_binary_to_decimals(m, e2, decimals, rounded))
+  {
+    // Out of range for 128 bit rounding, so round the shortest representation instead. No rounding boundary can lie
+    // between the shortest representation and the exact value, except when the shortest representation is itself
+    // the halfway point, so only then is the exact value consulted.
+    int drop = -result.exp - decimals;
+    if (drop > 19)
+    {
+      rounded = 0;
+    }
+    else
+    {
+      uint64_t divisor = pow_int(10, drop);
+      uint64_t remainder = result.significand % divisor;
+      rounded = result.significand / divisor;
+      if (remainder > divisor / 2)
+      {
+        rounded++;
+      }
+      else if (remainder == divisor / 2)
+      {
+        big_uint_cmp shortest_digits;
+        shortest_digits.w[0] = uint32_t(result.significand);
+        shortest_digits.w.push_back(uint32_t(result.significand >> 32));
+        big_uint_cmp exact;
+        int exact_exp2;
+        float_to_int_pow2(f < 0 ? -f : f, exact, exact_exp2);
+        int c = compare_value_scaled(shortest_digits, result.exp, exact, exact_exp2);
+        if (c < 0 || (c == 0 && (rounded & 1)))
+          rounded++;
+      }
+    }
+  }
+  if (rounded == 0)
+    return {false, false, false, 1, 0, 0};
+  int exp = -decimals;
+  while (rounded % 10 == 0)
+  {
+    rounded /= 10;
+    exp++;
+  }
+  result.significand = rounded;
+  result.exp = exp;
+  result.significand_digit_count = uint8_t(count_chars(rounded));
+  return result;
+}
+
+template <typename T>
+inline int to_buffer_rounded(T d, bool fixed_decimals, int precision, char *buffer, int buffer_size,
+                             int *digits_truncated = nullptr)
+{
+  auto decoded = decode_rounded(d, fixed_decimals, precision);
+  return convert_parsed_to_buffer(decoded, buffer, buffer_size, float_info<T>::str_to_float_expanded_length(),
+                                  digits_truncated);
+}
+} // namespace ryu
+
+} // namespace ft
+} // namespace Internal
+/// \private
+template <>
+struct TypeHandler<double>
+{
+  static inline Error to(double &to_type, ParseContext &context)
+  {
+    const char *pointer;
+    auto result = Internal::ft::to_double(context.token.value.data, context.token.value.size, to_type, pointer);
+    if (result != Internal::ft::parse_string_error::ok ||
+        context.token.value.data + context.token.value.size != pointer)
+      return Error::FailedToParseDouble;
+    return Error::NoError;
+  }
+
+  static inline void from(const double &d, Token &token, Serializer &serializer)
+  {
+    const SerializerOptions &options = serializer.options();
+    fromWithFormat(d, options.floatFormat(), options.floatPrecision(), token, serializer);
+  }
+
+  static inline void fromWithFormat(const double &d, FloatFormat format, int precision, Token &token,
+                                    Serializer &serializer)
+  {
+    JS_FP_NONFINITE_DIAG_PUSH
+    if (std::isnan(d) || std::isinf(d))
+    {
+      // JSON has no NaN/Infinity literal; emit null so the output stays valid JSON
+      // instead of the bare "nan"/"inf" text ft::ryu produces.
+      static const char nullChar[] = "null";
       token.value_type = Type::Null;
       token.value = DataRef(nullChar);
       serializer.write(token);
@@ -8586,7 +11802,10 @@ struct TypeHandler<double>
     // char buf[1/*'-'*/ + (DBL_MAX_10_EXP+1)/*308+1 digits*/ + 1/*'.'*/ + 6/*Default? precision*/ + 1/*\0*/];
     char buf[32];
     int size;
-    size = Internal::ft::ryu::to_buffer(d, buf, sizeof(buf));
+    if (format == FloatFormat::Shortest)
+      size = Internal::ft::ryu::to_buffer(d, buf, sizeof(buf));
+    else
+      size = Internal::ft::ryu::to_buffer_rounded(d, format == FloatFormat::FixedDecimals, precision, buf, sizeof(buf));
 
     if (size <= 0)
     {
@@ -8615,6 +11834,13 @@ struct TypeHandler<float>
   }
 
   static inline void from(const float &f, Token &token, Serializer &serializer)
+  {
+    const SerializerOptions &options = serializer.options();
+    fromWithFormat(f, options.floatFormat(), options.floatPrecision(), token, serializer);
+  }
+
+  static inline void fromWithFormat(const float &f, FloatFormat format, int precision, Token &token,
+                                    Serializer &serializer)
   {
     JS_FP_NONFINITE_DIAG_PUSH
     if (std::isnan(f) || std::isinf(f))
@@ -8629,7 +11855,10 @@ struct TypeHandler<float>
     JS_FP_NONFINITE_DIAG_POP
     char buf[16];
     int size;
-    size = Internal::ft::ryu::to_buffer(f, buf, sizeof(buf));
+    if (format == FloatFormat::Shortest)
+      size = Internal::ft::ryu::to_buffer(f, buf, sizeof(buf));
+    else
+      size = Internal::ft::ryu::to_buffer_rounded(f, format == FloatFormat::FixedDecimals, precision, buf, sizeof(buf));
     if (size < 0)
     {
       return;
@@ -8645,6 +11874,21 @@ struct TypeHandler<float>
 #undef JS_FP_NONFINITE_DIAG_PUSH
 #undef JS_FP_NONFINITE_DIAG_POP
 
+/// \private
+template <typename T, FloatFormat FORMAT, int PRECISION>
+struct TypeHandler<FormattedFloat<T, FORMAT, PRECISION>>
+{
+  static inline Error to(FormattedFloat<T, FORMAT, PRECISION> &to_type, ParseContext &context)
+  {
+    return TypeHandler<T>::to(to_type.data, context);
+  }
+
+  static inline void from(const FormattedFloat<T, FORMAT, PRECISION> &from_type, Token &token, Serializer &serializer)
+  {
+    TypeHandler<T>::fromWithFormat(from_type.data, FORMAT, PRECISION, token, serializer);
+  }
+};
+
 /// \private
 template <typename T>
 struct TypeHandlerIntType
@@ -8825,6 +12069,30 @@ public:
   }
 };
 
+/// \private
+template <typename T>
+struct TypeHandler<Tracked<T>>
+{
+public:
+  static inline Error to(Tracked<T> &to_type, ParseContext &context)
+  {
+    return TypeHandler<T>::to(to_type.edit(), context);
+  }
+
+  static inline void from(const Tracked<T> &tracked, Token &token, Serializer &serializer)
+  {
+    if (!serializer.deltaOnly() || !tracked.isDirty())
+    {
+      TypeHandler<T>::from(tracked(), token, serializer);
+      return;
+    }
+    // A dirty value is written in full, including the clean members of an object
+    serializer.setDeltaOnly(false);
+    TypeHandler<T>::from(tracked(), token, serializer);
+    serializer.setDeltaOnly(true);
+  }
+};
+
 #ifdef JS_STD_OPTIONAL
 /// \private
 template <typename T>
@@ -9003,6 +12271,78 @@ struct TypeHandler<T, typename std::enable_if_t<Internal::is_specialization<T, s
 };
 #endif
 
+namespace Internal
+{
+template <typename T>
+struct IsBulkNumber
+  : std::integral_constant<bool, (std::is_floating_point<T>::value && sizeof(T) <= sizeof(double)) ||
+                                   (std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                    sizeof(T) <= sizeof(uint64_t))>
+{
+};
+
+template <typename T>
+inline int formatBulkNumber(const T &value, const SerializerOptions &, char *target,
+                            typename std::enable_if<std::is_integral<T>::value, int>::type = 0)
+{
+  return ft::integer::to_buffer(value, target, 24);
+}
+
+template <typename T>
+inline int formatBulkNumber(const T &value, const SerializerOptions &options, char *target,
+                            typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0)
+{
+  if (ft::is_nan(value) || ft::is_inf(value))
+  {
+    memcpy(target, "null", 4);
+    return 4;
+  }
+  if (options.floatFormat() == FloatFormat::Shortest)
+    return ft::ryu::to_buffer(value, target, 32);
+  return ft::ryu::to_buffer_rounded(value, options.floatFormat() == FloatFormat::FixedDecimals,
+                                    options.floatPrecision(), target, 32);
+}
+
+/// \private
+/// Flat numeric arrays are parsed and serialized without a token per element.
+template <typename T, bool = IsBulkNumber<T>::value>
+struct NumberArray
+{
+  template <typename Store>
+  static bool parse(ParseContext &, Store &&)
+  {
+    return false;
+  }
+  static bool serialize(const T *, size_t, Serializer &)
+  {
+    return false;
+  }
+};
+
+template <typename T>
+struct NumberArray<T, true>
+{
+  template <typename Store>
+  static bool parse(ParseContext &context, Store &&store)
+  {
+    return context.tokenizer.scanNumberArray(context.token, [&context, &store](const char *data, size_t size) -> bool {
+      context.token.value = DataRef(data, size);
+      context.token.value_type = Type::Number;
+      T value = T();
+      return TypeHandler<T>::to(value, context) == Error::NoError && store(value);
+    });
+  }
+
+  static bool serialize(const T *values, size_t count, Serializer &serializer)
+  {
+    const SerializerOptions &options = serializer.options();
+    return serializer.writeArrayElements(count, 32, [values, &options](size_t index, char *target) {
+      return formatBulkNumber(values[index], options, target);
+    });
+  }
+};
+} // namespace Internal
+
 /// \private
 template <typename T, typename A>
 struct TypeHandler<std::vector<T, A>>
@@ -9011,12 +12351,17 @@ struct TypeHandler<std::vector<T, A>>
   {
     if (context.token.value_type != JS::Type::ArrayStart)
       return Error::ExpectedArrayStart;
+    to_type.clear();
+    if (Internal::NumberArray<T>::parse(context, [&to_type](const T &value) -> bool {
+          to_type.push_back(value);
+          return true;
+        }))
+      return Error::NoError;
     Error error = context.nextToken();
     if (error != JS::Error::NoError)
       return error;
-    to_type.clear();
     if (context.token.value_type != JS::Type::ArrayEnd)
-      to_type.reserve(10);
+      to_type.reserve(to_type.size() + 10);
     while (context.token.value_type != JS::Type::ArrayEnd)
     {
       to_type.emplace_back();
@@ -9039,9 +12384,12 @@ struct TypeHandler<std::vector<T, A>>
 
     token.name = DataRef("");
 
-    for (auto &index : vec)
+    if (!Internal::NumberArray<T>::serialize(vec.data(), vec.size(), serializer))
     {
-      TypeHandler<T>::from(index, token, serializer);
+      for (auto &index : vec)
+      {
+        TypeHandler<T>::from(index, token, serializer);
+      }
     }
 
     token.name = DataRef("");
@@ -9684,8 +13032,15 @@ public:
     if (context.token.value_type != Type::ArrayStart)
       return JS::Error::ExpectedArrayStart;
 
-    context.nextToken();
-    for (size_t i = 0; i < N; i++)
+    size_t i = 0;
+    if (!Internal::NumberArray<T>::parse(context, [&to_type, &i](const T &value) -> bool {
+          if (i == N)
+            return false;
+          to_type[i++] = value;
+          return true;
+        }))
+      context.nextToken();
+    for (; i < N; i++)
     {
       if (context.error != JS::Error::NoError)
         return context.error;
@@ -9707,8 +13062,11 @@ public:
     serializer.write(token);
 
     token.name = DataRef("");
-    for (size_t i = 0; i < N; i++)
-      TypeHandler<T>::from(from[i], token, serializer);
+    if (!Internal::NumberArray<T>::serialize(&from[0], N, serializer))
+    {
+      for (size_t i = 0; i < N; i++)
+        TypeHandler<T>::from(from[i], token, serializer);
+    }
 
     token.name = DataRef("");
     token.value_type = Type::ArrayEnd;
@@ -9717,6 +13075,47 @@ public:
   }
 };
 
+namespace Internal
+{
+// Returns the entry for key, holding a default constructed value. The key is only moved into the map when it is new,
+// a repeated key keeps its node and has its value reset, so the last occurrence wins.
+template <typename Map, typename Key>
+inline typename Map::iterator mapEntryForKey(Map &map, Key &key)
+{
+#ifdef JS_STD_OPTIONAL
+  auto inserted = map.try_emplace(std::move(key));
+  if (!inserted.second)
+    inserted.first->second = typename Map::mapped_type();
+  return inserted.first;
+#else
+  auto it = map.find(key);
+  if (it == map.end())
+    return map.emplace(std::move(key), typename Map::mapped_type()).first;
+  it->second = typename Map::mapped_type();
+  return it;
+#endif
+}
+
+// std::string keys are unescaped into a buffer that is reused for every member, and moved into the map when the
+// key is new. Other key types are constructed from the unescaped buffer.
+template <typename Map>
+inline typename Map::iterator mapEntryForName(Map &map, const DataRef &name, std::string &buffer, std::true_type)
+{
+  buffer.clear();
+  handle_json_escapes_in(name, buffer);
+  return mapEntryForKey(map, buffer);
+}
+
+template <typename Map>
+inline typename Map::iterator mapEntryForName(Map &map, const DataRef &name, std::string &buffer, std::false_type)
+{
+  buffer.clear();
+  handle_json_escapes_in(name, buffer);
+  typename Map::key_type key(buffer.data(), buffer.size());
+  return mapEntryForKey(map, key);
+}
+} // namespace Internal
+
 template <typename Key, typename Value, typename Map>
 struct TypeHandlerMap
 {
@@ -9730,14 +13129,13 @@ struct TypeHandlerMap
     Error error = context.nextToken();
     if (error != JS::Error::NoError)
       return error;
+    std::string key_buffer;
     while (context.token.value_type != Type::ObjectEnd)
     {
-      std::string str;
-      Internal::handle_json_escapes_in(context.token.name, str);
-      Key key(str.data(), str.size());
-      Value v;
-      error = TypeHandler<Value>::to(v, context);
-      to_type[std::move(key)] = std::move(v);
+      // The value is parsed in place, which also keeps what was parsed before an error, as assigning it did.
+      auto it = Internal::mapEntryForName(to_type, context.token.name, key_buffer,
+                                          typename std::is_same<Key, std::string>::type());
+      error = TypeHandler<Value>::to(it->second, context);
       if (error != JS::Error::NoError)
         return error;
       error = context.nextToken();
@@ -10150,6 +13548,341 @@ struct TypeHandler<ArrayVariableContent<T, COUNT>>
   }
 };
 
+namespace Internal
+{
+namespace base64
+{
+// Decodes both the standard and the url safe alphabet. Invalid characters map to 255.
+static constexpr unsigned char decode_table[256] = {
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62,  255, 62,  255, 63,  //
+  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  255, 255, 255, 255, 255, 255, //
+  255, 0,   1,   2,   3,   4,   5,   6,   7,   8,   9,   10,  11,  12,  13,  14,  //
+  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  255, 255, 255, 255, 63,  //
+  255, 26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,  //
+  41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255};
+
+static inline const char *alphabet(Base64Alphabet alphabet)
+{
+  return alphabet == Base64Alphabet::Standard ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+                                              : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+}
+
+inline size_t encodedSize(size_t size, Base64Alphabet alphabet)
+{
+  if (alphabet == Base64Alphabet::Standard)
+    return (size + 2) / 3 * 4;
+  return size / 3 * 4 + (size % 3 ? size % 3 + 1 : 0);
+}
+
+// Upper bound for the decoded size of size characters.
+inline size_t decodedSize(size_t size)
+{
+  return size / 4 * 3 + 2;
+}
+
+#ifdef JSON_STRUCT_HAS_AVX2
+// The SIMD kernels return how much input they consumed, always whole groups of 3 bytes or 4 characters. The decoder
+// stops at the first block containing something besides the alphabet it was given, and leaves the rest, including
+// padding and mixed alphabets, to the scalar loop.
+inline size_t encodeAVX2(const uint8_t *in, size_t size, char *out, Base64Alphabet alphabet)
+{
+  const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, //
+                                           1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const char plus = alphabet == Base64Alphabet::Standard ? '+' - 62 : '-' - 62;
+  const char slash = alphabet == Base64Alphabet::Standard ? '/' - 63 : '_' - 63;
+  const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, //
+                                             '0' - 52, '0' - 52, '0' - 52, '0' - 52, plus, slash, 'A', 0, 0,       //
+                                             'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, //
+                                             '0' - 52, '0' - 52, '0' - 52, '0' - 52, plus, slash, 'A', 0, 0);
+  size_t consumed = 0;
+  for (; size - consumed >= 28; consumed += 24, out += 32)
+  {
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + consumed));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + consumed + 12));
+    __m256i input = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuffle);
+
+    __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00)),
+                                    _mm256_set1_epi32(0x04000040));
+    __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0)),
+                                    _mm256_set1_epi32(0x01000010));
+    __m256i indices = _mm256_or_si256(t0, t1);
+
+    __m256i shift = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    shift = _mm256_or_si256(shift, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    shift = _mm256_shuffle_epi8(shift_lut, shift);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_add_epi8(indices, shift));
+  }
+  return consumed;
+}
+
+inline size_t decodeAVX2(const char *in, size_t size, uint8_t *out, Base64Alphabet alphabet)
+{
+  const bool standard = alphabet == Base64Alphabet::Standard;
+  // A character is invalid when the bits of its low and high nibble intersect.
+  const __m256i lut_lo =
+    standard ? _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b,
+                                0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+                                0x1b, 0x1b, 0x1b, 0x1a)
+             : _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x3b, 0x3b, 0x3a,
+                                0x3b, 0x33, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x3b,
+                                0x3b, 0x3a, 0x3b, 0x33);
+  const char hi_7 = standard ? 0x08 : 0x20;
+  const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, hi_7, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                          0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, hi_7, 0x10, 0x10,
+                                          0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  // Offset from character to value by high nibble. The one character sharing its nibble with letters is patched in.
+  const char plus = standard ? 62 - '+' : 62 - '-';
+  const __m256i lut_roll = _mm256_setr_epi8(0, 0, plus, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, //
+                                            0, 0, plus, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i slash = _mm256_set1_epi8(standard ? '/' : '_');
+  const __m256i slash_roll = _mm256_set1_epi8(standard ? 63 - '/' : 63 - '_');
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  const __m256i pack_shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, //
+                                                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i pack_permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+  size_t consumed = 0;
+  // The store writes 32 bytes for the 24 decoded ones, keep a full block of slack.
+  for (; size - consumed >= 44; consumed += 32, out += 24)
+  {
+    __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + consumed));
+    __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi16(str, 4), nibble_mask);
+    __m256i lo_nibbles = _mm256_and_si256(str, nibble_mask);
+    __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    if (!_mm256_testz_si256(lo, hi))
+      break;
+
+    __m256i roll = _mm256_shuffle_epi8(lut_roll, hi_nibbles);
+    roll = _mm256_blendv_epi8(roll, slash_roll, _mm256_cmpeq_epi8(str, slash));
+    str = _mm256_add_epi8(str, roll);
+
+    __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+    merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    merged = _mm256_shuffle_epi8(merged, pack_shuffle);
+    merged = _mm256_permutevar8x32_epi32(merged, pack_permute);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), merged);
+  }
+  return consumed;
+}
+#elif defined(JSON_STRUCT_HAS_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+// The SIMD kernels return how much input they consumed, always whole groups of 3 bytes or 4 characters. The decoder
+// stops at the first block containing a character outside both alphabets and leaves the rest to the scalar loop.
+inline size_t encodeNEON(const uint8_t *in, size_t size, char *out, Base64Alphabet alphabet)
+{
+  const uint8_t *chars = reinterpret_cast<const uint8_t *>(base64::alphabet(alphabet));
+  uint8x16x4_t table;
+  table.val[0] = vld1q_u8(chars);
+  table.val[1] = vld1q_u8(chars + 16);
+  table.val[2] = vld1q_u8(chars + 32);
+  table.val[3] = vld1q_u8(chars + 48);
+  const uint8x16_t mask = vdupq_n_u8(0x3f);
+
+  size_t consumed = 0;
+  for (; size - consumed >= 48; consumed += 48, out += 64)
+  {
+    uint8x16x3_t input = vld3q_u8(in + consumed);
+    uint8x16x4_t indices;
+    indices.val[0] = vshrq_n_u8(input.val[0], 2);
+    indices.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(input.val[0], 4), vshrq_n_u8(input.val[1], 4)), mask);
+    indices.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(input.val[1], 2), vshrq_n_u8(input.val[2], 6)), mask);
+    indices.val[3] = vandq_u8(input.val[2], mask);
+    uint8x16x4_t result;
+    result.val[0] = vqtbl4q_u8(table, indices.val[0]);
+    result.val[1] = vqtbl4q_u8(table, indices.val[1]);
+    result.val[2] = vqtbl4q_u8(table, indices.val[2]);
+    result.val[3] = vqtbl4q_u8(table, indices.val[3]);
+    vst4q_u8(reinterpret_cast<uint8_t *>(out), result);
+  }
+  return consumed;
+}
+
+inline size_t decodeNEON(const char *in, size_t size, uint8_t *out)
+{
+  uint8x16x4_t lo_table;
+  uint8x16x4_t hi_table;
+  for (int i = 0; i < 4; i++)
+  {
+    lo_table.val[i] = vld1q_u8(decode_table + i * 16);
+    hi_table.val[i] = vld1q_u8(decode_table + 64 + i * 16);
+  }
+  const uint8x16_t hi_offset = vdupq_n_u8(64);
+
+  size_t consumed = 0;
+  for (; size - consumed >= 64; consumed += 64, out += 48)
+  {
+    uint8x16x4_t str = vld4q_u8(reinterpret_cast<const uint8_t *>(in + consumed));
+    uint8x16x4_t values;
+    uint8x16_t invalid = vdupq_n_u8(0);
+    for (int i = 0; i < 4; i++)
+    {
+      // Indices outside a table leave the lane alone, so each character is looked up in exactly one of them.
+      values.val[i] =
+        vqtbx4q_u8(vqtbl4q_u8(lo_table, str.val[i]), hi_table, vsubq_u8(str.val[i], hi_offset));
+      invalid = vorrq_u8(invalid, vorrq_u8(values.val[i], str.val[i]));
+    }
+    if (vmaxvq_u8(invalid) & 0x80)
+      break;
+
+    uint8x16x3_t result;
+    result.val[0] = vorrq_u8(vshlq_n_u8(values.val[0], 2), vshrq_n_u8(values.val[1], 4));
+    result.val[1] = vorrq_u8(vshlq_n_u8(values.val[1], 4), vshrq_n_u8(values.val[2], 2));
+    result.val[2] = vorrq_u8(vshlq_n_u8(values.val[2], 6), values.val[3]);
+    vst3q_u8(out, result);
+  }
+  return consumed;
+}
+#endif
+
+/*!
+ * Writes encodedSize(size, alphabet) characters to out and returns that count.
+ */
+inline size_t encode(const uint8_t *in, size_t size, char *out, Base64Alphabet alphabet)
+{
+  char *const out_start = out;
+  size_t i = 0;
+#ifdef JSON_STRUCT_HAS_AVX2
+  i = encodeAVX2(in, size, out, alphabet);
+  out += i / 3 * 4;
+#elif defined(JSON_STRUCT_HAS_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+  i = encodeNEON(in, size, out, alphabet);
+  out += i / 3 * 4;
+#endif
+  const char *chars = base64::alphabet(alphabet);
+  for (; size - i >= 3; i += 3, out += 4)
+  {
+    uint32_t group = uint32_t(in[i]) << 16 | uint32_t(in[i + 1]) << 8 | in[i + 2];
+    out[0] = chars[group >> 18];
+    out[1] = chars[(group >> 12) & 0x3f];
+    out[2] = chars[(group >> 6) & 0x3f];
+    out[3] = chars[group & 0x3f];
+  }
+  if (size - i)
+  {
+    uint32_t group = uint32_t(in[i]) << 16 | (size - i == 2 ? uint32_t(in[i + 1]) << 8 : 0);
+    *out++ = chars[group >> 18];
+    *out++ = chars[(group >> 12) & 0x3f];
+    if (size - i == 2)
+      *out++ = chars[(group >> 6) & 0x3f];
+    else if (alphabet == Base64Alphabet::Standard)
+      *out++ = '=';
+    if (alphabet == Base64Alphabet::Standard)
+      *out++ = '=';
+  }
+  return size_t(out - out_start);
+}
+
+/*!
+ * Decodes size characters of either alphabet to out, which must have room for decodedSize(size) bytes. Padding is
+ * optional. Returns false on characters outside the alphabets, misplaced padding or an impossible length.
+ */
+inline bool decode(const char *in, size_t size, uint8_t *out, size_t *out_size, Base64Alphabet alphabet)
+{
+  if (size && in[size - 1] == '=')
+  {
+    if (size % 4)
+      return false;
+    size -= in[size - 2] == '=' ? 2 : 1;
+  }
+  if (size % 4 == 1)
+    return false;
+
+  uint8_t *const out_start = out;
+  size_t i = 0;
+#ifdef JSON_STRUCT_HAS_AVX2
+  i = decodeAVX2(in, size, out, alphabet);
+  out += i / 4 * 3;
+#elif defined(JSON_STRUCT_HAS_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+  JS_UNUSED(alphabet);
+  i = decodeNEON(in, size, out);
+  out += i / 4 * 3;
+#else
+  JS_UNUSED(alphabet);
+#endif
+  const unsigned char *table = decode_table;
+  for (; size - i >= 4; i += 4, out += 3)
+  {
+    uint32_t a = table[(unsigned char)in[i]];
+    uint32_t b = table[(unsigned char)in[i + 1]];
+    uint32_t c = table[(unsigned char)in[i + 2]];
+    uint32_t d = table[(unsigned char)in[i + 3]];
+    if ((a | b | c | d) & 0x80)
+      return false;
+    uint32_t group = a << 18 | b << 12 | c << 6 | d;
+    out[0] = uint8_t(group >> 16);
+    out[1] = uint8_t(group >> 8);
+    out[2] = uint8_t(group);
+  }
+  if (size - i)
+  {
+    uint32_t a = table[(unsigned char)in[i]];
+    uint32_t b = table[(unsigned char)in[i + 1]];
+    uint32_t c = size - i == 3 ? table[(unsigned char)in[i + 2]] : 0;
+    if ((a | b | c) & 0x80)
+      return false;
+    uint32_t group = a << 18 | b << 12 | c << 6;
+    *out++ = uint8_t(group >> 16);
+    if (size - i == 3)
+      *out++ = uint8_t(group >> 8);
+  }
+  *out_size = size_t(out - out_start);
+  return true;
+}
+} // namespace base64
+} // namespace Internal
+
+/// \private
+template <Base64Alphabet ALPHABET>
+struct TypeHandler<BasicBase64Bytes<ALPHABET>>
+{
+  static inline Error to(BasicBase64Bytes<ALPHABET> &to_type, ParseContext &context)
+  {
+    if (context.token.value_type != Type::String)
+      return Error::IllegalDataValue;
+
+    DataRef value = context.token.value;
+    std::string unescaped;
+    // Some encoders write '/' as "\/".
+    if (memchr(value.data, '\\', value.size))
+    {
+      Internal::handle_json_escapes_in(value, unescaped);
+      value = DataRef(unescaped.data(), unescaped.size());
+    }
+
+    to_type.data.resize(Internal::base64::decodedSize(value.size));
+    size_t size = 0;
+    if (!Internal::base64::decode(value.data, value.size, to_type.data.data(), &size, ALPHABET))
+    {
+      to_type.data.clear();
+      return Error::IllegalDataValue;
+    }
+    to_type.data.resize(size);
+    return Error::NoError;
+  }
+
+  static inline void from(const BasicBase64Bytes<ALPHABET> &from_type, Token &token, Serializer &serializer)
+  {
+    std::string buffer;
+    buffer.resize(Internal::base64::encodedSize(from_type.data.size(), ALPHABET));
+    if (buffer.size())
+      Internal::base64::encode(from_type.data.data(), from_type.data.size(), &buffer[0], ALPHABET);
+    token.value_type = Type::String;
+    token.value = DataRef(buffer.data(), buffer.size());
+    serializer.write(token);
+  }
+};
+
 template <typename T, typename Set>
 struct TypeHandlerSet
 {
@@ -10199,18 +13932,3262 @@ struct TypeHandlerSet
     serializer.write(token);
   }
 };
-} // namespace JS
-#endif // JSON_STRUCT_H
 
-#if defined(JS_STL_MAP) && !defined(JS_STL_MAP_INCLUDE)
-#define JS_STL_MAP_INCLUDE
-#include <map>
-namespace JS
-{
-template <typename Key, typename Value>
-struct TypeHandler<std::map<Key, Value>> : TypeHandlerMap<Key, Value, std::map<Key, Value>>
+/*!
+ * A column of strings where the characters of all rows are stored back to back in one arena.
+ */
+class StringColumn
 {
-};
+public:
+  size_t size() const
+  {
+    return m_ends.size();
+  }
+
+  bool empty() const
+  {
+    return m_ends.empty();
+  }
+
+  DataRef operator[](size_t row) const
+  {
+    size_t start = row ? m_ends[row - 1] : 0;
+    return DataRef(m_arena.data() + start, m_ends[row] - start);
+  }
+
+  std::string str(size_t row) const
+  {
+    DataRef ref = (*this)[row];
+    return std::string(ref.data, ref.size);
+  }
+
+  const std::string &arena() const
+  {
+    return m_arena;
+  }
+
+  void reserve(size_t rows, size_t bytes)
+  {
+    m_ends.reserve(rows);
+    m_arena.reserve(bytes);
+  }
+
+  void clear()
+  {
+    m_ends.clear();
+    m_arena.clear();
+  }
+
+  void push_back(const DataRef &value)
+  {
+    m_arena.append(value.data, value.size);
+    m_ends.push_back(m_arena.size());
+  }
+
+  /// Appends an empty row.
+  void emplace_back()
+  {
+    m_ends.push_back(m_arena.size());
+  }
+
+  /// Replaces the value of the last row with the unescaped JSON string value.
+  void assignLastFromJson(const DataRef &json_value)
+  {
+    m_arena.resize(m_ends.size() > 1 ? m_ends[m_ends.size() - 2] : 0);
+    Internal::handle_json_escapes_in(json_value, m_arena);
+    m_ends.back() = m_arena.size();
+  }
+
+private:
+  std::string m_arena;
+  std::vector<size_t> m_ends;
+};
+
+namespace Internal
+{
+template <typename T>
+struct ColumnTraits
+{
+  using type = std::vector<T>;
+  static Error parseLast(type &column, ParseContext &context)
+  {
+    return TypeHandler<T>::to(column.back(), context);
+  }
+  static void serializeRow(const type &column, size_t row, Token &token, Serializer &serializer)
+  {
+    TypeHandler<T>::from(column[row], token, serializer);
+  }
+};
+
+template <>
+struct ColumnTraits<bool>
+{
+  using type = std::vector<bool>;
+  static Error parseLast(type &column, ParseContext &context)
+  {
+    bool value = false;
+    Error error = TypeHandler<bool>::to(value, context);
+    column.back() = value;
+    return error;
+  }
+  static void serializeRow(const type &column, size_t row, Token &token, Serializer &serializer)
+  {
+    bool value = column[row];
+    TypeHandler<bool>::from(value, token, serializer);
+  }
+};
+
+template <>
+struct ColumnTraits<std::string>
+{
+  using type = StringColumn;
+  static Error parseLast(type &column, ParseContext &context)
+  {
+    column.assignLastFromJson(context.token.value);
+    return Error::NoError;
+  }
+  static void serializeRow(const type &column, size_t row, Token &token, Serializer &serializer)
+  {
+    TypeHandler<std::string>::from(column.str(row), token, serializer);
+  }
+};
+
+template <typename Members>
+struct ColumnStorage;
+
+template <typename... MIs>
+struct ColumnStorage<Tuple<MIs...>>
+{
+  using type = Tuple<typename ColumnTraits<typename MIs::type>::type...>;
+};
+
+template <typename T, typename Members, typename Storage, size_t INDEX>
+struct ColumnMembers
+{
+  using MemberInfo = typename TypeAt<INDEX, Members>::type;
+  using NameTuple = decltype(MemberInfo::names);
+  using Traits = ColumnTraits<typename MemberInfo::type>;
+
+  static Error unpack(Storage &storage, const Members &members, ParseContext &context, bool primary,
+                      bool *assigned_members)
+  {
+    const NameTuple &names = members.template get<INDEX>().names;
+    bool match = primary ? compareDataRefWithStringLiteral(names.template get<0>(), context.token.name)
+                         : NameChecker<NameTuple, NameTuple::size>::compare(names, context.token.name);
+    if (match)
+    {
+      assigned_members[INDEX] = true;
+      return matchedMemberResult(Traits::parseLast(storage.template get<INDEX>(), context));
+    }
+    return ColumnMembers<T, Members, Storage, INDEX - 1>::unpack(storage, members, context, primary, assigned_members);
+  }
+
+  static void appendRow(Storage &storage)
+  {
+    storage.template get<INDEX>().emplace_back();
+    ColumnMembers<T, Members, Storage, INDEX - 1>::appendRow(storage);
+  }
+
+  static void clear(Storage &storage)
+  {
+    storage.template get<INDEX>().clear();
+    ColumnMembers<T, Members, Storage, INDEX - 1>::clear(storage);
+  }
+
+  static void serializeRow(const Storage &storage, const Members &members, size_t row, Token &token,
+                           Serializer &serializer)
+  {
+    ColumnMembers<T, Members, Storage, INDEX - 1>::serializeRow(storage, members, row, token, serializer);
+    token.name.data = members.template get<INDEX>().names.template get<0>().data;
+    token.name.size = members.template get<INDEX>().names.template get<0>().size;
+    token.name_type = Type::Ascii;
+    Traits::serializeRow(storage.template get<INDEX>(), row, token, serializer);
+  }
+
+  template <typename M>
+  static typename ColumnTraits<M>::type *find(Storage &storage, const Members &members, M T::*member)
+  {
+    typename ColumnTraits<M>::type *found =
+      findThis(storage, members, member, std::is_same<M, typename MemberInfo::type>());
+    if (found)
+      return found;
+    return ColumnMembers<T, Members, Storage, INDEX - 1>::find(storage, members, member);
+  }
+
+private:
+  template <typename M>
+  static typename ColumnTraits<M>::type *findThis(Storage &storage, const Members &members, M T::*member,
+                                                  std::true_type)
+  {
+    return members.template get<INDEX>().member == member ? &storage.template get<INDEX>() : nullptr;
+  }
+
+  template <typename M>
+  static typename ColumnTraits<M>::type *findThis(Storage &, const Members &, M T::*, std::false_type)
+  {
+    return nullptr;
+  }
+
+};
+
+template <typename T, typename Members, typename Storage>
+struct ColumnMembers<T, Members, Storage, size_t(-1)>
+{
+  static Error unpack(Storage &, const Members &, ParseContext &, bool, bool *)
+  {
+    return Error::MissingPropertyMember;
+  }
+  static void appendRow(Storage &)
+  {
+  }
+  static void clear(Storage &)
+  {
+  }
+  static void serializeRow(const Storage &, const Members &, size_t, Token &, Serializer &)
+  {
+  }
+  template <typename M>
+  static typename ColumnTraits<M>::type *find(Storage &, const Members &, M T::*)
+  {
+    return nullptr;
+  }
+};
+} // namespace Internal
+
+/*!
+ * Struct-of-arrays storage for an array of JS_OBJ records. Every member of T gets one
+ * contiguous column: std::vector<M> for a member of type M, and StringColumn for
+ * std::string members. Members missing in a JSON object get a default constructed value,
+ * so all columns always have rows() entries.
+ *
+ * Columns<T> has a TypeHandler, so it can be parsed with ParseContext::parseTo, used as a member
+ * of another struct, and serialized back to an array of objects.
+ */
+template <typename T>
+class Columns
+{
+public:
+  using Members = decltype(Internal::JsonStructBaseDummy<T, T>::js_static_meta_data_info());
+  using Storage = typename Internal::ColumnStorage<typename std::remove_const<Members>::type>::type;
+  using SuperMeta = decltype(Internal::JsonStructBaseDummy<T, T>::js_static_meta_super_info());
+  static_assert(SuperMeta::size == 0, "JS::Columns does not support members inherited through JS_SUPER_CLASSES");
+
+  size_t rows() const
+  {
+    return m_rows;
+  }
+
+  template <size_t INDEX>
+  typename TypeAt<INDEX, Storage>::type &get()
+  {
+    return storage.template get<INDEX>();
+  }
+
+  template <size_t INDEX>
+  const typename TypeAt<INDEX, Storage>::type &get() const
+  {
+    return storage.template get<INDEX>();
+  }
+
+  template <typename M>
+  typename Internal::ColumnTraits<M>::type &column(M T::*member)
+  {
+    auto members = Internal::JsonStructBaseDummy<T, T>::js_static_meta_data_info();
+    auto *found = Internal::ColumnMembers<T, Members, Storage, Members::size - 1>::find(storage, members, member);
+    assert(found && "Member pointer is not registered in the JS_OBJ of T");
+    return *found;
+  }
+
+  template <typename M>
+  const typename Internal::ColumnTraits<M>::type &column(M T::*member) const
+  {
+    return const_cast<Columns *>(this)->column(member);
+  }
+
+  void clear()
+  {
+    Internal::ColumnMembers<T, Members, Storage, Members::size - 1>::clear(storage);
+    m_rows = 0;
+  }
+
+  void appendRow()
+  {
+    Internal::ColumnMembers<T, Members, Storage, Members::size - 1>::appendRow(storage);
+    m_rows++;
+  }
+
+  Storage storage;
+
+private:
+  size_t m_rows = 0;
+};
+
+template <typename T>
+struct TypeHandler<Columns<T>>
+{
+  using Members = typename Columns<T>::Members;
+  using Storage = typename Columns<T>::Storage;
+  using Checker = Internal::ColumnMembers<T, Members, Storage, Members::size - 1>;
+
+  static inline Error to(Columns<T> &to_type, ParseContext &context)
+  {
+    if (context.token.value_type != Type::ArrayStart)
+      return Error::ExpectedArrayStart;
+    to_type.clear();
+    auto members = Internal::JsonStructBaseDummy<T, T>::js_static_meta_data_info();
+    bool assigned_members[Members::size];
+    std::vector<std::string> unassigned_required_members;
+
+    context.nextToken();
+    while (context.error == Error::NoError && context.token.value_type != Type::ArrayEnd)
+    {
+      if (context.token.value_type != Type::ObjectStart)
+        return Error::ExpectedObjectStart;
+      to_type.appendRow();
+      memset(assigned_members, 0, sizeof(assigned_members));
+      context.nextToken();
+      while (context.error == Error::NoError && context.token.value_type != Type::ObjectEnd)
+      {
+        DataRef token_name = context.token.name;
+        Error error = Checker::unpack(to_type.storage, members, context, true, assigned_members);
+        if (error == Error::MissingPropertyMember)
+          error = Checker::unpack(to_type.storage, members, context, false, assigned_members);
+        if (error == Error::MissingPropertyMember)
+        {
+          if (context.track_member_assignement_state)
+            context.missing_members.emplace_back(token_name.data, token_name.data + token_name.size);
+          if (!context.allow_missing_members)
+            return error;
+          Internal::skipArrayOrObject(context);
+        }
+        else if (error != Error::NoError)
+        {
+          return error;
+        }
+        if (context.error == Error::NoError)
+          context.nextToken();
+      }
+      if (context.error != Error::NoError)
+        return context.error;
+
+      unassigned_required_members.clear();
+      Error error = Internal::MemberChecker<T, Members, 0, Members::size - 1>::verifyMembers(
+        members, assigned_members, context.track_member_assignement_state, unassigned_required_members, "");
+      if (error == Error::UnassignedRequiredMember)
+      {
+        if (context.track_member_assignement_state)
+          context.unassigned_required_members.insert(context.unassigned_required_members.end(),
+                                                     unassigned_required_members.begin(),
+                                                     unassigned_required_members.end());
+        if (!context.allow_unasigned_required_members)
+          return error;
+      }
+      context.nextToken();
+    }
+    return context.error;
+  }
+
+  static inline void from(const Columns<T> &from_type, Token &token, Serializer &serializer)
+  {
+    token.value_type = Type::ArrayStart;
+    token.value = DataRef("[");
+    serializer.write(token);
+
+    auto members = Internal::JsonStructBaseDummy<T, T>::js_static_meta_data_info();
+    for (size_t row = 0; row < from_type.rows(); row++)
+    {
+      token.name = DataRef("");
+      token.value_type = Type::ObjectStart;
+      token.value = DataRef("{");
+      serializer.write(token);
+      Checker::serializeRow(from_type.storage, members, row, token, serializer);
+      token.name = DataRef("");
+      token.name_type = Type::String;
+      token.value_type = Type::ObjectEnd;
+      token.value = DataRef("}");
+      serializer.write(token);
+    }
+
+    token.name = DataRef("");
+    token.value_type = Type::ArrayEnd;
+    token.value = DataRef("]");
+    serializer.write(token);
+  }
+};
+
+/*!
+ * Parses a JSON array of objects straight into columns, see JS::Columns.
+ */
+template <typename T>
+JS_NODISCARD inline Error parseColumns(ParseContext &context, Columns<T> &columns)
+{
+  return context.parseTo(columns);
+}
+
+template <typename T>
+JS_NODISCARD inline Error parseColumns(const char *data, size_t size, Columns<T> &columns)
+{
+  ParseContext context(data, size);
+  return context.parseTo(columns);
+}
+
+/*!
+ * How the binary formats write the keys of JS_OBJ members. Names writes the member name like JSON does. Indices writes
+ * the position of the member instead, counting the members of the type itself first and then the members of its super
+ * classes. That is smaller and faster to read, but ties the data to the member order of the struct.
+ */
+enum class KeyStyle : unsigned char
+{
+  Names,
+  Indices
+};
+
+namespace Internal
+{
+class BinarySchema;
+}
+
+/*!
+ * The binary counterpart of TypeHandler, used by the MessagePack, CBOR and binary snapshot functions. The primary
+ * template handles JS_OBJ and JS_OBJECT_EXTERNAL types from the same meta data as the JSON parser and serializer, so
+ * one set of annotations covers both. Numbers are written as native binary values, and enums as their underlying
+ * integer. Integers are limited to 64 bits, so the JS_INT_128 types are rejected at compile time. BasicBase64Bytes is
+ * written as a binary blob, and sets as arrays. InternedString can be written, but reading it fails with
+ * IllegalDataValue since there is no InternPool to read it into.
+ *
+ * Other types get a specialization with the functions below. The Writer and Reader are the classes of the format in
+ * JS::Internal, like MsgpackWriter and MsgpackReader, which have one function for each kind of value. schema()
+ * describes the layout of the type for binarySchemaHash, and is only needed by saveBinary and loadBinary.
+ */
+template <typename T, typename Enable = void>
+struct BinaryHandler
+{
+  template <typename Writer>
+  static inline void write(const T &from_type, Writer &writer);
+  template <typename Reader>
+  static inline Error read(T &to_type, Reader &reader);
+  static inline void schema(Internal::BinarySchema &schema);
+};
+
+namespace Internal
+{
+/*!
+ * \private
+ * Output buffer of the binary writers. It grows the string it writes to, and finish() trims it to the written size.
+ */
+class BinaryBuffer
+{
+public:
+  explicit BinaryBuffer(std::string &out)
+    : m_out(out)
+    , m_used(0)
+  {
+    m_out.resize(std::max(m_out.capacity(), size_t(64)));
+  }
+
+  char *grow(size_t size)
+  {
+    if (JSON_STRUCT_UNLIKELY(m_out.size() - m_used < size))
+      m_out.resize(std::max(m_out.size() * 2, m_used + size));
+    char *ret = &m_out[m_used];
+    m_used += size;
+    return ret;
+  }
+
+  void append(const char *data, size_t size)
+  {
+    if (size)
+      memcpy(grow(size), data, size);
+  }
+
+  size_t size() const
+  {
+    return m_used;
+  }
+
+  char *data()
+  {
+    return &m_out[0];
+  }
+
+  void finish()
+  {
+    m_out.resize(m_used);
+  }
+
+private:
+  std::string &m_out;
+  size_t m_used;
+};
+
+template <size_t SIZE>
+static inline void storeBigEndian(char *out, uint64_t value)
+{
+  for (size_t i = 0; i < SIZE; i++)
+    out[i] = char(uint8_t(value >> (8 * (SIZE - 1 - i))));
+}
+
+template <size_t SIZE>
+static inline uint64_t loadBigEndian(const char *data)
+{
+  uint64_t value = 0;
+  for (size_t i = 0; i < SIZE; i++)
+    value = (value << 8) | uint8_t(data[i]);
+  return value;
+}
+
+template <size_t SIZE>
+static inline void storeLittleEndian(char *out, uint64_t value)
+{
+  for (size_t i = 0; i < SIZE; i++)
+    out[i] = char(uint8_t(value >> (8 * i)));
+}
+
+template <size_t SIZE>
+static inline uint64_t loadLittleEndian(const char *data)
+{
+  uint64_t value = 0;
+  for (size_t i = 0; i < SIZE; i++)
+    value |= uint64_t(uint8_t(data[i])) << (8 * i);
+  return value;
+}
+
+template <typename I>
+static inline bool isNegativeInteger(I value, std::true_type)
+{
+  return value < 0;
+}
+
+template <typename I>
+static inline bool isNegativeInteger(I, std::false_type)
+{
+  return false;
+}
+
+// Assigns a decoded integer to to_type when it is in range for I.
+template <typename I>
+static inline bool assignBinaryInteger(uint64_t value, bool negative, I &to_type)
+{
+  if (negative)
+  {
+    if (!std::is_signed<I>::value || int64_t(value) < int64_t(std::numeric_limits<I>::min()))
+      return false;
+  }
+  else if (value > uint64_t(std::numeric_limits<I>::max()))
+  {
+    return false;
+  }
+  to_type = I(value);
+  return true;
+}
+
+/*!
+ * \private
+ * Builds the schema hash of binarySchemaHash, a 64 bit FNV-1a hash of the description the BinaryHandler schema
+ * functions give of a type. Objects that are already being described further up, like the element type of a tree,
+ * are added as a reference to that level instead of being described again.
+ */
+class BinarySchema
+{
+public:
+  BinarySchema()
+    : m_hash(14695981039346656037ull)
+  {
+  }
+
+  void add(const char *data, size_t size)
+  {
+    addNumber(size);
+    for (size_t i = 0; i < size; i++)
+      addByte(uint8_t(data[i]));
+  }
+
+  void add(const char *str)
+  {
+    add(str, strlen(str));
+  }
+
+  void addNumber(uint64_t value)
+  {
+    for (size_t i = 0; i < 8; i++)
+      addByte(uint8_t(value >> (8 * i)));
+  }
+
+  // Returns false when the object is already open, the caller should then not describe it again
+  bool beginObject(const void *type)
+  {
+    for (size_t i = 0; i < m_open.size(); i++)
+    {
+      if (m_open[i] == type)
+      {
+        add("reference");
+        addNumber(m_open.size() - i);
+        return false;
+      }
+    }
+    m_open.push_back(type);
+    return true;
+  }
+
+  void endObject()
+  {
+    m_open.pop_back();
+  }
+
+  uint64_t hash() const
+  {
+    return m_hash;
+  }
+
+private:
+  void addByte(uint8_t byte)
+  {
+    m_hash = (m_hash ^ byte) * 1099511628211ull;
+  }
+
+  uint64_t m_hash;
+  std::vector<const void *> m_open;
+};
+
+// An address that is unique for each type, used to find recursive types in BinarySchema
+template <typename T>
+static inline const void *binaryTypeId()
+{
+  static const char id = 0;
+  return &id;
+}
+
+/*!
+ * \private
+ * A member key read by a binary Reader, either a name or a member index.
+ */
+struct BinaryKey
+{
+  BinaryKey()
+    : name()
+    , index(0)
+    , is_index(false)
+  {
+  }
+  DataRef name;
+  size_t index;
+  bool is_index;
+};
+
+template <typename T>
+struct BinaryObject;
+
+template <typename T, typename Members, size_t INDEX>
+struct BinaryMembers
+{
+  template <typename Writer>
+  static void write(const T &from_type, const Members &members, size_t index, Writer &writer)
+  {
+    auto &member = members.template get<Members::size - INDEX>();
+    typedef typename std::remove_reference<decltype(member)>::type::type MemberType;
+    auto &name = member.names.template get<0>();
+    writer.writeMemberKey(name.data, size_t(name.size), index);
+    BinaryHandler<MemberType>::write(from_type.*member.member, writer);
+    BinaryMembers<T, Members, INDEX - 1>::write(from_type, members, index + 1, writer);
+  }
+
+  template <typename Reader>
+  static Error readAll(T &to_type, const Members &members, Reader &reader)
+  {
+    auto &member = members.template get<Members::size - INDEX>();
+    typedef typename std::remove_reference<decltype(member)>::type::type MemberType;
+    Error error = BinaryHandler<MemberType>::read(to_type.*member.member, reader);
+    if (error != Error::NoError)
+      return error;
+    return BinaryMembers<T, Members, INDEX - 1>::readAll(to_type, members, reader);
+  }
+
+  template <typename Reader>
+  static Error read(T &to_type, const Members &members, size_t index, const BinaryKey &key, Reader &reader,
+                    bool &found)
+  {
+    auto &member = members.template get<Members::size - INDEX>();
+    typedef typename std::remove_reference<decltype(member)>::type::type MemberType;
+    typedef decltype(member.names) Names;
+    if (key.is_index ? key.index == index
+                     : compareDataRefWithStringLiteral(member.names.template get<0>(), key.name) ||
+                         NameChecker<Names, Names::size>::compare(member.names, key.name))
+    {
+      found = true;
+      return BinaryHandler<MemberType>::read(to_type.*member.member, reader);
+    }
+    return BinaryMembers<T, Members, INDEX - 1>::read(to_type, members, index + 1, key, reader, found);
+  }
+
+  static void schema(const Members &members, BinarySchema &schema)
+  {
+    auto &member = members.template get<Members::size - INDEX>();
+    typedef typename std::remove_reference<decltype(member)>::type::type MemberType;
+    auto &name = member.names.template get<0>();
+    schema.add(name.data, size_t(name.size));
+    BinaryHandler<MemberType>::schema(schema);
+    BinaryMembers<T, Members, INDEX - 1>::schema(members, schema);
+  }
+};
+
+template <typename T, typename Members>
+struct BinaryMembers<T, Members, 0>
+{
+  template <typename Writer>
+  static void write(const T &from_type, const Members &members, size_t index, Writer &writer)
+  {
+    JS_UNUSED(from_type);
+    JS_UNUSED(members);
+    JS_UNUSED(index);
+    JS_UNUSED(writer);
+  }
+
+  template <typename Reader>
+  static Error readAll(T &to_type, const Members &members, Reader &reader)
+  {
+    JS_UNUSED(to_type);
+    JS_UNUSED(members);
+    JS_UNUSED(reader);
+    return Error::NoError;
+  }
+
+  template <typename Reader>
+  static Error read(T &to_type, const Members &members, size_t index, const BinaryKey &key, Reader &reader,
+                    bool &found)
+  {
+    JS_UNUSED(to_type);
+    JS_UNUSED(members);
+    JS_UNUSED(index);
+    JS_UNUSED(key);
+    JS_UNUSED(reader);
+    JS_UNUSED(found);
+    return Error::NoError;
+  }
+
+  static void schema(const Members &members, BinarySchema &schema)
+  {
+    JS_UNUSED(members);
+    JS_UNUSED(schema);
+  }
+};
+
+template <typename T, typename Supers, size_t INDEX>
+struct BinarySupers
+{
+  typedef typename TypeAt<Supers::size - INDEX, Supers>::type::type Super;
+  static const size_t member_count =
+    BinaryObject<Super>::member_count + BinarySupers<T, Supers, INDEX - 1>::member_count;
+
+  template <typename Writer>
+  static void write(const T &from_type, size_t index, Writer &writer)
+  {
+    BinaryObject<Super>::writeMembers(from_type, index, writer);
+    BinarySupers<T, Supers, INDEX - 1>::write(from_type, index + BinaryObject<Super>::member_count, writer);
+  }
+
+  template <typename Reader>
+  static Error readAll(T &to_type, Reader &reader)
+  {
+    Error error = BinaryObject<Super>::readAll(to_type, reader);
+    if (error != Error::NoError)
+      return error;
+    return BinarySupers<T, Supers, INDEX - 1>::readAll(to_type, reader);
+  }
+
+  template <typename Reader>
+  static Error read(T &to_type, size_t index, const BinaryKey &key, Reader &reader, bool &found)
+  {
+    Error error = BinaryObject<Super>::read(to_type, index, key, reader, found);
+    if (found || error != Error::NoError)
+      return error;
+    return BinarySupers<T, Supers, INDEX - 1>::read(to_type, index + BinaryObject<Super>::member_count, key, reader,
+                                                    found);
+  }
+
+  static void schema(BinarySchema &schema)
+  {
+    BinaryObject<Super>::schema(schema);
+    BinarySupers<T, Supers, INDEX - 1>::schema(schema);
+  }
+};
+
+template <typename T, typename Supers>
+struct BinarySupers<T, Supers, 0>
+{
+  static const size_t member_count = 0;
+
+  template <typename Writer>
+  static void write(const T &from_type, size_t index, Writer &writer)
+  {
+    JS_UNUSED(from_type);
+    JS_UNUSED(index);
+    JS_UNUSED(writer);
+  }
+
+  template <typename Reader>
+  static Error readAll(T &to_type, Reader &reader)
+  {
+    JS_UNUSED(to_type);
+    JS_UNUSED(reader);
+    return Error::NoError;
+  }
+
+  template <typename Reader>
+  static Error read(T &to_type, size_t index, const BinaryKey &key, Reader &reader, bool &found)
+  {
+    JS_UNUSED(to_type);
+    JS_UNUSED(index);
+    JS_UNUSED(key);
+    JS_UNUSED(reader);
+    JS_UNUSED(found);
+    return Error::NoError;
+  }
+
+  static void schema(BinarySchema &schema)
+  {
+    JS_UNUSED(schema);
+  }
+};
+
+// Walks the members of a JS_OBJ type, and then the members of its super classes, in the order they are indexed.
+template <typename T>
+struct BinaryObject
+{
+  typedef decltype(JsonStructBaseDummy<T, T>::js_static_meta_data_info()) Members;
+  typedef decltype(JsonStructBaseDummy<T, T>::js_static_meta_super_info()) Supers;
+  static const size_t member_count = Members::size + BinarySupers<T, Supers, Supers::size>::member_count;
+
+  template <typename Writer>
+  static void writeMembers(const T &from_type, size_t index, Writer &writer)
+  {
+    BinaryMembers<T, Members, Members::size>::write(from_type, JsonStructBaseDummy<T, T>::js_static_meta_data_info(),
+                                                    index, writer);
+    BinarySupers<T, Supers, Supers::size>::write(from_type, index + Members::size, writer);
+  }
+
+  template <typename Reader>
+  static Error readAll(T &to_type, Reader &reader)
+  {
+    Error error =
+      BinaryMembers<T, Members, Members::size>::readAll(to_type, JsonStructBaseDummy<T, T>::js_static_meta_data_info(),
+                                                        reader);
+    if (error != Error::NoError)
+      return error;
+    return BinarySupers<T, Supers, Supers::size>::readAll(to_type, reader);
+  }
+
+  template <typename Reader>
+  static Error read(T &to_type, size_t index, const BinaryKey &key, Reader &reader, bool &found)
+  {
+    Error error = BinaryMembers<T, Members, Members::size>::read(
+      to_type, JsonStructBaseDummy<T, T>::js_static_meta_data_info(), index, key, reader, found);
+    if (found || error != Error::NoError)
+      return error;
+    return BinarySupers<T, Supers, Supers::size>::read(to_type, index + Members::size, key, reader, found);
+  }
+
+  static void schema(BinarySchema &schema)
+  {
+    BinaryMembers<T, Members, Members::size>::schema(JsonStructBaseDummy<T, T>::js_static_meta_data_info(), schema);
+    BinarySupers<T, Supers, Supers::size>::schema(schema);
+  }
+};
+} // namespace Internal
+
+template <typename T, typename Enable>
+template <typename Writer>
+inline void BinaryHandler<T, Enable>::write(const T &from_type, Writer &writer)
+{
+  static_assert(Internal::IsJsonObject<T>::value, "Missing JS_OBJ, JS_OBJECT_EXTERNAL or BinaryHandler specialisation");
+  writer.beginObject(Internal::BinaryObject<T>::member_count);
+  Internal::BinaryObject<T>::writeMembers(from_type, 0, writer);
+  writer.endObject();
+}
+
+template <typename T, typename Enable>
+template <typename Reader>
+inline Error BinaryHandler<T, Enable>::read(T &to_type, Reader &reader)
+{
+  static_assert(Internal::IsJsonObject<T>::value, "Missing JS_OBJ, JS_OBJECT_EXTERNAL or BinaryHandler specialisation");
+  size_t size;
+  Error error = reader.beginObject(Internal::BinaryObject<T>::member_count, size);
+  if (error != Error::NoError)
+    return error;
+  if (reader.positional())
+    return Internal::BinaryObject<T>::readAll(to_type, reader);
+  // Members that are not in the data keep their value, and unknown members are skipped
+  Internal::BinaryKey key;
+  while (reader.next(size))
+  {
+    error = reader.readMemberKey(key);
+    if (error != Error::NoError)
+      return error;
+    bool found = false;
+    error = Internal::BinaryObject<T>::read(to_type, 0, key, reader, found);
+    if (error == Error::NoError && !found)
+      error = reader.skip();
+    if (error != Error::NoError)
+      return error;
+  }
+  return Error::NoError;
+}
+
+template <typename T, typename Enable>
+inline void BinaryHandler<T, Enable>::schema(Internal::BinarySchema &schema)
+{
+  static_assert(Internal::IsJsonObject<T>::value, "Missing JS_OBJ, JS_OBJECT_EXTERNAL or BinaryHandler specialisation");
+  if (!schema.beginObject(Internal::binaryTypeId<T>()))
+    return;
+  schema.add("object");
+  schema.addNumber(Internal::BinaryObject<T>::member_count);
+  Internal::BinaryObject<T>::schema(schema);
+  schema.endObject();
+}
+
+/// \private
+template <>
+struct BinaryHandler<bool>
+{
+  template <typename Writer>
+  static inline void write(bool from_type, Writer &writer)
+  {
+    writer.writeBool(from_type);
+  }
+  template <typename Reader>
+  static inline Error read(bool &to_type, Reader &reader)
+  {
+    return reader.readBool(to_type);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("bool");
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+{
+  // gnu++ modes report __int128 as integral, but the binary writers only carry 64 bits
+  static_assert(sizeof(T) <= sizeof(uint64_t), "128 bit integers are not supported by the binary formats");
+  template <typename Writer>
+  static inline void write(T from_type, Writer &writer)
+  {
+    writer.writeInteger(from_type);
+  }
+  template <typename Reader>
+  static inline Error read(T &to_type, Reader &reader)
+  {
+    return reader.readInteger(to_type);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add(std::is_signed<T>::value ? "int" : "uint");
+    schema.addNumber(sizeof(T));
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+  typedef typename std::underlying_type<T>::type Underlying;
+  template <typename Writer>
+  static inline void write(T from_type, Writer &writer)
+  {
+    writer.writeInteger(Underlying(from_type));
+  }
+  template <typename Reader>
+  static inline Error read(T &to_type, Reader &reader)
+  {
+    Underlying value;
+    Error error = reader.readInteger(value);
+    if (error == Error::NoError)
+      to_type = T(value);
+    return error;
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    BinaryHandler<Underlying>::schema(schema);
+  }
+};
+
+/// \private
+template <>
+struct BinaryHandler<float>
+{
+  template <typename Writer>
+  static inline void write(float from_type, Writer &writer)
+  {
+    writer.writeFloat(from_type);
+  }
+  template <typename Reader>
+  static inline Error read(float &to_type, Reader &reader)
+  {
+    return reader.readFloat(to_type);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("float");
+  }
+};
+
+/// \private
+template <>
+struct BinaryHandler<double>
+{
+  template <typename Writer>
+  static inline void write(double from_type, Writer &writer)
+  {
+    writer.writeFloat(from_type);
+  }
+  template <typename Reader>
+  static inline Error read(double &to_type, Reader &reader)
+  {
+    return reader.readFloat(to_type);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("double");
+  }
+};
+
+/// \private
+template <>
+struct BinaryHandler<std::string>
+{
+  template <typename Writer>
+  static inline void write(const std::string &from_type, Writer &writer)
+  {
+    writer.writeString(from_type.data(), from_type.size());
+  }
+  template <typename Reader>
+  static inline Error read(std::string &to_type, Reader &reader)
+  {
+    return reader.readString(to_type);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("string");
+  }
+};
+
+/// \private
+template <size_t INLINE_CAPACITY>
+struct BinaryHandler<BasicCompactString<INLINE_CAPACITY>>
+{
+  template <typename Writer>
+  static inline void write(const BasicCompactString<INLINE_CAPACITY> &from_type, Writer &writer)
+  {
+    writer.writeString(from_type.data(), from_type.size());
+  }
+  template <typename Reader>
+  static inline Error read(BasicCompactString<INLINE_CAPACITY> &to_type, Reader &reader)
+  {
+    std::string str;
+    Error error = reader.readString(str);
+    if (error == Error::NoError)
+      to_type.assign(str.data(), str.size());
+    return error;
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("string");
+  }
+};
+
+/// \private
+template <>
+struct BinaryHandler<InternedString>
+{
+  template <typename Writer>
+  static inline void write(const InternedString &from_type, Writer &writer)
+  {
+    writer.writeString(from_type.data(), from_type.size());
+  }
+  // The binary readers have no ParseContext, so there is no pool to intern into
+  template <typename Reader>
+  static inline Error read(InternedString &to_type, Reader &reader)
+  {
+    JS_UNUSED(to_type);
+    JS_UNUSED(reader);
+    return Error::IllegalDataValue;
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("string");
+  }
+};
+
+/// \private
+template <Base64Alphabet ALPHABET>
+struct BinaryHandler<BasicBase64Bytes<ALPHABET>>
+{
+  template <typename Writer>
+  static inline void write(const BasicBase64Bytes<ALPHABET> &from_type, Writer &writer)
+  {
+    writer.writeBytes(reinterpret_cast<const char *>(from_type.data.data()), from_type.data.size());
+  }
+  template <typename Reader>
+  static inline Error read(BasicBase64Bytes<ALPHABET> &to_type, Reader &reader)
+  {
+    return reader.readBytes(to_type.data);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("bytes");
+  }
+};
+
+namespace Internal
+{
+template <typename Map>
+struct BinaryMap
+{
+  typedef typename Map::key_type Key;
+  typedef typename Map::mapped_type Value;
+
+  template <typename Writer>
+  static void write(const Map &from_type, Writer &writer)
+  {
+    writer.beginMap(from_type.size());
+    for (const auto &pair : from_type)
+    {
+      BinaryHandler<Key>::write(pair.first, writer);
+      BinaryHandler<Value>::write(pair.second, writer);
+    }
+    writer.endMap();
+  }
+
+  template <typename Reader>
+  static Error read(Map &to_type, Reader &reader)
+  {
+    to_type.clear();
+    size_t size;
+    Error error = reader.beginMap(size);
+    if (error != Error::NoError)
+      return error;
+    while (reader.next(size))
+    {
+      Key key = Key();
+      error = BinaryHandler<Key>::read(key, reader);
+      if (error != Error::NoError)
+        return error;
+      error = BinaryHandler<Value>::read(to_type[std::move(key)], reader);
+      if (error != Error::NoError)
+        return error;
+    }
+    return Error::NoError;
+  }
+
+  static void schema(BinarySchema &schema)
+  {
+    schema.add("map");
+    BinaryHandler<Key>::schema(schema);
+    BinaryHandler<Value>::schema(schema);
+  }
+};
+
+// Sets are written as arrays, so they have the same layout as a std::vector of the key.
+template <typename Set>
+struct BinarySet
+{
+  typedef typename Set::key_type Key;
+
+  template <typename Writer>
+  static void write(const Set &from_type, Writer &writer)
+  {
+    writer.beginArray(from_type.size());
+    for (const auto &key : from_type)
+      BinaryHandler<Key>::write(key, writer);
+    writer.endArray();
+  }
+
+  template <typename Reader>
+  static Error read(Set &to_type, Reader &reader)
+  {
+    to_type.clear();
+    size_t size;
+    Error error = reader.beginArray(size);
+    if (error != Error::NoError)
+      return error;
+    while (reader.next(size))
+    {
+      Key key = Key();
+      error = BinaryHandler<Key>::read(key, reader);
+      if (error != Error::NoError)
+        return error;
+      to_type.insert(std::move(key));
+    }
+    return Error::NoError;
+  }
+
+  static void schema(BinarySchema &schema)
+  {
+    schema.add("array");
+    BinaryHandler<Key>::schema(schema);
+  }
+};
+
+// Reads at most N elements into an array type, elements that are not in the data keep their value.
+template <typename T, size_t N, typename Array, typename Reader>
+static Error readBinaryArray(Array &to_type, Reader &reader)
+{
+  size_t size;
+  Error error = reader.beginArray(size);
+  if (error != Error::NoError)
+    return error;
+  size_t i = 0;
+  while (reader.next(size))
+  {
+    if (i == N)
+      return Error::ExpectedArrayEnd;
+    error = BinaryHandler<T>::read(to_type[i++], reader);
+    if (error != Error::NoError)
+      return error;
+  }
+  return Error::NoError;
+}
+} // namespace Internal
+
+/// \private
+template <typename T, typename A>
+struct BinaryHandler<std::vector<T, A>>
+{
+  template <typename Writer>
+  static inline void write(const std::vector<T, A> &from_type, Writer &writer)
+  {
+    writer.beginArray(from_type.size());
+    for (const auto &value : from_type)
+      BinaryHandler<T>::write(value, writer);
+    writer.endArray();
+  }
+  template <typename Reader>
+  static inline Error read(std::vector<T, A> &to_type, Reader &reader)
+  {
+    to_type.clear();
+    size_t size;
+    Error error = reader.beginArray(size);
+    if (error != Error::NoError)
+      return error;
+    // The size comes from the data, so it is only reserved when the data can hold it. This also leaves out
+    // indefinite lengths, which have no size up front
+    if (size <= reader.remaining())
+      to_type.reserve(size);
+    while (reader.next(size))
+    {
+      T value = T();
+      error = BinaryHandler<T>::read(value, reader);
+      if (error != Error::NoError)
+        return error;
+      to_type.push_back(std::move(value));
+    }
+    return Error::NoError;
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("array");
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+/// \private
+template <typename T, size_t N>
+struct BinaryHandler<T[N]>
+{
+  template <typename Writer>
+  static inline void write(const T (&from_type)[N], Writer &writer)
+  {
+    writer.beginArray(N);
+    for (const T &value : from_type)
+      BinaryHandler<T>::write(value, writer);
+    writer.endArray();
+  }
+  template <typename Reader>
+  static inline Error read(T (&to_type)[N], Reader &reader)
+  {
+    return Internal::readBinaryArray<T, N>(to_type, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("array");
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<Optional<T>>
+{
+  template <typename Writer>
+  static inline void write(const Optional<T> &from_type, Writer &writer)
+  {
+    BinaryHandler<T>::write(from_type.data, writer);
+  }
+  template <typename Reader>
+  static inline Error read(Optional<T> &to_type, Reader &reader)
+  {
+    return BinaryHandler<T>::read(to_type.data, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<OptionalChecked<T>>
+{
+  template <typename Writer>
+  static inline void write(const OptionalChecked<T> &from_type, Writer &writer)
+  {
+    writer.writeNull(!from_type.assigned);
+    if (from_type.assigned)
+      BinaryHandler<T>::write(from_type.data, writer);
+  }
+  template <typename Reader>
+  static inline Error read(OptionalChecked<T> &to_type, Reader &reader)
+  {
+    bool null;
+    Error error = reader.readNull(null);
+    if (error != Error::NoError)
+      return error;
+    to_type.assigned = !null;
+    if (null)
+      return Error::NoError;
+    return BinaryHandler<T>::read(to_type.data, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("nullable");
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<Nullable<T>>
+{
+  template <typename Writer>
+  static inline void write(const Nullable<T> &from_type, Writer &writer)
+  {
+    writer.writeNull(false);
+    BinaryHandler<T>::write(from_type.data, writer);
+  }
+  template <typename Reader>
+  static inline Error read(Nullable<T> &to_type, Reader &reader)
+  {
+    bool null;
+    Error error = reader.readNull(null);
+    if (error != Error::NoError || null)
+      return error;
+    return BinaryHandler<T>::read(to_type.data, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("nullable");
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<NullableChecked<T>>
+{
+  template <typename Writer>
+  static inline void write(const NullableChecked<T> &from_type, Writer &writer)
+  {
+    writer.writeNull(from_type.null);
+    if (!from_type.null)
+      BinaryHandler<T>::write(from_type.data, writer);
+  }
+  template <typename Reader>
+  static inline Error read(NullableChecked<T> &to_type, Reader &reader)
+  {
+    bool null;
+    Error error = reader.readNull(null);
+    if (error != Error::NoError)
+      return error;
+    to_type.null = null;
+    if (null)
+      return Error::NoError;
+    return BinaryHandler<T>::read(to_type.data, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("nullable");
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<Tracked<T>>
+{
+  template <typename Writer>
+  static inline void write(const Tracked<T> &from_type, Writer &writer)
+  {
+    BinaryHandler<T>::write(from_type.get(), writer);
+  }
+  template <typename Reader>
+  static inline Error read(Tracked<T> &to_type, Reader &reader)
+  {
+    return BinaryHandler<T>::read(to_type.edit(), reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<std::unique_ptr<T>>
+{
+  template <typename Writer>
+  static inline void write(const std::unique_ptr<T> &from_type, Writer &writer)
+  {
+    writer.writeNull(!from_type);
+    if (from_type)
+      BinaryHandler<T>::write(*from_type, writer);
+  }
+  template <typename Reader>
+  static inline Error read(std::unique_ptr<T> &to_type, Reader &reader)
+  {
+    bool null;
+    Error error = reader.readNull(null);
+    if (error != Error::NoError)
+      return error;
+    if (null)
+    {
+      to_type.reset();
+      return Error::NoError;
+    }
+    if (!to_type)
+      to_type.reset(new T());
+    return BinaryHandler<T>::read(*to_type, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("nullable");
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+/// \private
+template <typename T>
+struct BinaryHandler<std::shared_ptr<T>>
+{
+  template <typename Writer>
+  static inline void write(const std::shared_ptr<T> &from_type, Writer &writer)
+  {
+    writer.writeNull(!from_type);
+    if (from_type)
+      BinaryHandler<T>::write(*from_type, writer);
+  }
+  template <typename Reader>
+  static inline Error read(std::shared_ptr<T> &to_type, Reader &reader)
+  {
+    bool null;
+    Error error = reader.readNull(null);
+    if (error != Error::NoError)
+      return error;
+    if (null)
+    {
+      to_type.reset();
+      return Error::NoError;
+    }
+    if (!to_type)
+      to_type = std::make_shared<T>();
+    return BinaryHandler<T>::read(*to_type, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("nullable");
+    BinaryHandler<T>::schema(schema);
+  }
+};
+
+#ifdef JS_STD_OPTIONAL
+/// \private
+template <typename T>
+struct BinaryHandler<std::optional<T>>
+{
+  template <typename Writer>
+  static inline void write(const std::optional<T> &from_type, Writer &writer)
+  {
+    writer.writeNull(!from_type);
+    if (from_type)
+      BinaryHandler<T>::write(*from_type, writer);
+  }
+  template <typename Reader>
+  static inline Error read(std::optional<T> &to_type, Reader &reader)
+  {
+    bool null;
+    Error error = reader.readNull(null);
+    if (error != Error::NoError)
+      return error;
+    if (null)
+    {
+      to_type.reset();
+      return Error::NoError;
+    }
+    if (!to_type)
+      to_type.emplace();
+    return BinaryHandler<T>::read(*to_type, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("nullable");
+    BinaryHandler<T>::schema(schema);
+  }
+};
+#endif
+
+#ifdef JS_STD_UNORDERED_MAP
+/// \private
+template <typename Key, typename Value>
+struct BinaryHandler<std::unordered_map<Key, Value>> : Internal::BinaryMap<std::unordered_map<Key, Value>>
+{
+};
+#endif
+
+namespace Internal
+{
+/*!
+ * \private
+ * Writes MessagePack, see serializeMsgpack. Integers use the smallest encoding that holds the value.
+ */
+class MsgpackWriter
+{
+public:
+  MsgpackWriter(std::string &out, KeyStyle keys)
+    : m_buffer(out)
+    , m_keys(keys)
+  {
+  }
+
+  void writeNull(bool null)
+  {
+    if (null)
+      writeByte(0xc0);
+  }
+
+  void writeBool(bool value)
+  {
+    writeByte(value ? 0xc3 : 0xc2);
+  }
+
+  template <typename I>
+  void writeInteger(I value)
+  {
+    if (isNegativeInteger(value, std::is_signed<I>()))
+      writeNegative(int64_t(value));
+    else
+      writeUnsigned(uint64_t(value));
+  }
+
+  void writeFloat(float value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    char *out = m_buffer.grow(5);
+    out[0] = char(0xca);
+    storeBigEndian<4>(out + 1, bits);
+  }
+
+  void writeFloat(double value)
+  {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    char *out = m_buffer.grow(9);
+    out[0] = char(0xcb);
+    storeBigEndian<8>(out + 1, bits);
+  }
+
+  void writeString(const char *data, size_t size)
+  {
+    writeHeader(size, 0xa0, 32, 0xd9);
+    m_buffer.append(data, size);
+  }
+
+  void writeBytes(const char *data, size_t size)
+  {
+    // bin 8, 16 and 32, there is no fix variant
+    writeHeader(size, 0, 0, 0xc4);
+    m_buffer.append(data, size);
+  }
+
+  void beginArray(size_t size)
+  {
+    writeHeader(size, 0x90, 16, 0);
+  }
+
+  void endArray()
+  {
+  }
+
+  void beginMap(size_t size)
+  {
+    writeHeader(size, 0x80, 16, 0);
+  }
+
+  void endMap()
+  {
+  }
+
+  void beginObject(size_t member_count)
+  {
+    beginMap(member_count);
+  }
+
+  void writeMemberKey(const char *name, size_t size, size_t index)
+  {
+    if (m_keys == KeyStyle::Indices)
+      writeUnsigned(index);
+    else
+      writeString(name, size);
+  }
+
+  void endObject()
+  {
+  }
+
+  void finish()
+  {
+    m_buffer.finish();
+  }
+
+private:
+  void writeByte(uint8_t byte)
+  {
+    *m_buffer.grow(1) = char(byte);
+  }
+
+  void writeUnsigned(uint64_t value)
+  {
+    if (value < 0x80)
+    {
+      writeByte(uint8_t(value));
+    }
+    else if (value <= 0xff)
+    {
+      char *out = m_buffer.grow(2);
+      out[0] = char(0xcc);
+      out[1] = char(value);
+    }
+    else if (value <= 0xffff)
+    {
+      char *out = m_buffer.grow(3);
+      out[0] = char(0xcd);
+      storeBigEndian<2>(out + 1, value);
+    }
+    else if (value <= 0xffffffff)
+    {
+      char *out = m_buffer.grow(5);
+      out[0] = char(0xce);
+      storeBigEndian<4>(out + 1, value);
+    }
+    else
+    {
+      char *out = m_buffer.grow(9);
+      out[0] = char(0xcf);
+      storeBigEndian<8>(out + 1, value);
+    }
+  }
+
+  void writeNegative(int64_t value)
+  {
+    if (value >= -32)
+    {
+      writeByte(uint8_t(value));
+    }
+    else if (value >= -128)
+    {
+      char *out = m_buffer.grow(2);
+      out[0] = char(0xd0);
+      out[1] = char(value);
+    }
+    else if (value >= -32768)
+    {
+      char *out = m_buffer.grow(3);
+      out[0] = char(0xd1);
+      storeBigEndian<2>(out + 1, uint64_t(value));
+    }
+    else if (value >= int64_t(INT32_MIN))
+    {
+      char *out = m_buffer.grow(5);
+      out[0] = char(0xd2);
+      storeBigEndian<4>(out + 1, uint64_t(value));
+    }
+    else
+    {
+      char *out = m_buffer.grow(9);
+      out[0] = char(0xd3);
+      storeBigEndian<8>(out + 1, uint64_t(value));
+    }
+  }
+
+  // Strings, arrays and maps share the layout of their headers: a fix variant holding sizes below fix_limit, an
+  // optional 8 bit variant and 16 and 32 bit variants following it.
+  void writeHeader(size_t size, uint8_t fix, size_t fix_limit, uint8_t tag8)
+  {
+    if (size < fix_limit)
+    {
+      writeByte(uint8_t(fix | size));
+    }
+    else if (tag8 && size <= 0xff)
+    {
+      char *out = m_buffer.grow(2);
+      out[0] = char(tag8);
+      out[1] = char(size);
+    }
+    else
+    {
+      const uint8_t tag16 = tag8 ? uint8_t(tag8 + 1) : fix == 0x90 ? 0xdc : 0xde;
+      if (size <= 0xffff)
+      {
+        char *out = m_buffer.grow(3);
+        out[0] = char(tag16);
+        storeBigEndian<2>(out + 1, size);
+      }
+      else
+      {
+        char *out = m_buffer.grow(5);
+        out[0] = char(tag16 + 1);
+        storeBigEndian<4>(out + 1, size);
+      }
+    }
+  }
+
+  BinaryBuffer m_buffer;
+  KeyStyle m_keys;
+};
+
+/*!
+ * \private
+ * Reads MessagePack, see parseMsgpack. Member keys can be names or indices, and strings are only copied into the
+ * values they are read to.
+ */
+class MsgpackReader
+{
+public:
+  MsgpackReader(const char *data, size_t size)
+    : m_data(data)
+    , m_end(data + size)
+  {
+  }
+
+  bool positional() const
+  {
+    return false;
+  }
+
+  size_t remaining() const
+  {
+    return size_t(m_end - m_data);
+  }
+
+  Error readNull(bool &null)
+  {
+    null = m_data != m_end && uint8_t(*m_data) == 0xc0;
+    if (null)
+      m_data++;
+    return Error::NoError;
+  }
+
+  Error readBool(bool &value)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if (byte != 0xc2 && byte != 0xc3)
+      return Error::FailedToParseBoolean;
+    value = byte == 0xc3;
+    m_data++;
+    return Error::NoError;
+  }
+
+  template <typename I>
+  Error readInteger(I &value)
+  {
+    uint64_t bits;
+    bool negative;
+    Error error = readIntegerBits(bits, negative);
+    if (error != Error::NoError)
+      return error;
+    return assignBinaryInteger(bits, negative, value) ? Error::NoError : Error::FailedToParseInt;
+  }
+
+  template <typename F>
+  Error readFloat(F &value)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if (byte == 0xca || byte == 0xcb)
+    {
+      const size_t size = byte == 0xca ? 4 : 8;
+      if (remaining() < size + 1)
+        return Error::NeedMoreData;
+      if (size == 4)
+      {
+        const uint32_t bits = uint32_t(loadBigEndian<4>(m_data + 1));
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        value = F(f);
+      }
+      else
+      {
+        const uint64_t bits = loadBigEndian<8>(m_data + 1);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        value = F(d);
+      }
+      m_data += size + 1;
+      return Error::NoError;
+    }
+    uint64_t bits;
+    bool negative;
+    if (readIntegerBits(bits, negative) != Error::NoError)
+      return std::is_same<F, float>::value ? Error::FailedToParseFloat : Error::FailedToParseDouble;
+    value = negative ? F(int64_t(bits)) : F(bits);
+    return Error::NoError;
+  }
+
+  Error readString(std::string &value)
+  {
+    DataRef str;
+    Error error = readStringRef(str);
+    if (error == Error::NoError)
+      value.assign(str.data, str.size);
+    return error;
+  }
+
+  Error readBytes(std::vector<uint8_t> &value)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if (byte < 0xc4 || byte > 0xc6)
+      return Error::IllegalDataValue;
+    size_t size;
+    Error error = readSize(size_t(1) << (byte - 0xc4), size);
+    if (error != Error::NoError)
+      return error;
+    if (remaining() < size)
+      return Error::NeedMoreData;
+    value.assign(m_data, m_data + size);
+    m_data += size;
+    return Error::NoError;
+  }
+
+  Error beginArray(size_t &size)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if ((byte & 0xf0) == 0x90)
+    {
+      size = byte & 0x0f;
+      m_data++;
+      return Error::NoError;
+    }
+    if (byte != 0xdc && byte != 0xdd)
+      return Error::ExpectedArrayStart;
+    return readSize(byte == 0xdc ? 2 : 4, size);
+  }
+
+  Error beginMap(size_t &size)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if ((byte & 0xf0) == 0x80)
+    {
+      size = byte & 0x0f;
+      m_data++;
+      return Error::NoError;
+    }
+    if (byte != 0xde && byte != 0xdf)
+      return Error::ExpectedObjectStart;
+    return readSize(byte == 0xde ? 2 : 4, size);
+  }
+
+  Error beginObject(size_t member_count, size_t &size)
+  {
+    JS_UNUSED(member_count);
+    return beginMap(size);
+  }
+
+  // Counts down the elements of an array or map, returns false after the last one.
+  bool next(size_t &remaining)
+  {
+    if (!remaining)
+      return false;
+    remaining--;
+    return true;
+  }
+
+  Error readMemberKey(BinaryKey &key)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    key.is_index = byte < 0x80 || (byte >= 0xcc && byte <= 0xcf);
+    if (!key.is_index)
+      return readStringRef(key.name) == Error::NoError ? Error::NoError : Error::IllegalPropertyName;
+    uint64_t bits;
+    bool negative;
+    Error error = readIntegerBits(bits, negative);
+    if (error != Error::NoError)
+      return error;
+    key.index = size_t(bits);
+    return Error::NoError;
+  }
+
+  // Skips one value, including everything nested in it.
+  Error skip()
+  {
+    size_t pending = 1;
+    while (pending)
+    {
+      pending--;
+      if (m_data == m_end)
+        return Error::NeedMoreData;
+      const uint8_t byte = uint8_t(*m_data);
+      size_t size = 0;
+      Error error = Error::NoError;
+      if (byte < 0x80 || byte >= 0xe0 || byte == 0xc0 || byte == 0xc2 || byte == 0xc3)
+      {
+        m_data++;
+      }
+      else if (byte < 0xa0 || byte == 0xdc || byte == 0xdd || byte == 0xde || byte == 0xdf)
+      {
+        error = byte < 0x90 || byte >= 0xde ? beginMap(size) : beginArray(size);
+        pending += byte < 0x90 || byte >= 0xde ? size * 2 : size;
+      }
+      else if (byte < 0xc0 || (byte >= 0xd9 && byte <= 0xdb))
+      {
+        DataRef str;
+        error = readStringRef(str);
+      }
+      else if (byte >= 0xc4 && byte <= 0xc6)
+      {
+        error = readSize(size_t(1) << (byte - 0xc4), size);
+        error = error == Error::NoError ? skipBytes(size) : error;
+      }
+      else if (byte >= 0xc7 && byte <= 0xc9)
+      {
+        error = readSize(size_t(1) << (byte - 0xc7), size);
+        error = error == Error::NoError ? skipBytes(size + 1) : error;
+      }
+      else if (byte >= 0xd4 && byte <= 0xd8)
+      {
+        error = skipBytes((size_t(1) << (byte - 0xd4)) + 2);
+      }
+      else if (byte >= 0xca && byte <= 0xd3)
+      {
+        static const uint8_t sizes[] = {4, 8, 1, 2, 4, 8, 1, 2, 4, 8};
+        error = skipBytes(size_t(sizes[byte - 0xca]) + 1);
+      }
+      else
+      {
+        error = Error::InvalidToken;
+      }
+      if (error != Error::NoError)
+        return error;
+    }
+    return Error::NoError;
+  }
+
+  bool atEnd() const
+  {
+    return m_data == m_end;
+  }
+
+private:
+  Error readIntegerBits(uint64_t &bits, bool &negative)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    negative = false;
+    if (byte < 0x80 || byte >= 0xe0)
+    {
+      bits = uint64_t(int64_t(int8_t(byte)));
+      negative = byte >= 0xe0;
+      m_data++;
+      return Error::NoError;
+    }
+    if (byte < 0xcc || byte > 0xd3)
+      return Error::FailedToParseInt;
+    const size_t size = size_t(1) << ((byte - 0xcc) & 3);
+    if (remaining() < size + 1)
+      return Error::NeedMoreData;
+    bits = size == 1 ? loadBigEndian<1>(m_data + 1)
+           : size == 2 ? loadBigEndian<2>(m_data + 1)
+           : size == 4 ? loadBigEndian<4>(m_data + 1)
+                       : loadBigEndian<8>(m_data + 1);
+    if (byte >= 0xd0)
+    {
+      // Sign extend the smaller signed types
+      const int shift = int(64 - size * 8);
+      bits = uint64_t(int64_t(bits << shift) >> shift);
+      negative = int64_t(bits) < 0;
+    }
+    m_data += size + 1;
+    return Error::NoError;
+  }
+
+  Error readStringRef(DataRef &str)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    size_t size;
+    if ((byte & 0xe0) == 0xa0)
+    {
+      size = byte & 0x1f;
+      m_data++;
+    }
+    else if (byte >= 0xd9 && byte <= 0xdb)
+    {
+      Error error = readSize(size_t(1) << (byte - 0xd9), size);
+      if (error != Error::NoError)
+        return error;
+    }
+    else
+    {
+      return Error::IllegalDataValue;
+    }
+    if (remaining() < size)
+      return Error::NeedMoreData;
+    str = DataRef(m_data, size);
+    m_data += size;
+    return Error::NoError;
+  }
+
+  // Reads the tag byte and the big endian size following it.
+  Error readSize(size_t bytes, size_t &size)
+  {
+    if (remaining() < bytes + 1)
+      return Error::NeedMoreData;
+    size = size_t(bytes == 1 ? loadBigEndian<1>(m_data + 1)
+                  : bytes == 2 ? loadBigEndian<2>(m_data + 1)
+                               : loadBigEndian<4>(m_data + 1));
+    m_data += bytes + 1;
+    return Error::NoError;
+  }
+
+  Error skipBytes(size_t size)
+  {
+    if (remaining() < size)
+      return Error::NeedMoreData;
+    m_data += size;
+    return Error::NoError;
+  }
+
+  const char *m_data;
+  const char *m_end;
+};
+} // namespace Internal
+
+/*!
+ * Serializes from_type to MessagePack, driven by the same JS_OBJ meta data as serializeStruct, see BinaryHandler.
+ * With KeyStyle::Indices the members are keyed by their index instead of their name.
+ */
+template <typename T>
+void serializeMsgpack(const T &from_type, std::string &out, KeyStyle keys = KeyStyle::Names)
+{
+  Internal::MsgpackWriter writer(out, keys);
+  BinaryHandler<T>::write(from_type, writer);
+  writer.finish();
+}
+
+template <typename T>
+JS_NODISCARD std::string serializeMsgpack(const T &from_type, KeyStyle keys = KeyStyle::Names)
+{
+  std::string out;
+  serializeMsgpack(from_type, out, keys);
+  return out;
+}
+
+/*!
+ * Parses MessagePack written by serializeMsgpack, or by any other writer, into to_type. Members are matched by name,
+ * including the aliases, or by index, and unknown members are skipped. Integers are range checked against the type
+ * they are read into, and trailing data after the value is an error.
+ */
+template <typename T>
+JS_NODISCARD inline Error parseMsgpack(const char *data, size_t size, T &to_type)
+{
+  Internal::MsgpackReader reader(data, size);
+  Error error = BinaryHandler<T>::read(to_type, reader);
+  if (error == Error::NoError && !reader.atEnd())
+    return Error::InvalidToken;
+  return error;
+}
+
+template <typename T>
+JS_NODISCARD inline Error parseMsgpack(const std::string &data, T &to_type)
+{
+  return parseMsgpack(data.data(), data.size(), to_type);
+}
+
+/*!
+ * Options for serializeCbor.
+ *
+ * Deterministic gives the core deterministic encoding of RFC 8949 section 4.2.1: the shortest form of every integer,
+ * length and floating point value, definite lengths, and map entries sorted by the bytes of their encoded keys. The
+ * same value then always gives the same bytes, so the output can be hashed or signed.
+ *
+ * IndefiniteLengths writes arrays, maps and objects with indefinite lengths, ended by a break byte, like a streaming
+ * producer that does not know the sizes up front. It is ignored in deterministic mode.
+ */
+class CborOptions
+{
+public:
+  CborOptions(KeyStyle keys = KeyStyle::Names)
+    : m_keys(keys)
+    , m_deterministic(false)
+    , m_indefinite_lengths(false)
+  {
+  }
+
+  KeyStyle keys() const
+  {
+    return m_keys;
+  }
+  void setKeys(KeyStyle keys)
+  {
+    m_keys = keys;
+  }
+
+  bool deterministic() const
+  {
+    return m_deterministic;
+  }
+  void setDeterministic(bool set)
+  {
+    m_deterministic = set;
+  }
+
+  bool indefiniteLengths() const
+  {
+    return m_indefinite_lengths;
+  }
+  void setIndefiniteLengths(bool set)
+  {
+    m_indefinite_lengths = set;
+  }
+
+private:
+  KeyStyle m_keys;
+  bool m_deterministic;
+  bool m_indefinite_lengths;
+};
+
+namespace Internal
+{
+// Returns the half precision bits of value, or false when value can not be represented exactly as a half.
+static inline bool floatToHalf(float value, uint16_t &half)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+  const int exponent = int((bits >> 23) & 0xff);
+  const uint32_t mantissa = bits & 0x7fffff;
+  if (exponent == 0xff)
+  {
+    if (mantissa)
+      return false;
+    half = uint16_t(sign | 0x7c00);
+    return true;
+  }
+  if (exponent == 0 && mantissa == 0)
+  {
+    half = sign;
+    return true;
+  }
+  const int half_exponent = exponent - 127 + 15;
+  if (half_exponent >= 1 && half_exponent <= 30)
+  {
+    if (mantissa & 0x1fff)
+      return false;
+    half = uint16_t(sign | (half_exponent << 10) | (mantissa >> 13));
+    return true;
+  }
+  // Subnormal halves hold multiples of 2^-24 below 2^-14
+  if (exponent == 0 || half_exponent < -9 || half_exponent > 0)
+    return false;
+  const uint32_t significand = mantissa | 0x800000;
+  const int shift = 14 - half_exponent;
+  if (significand & ((uint32_t(1) << shift) - 1))
+    return false;
+  half = uint16_t(sign | (significand >> shift));
+  return true;
+}
+
+static inline float halfToFloat(uint16_t half)
+{
+  const int exponent = (half >> 10) & 0x1f;
+  const int mantissa = half & 0x3ff;
+  float value;
+  if (exponent == 0)
+    value = std::ldexp(float(mantissa), -24);
+  else if (exponent == 0x1f)
+    value = mantissa ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+  else
+    value = std::ldexp(float(mantissa | 0x400), exponent - 25);
+  return half & 0x8000 ? -value : value;
+}
+
+/*!
+ * \private
+ * Writes CBOR, see serializeCbor. In deterministic mode the writer keeps the offsets of the keys and values of the
+ * open maps, and sorts the entries of a map by their encoded keys when it ends.
+ */
+class CborWriter
+{
+public:
+  CborWriter(std::string &out, const CborOptions &options)
+    : m_buffer(out)
+    , m_keys(options.keys())
+    , m_deterministic(options.deterministic())
+    , m_indefinite(options.indefiniteLengths() && !options.deterministic())
+  {
+  }
+
+  void writeNull(bool null)
+  {
+    if (null)
+      writeSimple(0xf6);
+  }
+
+  void writeBool(bool value)
+  {
+    writeSimple(value ? 0xf5 : 0xf4);
+  }
+
+  template <typename I>
+  void writeInteger(I value)
+  {
+    if (isNegativeInteger(value, std::is_signed<I>()))
+      writeHead(1, ~uint64_t(int64_t(value)));
+    else
+      writeHead(0, uint64_t(value));
+  }
+
+  void writeFloat(float value)
+  {
+    // NaN is written as the canonical half precision NaN in deterministic mode
+    uint16_t half = 0x7e00;
+    if (m_deterministic && (value != value || floatToHalf(value, half)))
+    {
+      writeFloatBits(0xf9, half, 2);
+      return;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeFloatBits(0xfa, bits, 4);
+  }
+
+  void writeFloat(double value)
+  {
+    if (m_deterministic && (value != value || std::isinf(value) ||
+                            (std::fabs(value) <= double(std::numeric_limits<float>::max()) &&
+                             double(float(value)) == value)))
+    {
+      writeFloat(float(value));
+      return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeFloatBits(0xfb, bits, 8);
+  }
+
+  void writeString(const char *data, size_t size)
+  {
+    writeHead(3, size);
+    m_buffer.append(data, size);
+  }
+
+  void writeBytes(const char *data, size_t size)
+  {
+    writeHead(2, size);
+    m_buffer.append(data, size);
+  }
+
+  void beginArray(size_t size)
+  {
+    beginContainer(4, size, false);
+  }
+
+  void endArray()
+  {
+    endContainer();
+  }
+
+  void beginMap(size_t size)
+  {
+    beginContainer(5, size, m_deterministic);
+  }
+
+  void endMap()
+  {
+    endContainer();
+  }
+
+  void beginObject(size_t member_count)
+  {
+    beginMap(member_count);
+  }
+
+  void writeMemberKey(const char *name, size_t size, size_t index)
+  {
+    if (m_keys == KeyStyle::Indices)
+      writeHead(0, index);
+    else
+      writeString(name, size);
+  }
+
+  void endObject()
+  {
+    endMap();
+  }
+
+  void finish()
+  {
+    m_buffer.finish();
+  }
+
+private:
+  struct Frame
+  {
+    bool sorted;
+    size_t first_offset;
+  };
+
+  // Called before every item, so the entries of a sorted map can be found again when it ends
+  void itemStart()
+  {
+    if (!m_frames.empty() && m_frames.back().sorted)
+      m_offsets.push_back(m_buffer.size());
+  }
+
+  void writeHead(uint8_t major, uint64_t argument)
+  {
+    itemStart();
+    const uint8_t type = uint8_t(major << 5);
+    if (argument < 24)
+    {
+      *m_buffer.grow(1) = char(type | argument);
+    }
+    else if (argument <= 0xff)
+    {
+      char *out = m_buffer.grow(2);
+      out[0] = char(type | 24);
+      out[1] = char(argument);
+    }
+    else if (argument <= 0xffff)
+    {
+      char *out = m_buffer.grow(3);
+      out[0] = char(type | 25);
+      storeBigEndian<2>(out + 1, argument);
+    }
+    else if (argument <= 0xffffffff)
+    {
+      char *out = m_buffer.grow(5);
+      out[0] = char(type | 26);
+      storeBigEndian<4>(out + 1, argument);
+    }
+    else
+    {
+      char *out = m_buffer.grow(9);
+      out[0] = char(type | 27);
+      storeBigEndian<8>(out + 1, argument);
+    }
+  }
+
+  void writeSimple(uint8_t byte)
+  {
+    itemStart();
+    *m_buffer.grow(1) = char(byte);
+  }
+
+  void writeFloatBits(uint8_t byte, uint64_t bits, size_t size)
+  {
+    itemStart();
+    char *out = m_buffer.grow(size + 1);
+    out[0] = char(byte);
+    if (size == 2)
+      storeBigEndian<2>(out + 1, bits);
+    else if (size == 4)
+      storeBigEndian<4>(out + 1, bits);
+    else
+      storeBigEndian<8>(out + 1, bits);
+  }
+
+  void beginContainer(uint8_t major, size_t size, bool sorted)
+  {
+    if (m_indefinite)
+      writeSimple(uint8_t((major << 5) | 31));
+    else
+      writeHead(major, size);
+    if (m_deterministic)
+      m_frames.push_back({sorted, m_offsets.size()});
+  }
+
+  void endContainer()
+  {
+    if (m_indefinite)
+      writeBreak();
+    if (!m_deterministic)
+      return;
+    const Frame frame = m_frames.back();
+    m_frames.pop_back();
+    if (frame.sorted)
+      sortEntries(frame.first_offset);
+  }
+
+  void writeBreak()
+  {
+    *m_buffer.grow(1) = char(0xff);
+  }
+
+  // Sorts the map entries written since first_offset by the bytes of their encoded keys.
+  void sortEntries(size_t first_offset)
+  {
+    const size_t entries = (m_offsets.size() - first_offset) / 2;
+    if (entries > 1)
+    {
+      const size_t *offsets = &m_offsets[first_offset];
+      const char *data = m_buffer.data();
+      const size_t end = m_buffer.size();
+      std::vector<size_t> order(entries);
+      for (size_t i = 0; i < entries; i++)
+        order[i] = i;
+      std::sort(order.begin(), order.end(), [offsets, data](size_t a, size_t b) {
+        const size_t a_size = offsets[a * 2 + 1] - offsets[a * 2];
+        const size_t b_size = offsets[b * 2 + 1] - offsets[b * 2];
+        const int cmp = memcmp(data + offsets[a * 2], data + offsets[b * 2], std::min(a_size, b_size));
+        return cmp < 0 || (cmp == 0 && a_size < b_size);
+      });
+      const size_t begin = offsets[0];
+      m_scratch.assign(data + begin, end - begin);
+      char *out = m_buffer.data() + begin;
+      for (size_t i : order)
+      {
+        const size_t entry_begin = offsets[i * 2];
+        const size_t entry_end = i + 1 < entries ? offsets[i * 2 + 2] : end;
+        memcpy(out, m_scratch.data() + (entry_begin - begin), entry_end - entry_begin);
+        out += entry_end - entry_begin;
+      }
+    }
+    m_offsets.resize(first_offset);
+  }
+
+  BinaryBuffer m_buffer;
+  KeyStyle m_keys;
+  bool m_deterministic;
+  bool m_indefinite;
+  std::vector<Frame> m_frames;
+  std::vector<size_t> m_offsets;
+  std::string m_scratch;
+};
+
+/*!
+ * \private
+ * Reads CBOR, see parseCbor. Definite and indefinite lengths are both accepted, also for strings split into chunks,
+ * and tags in front of a value are skipped.
+ */
+class CborReader
+{
+public:
+  CborReader(const char *data, size_t size)
+    : m_data(data)
+    , m_end(data + size)
+  {
+  }
+
+  bool positional() const
+  {
+    return false;
+  }
+
+  size_t remaining() const
+  {
+    return size_t(m_end - m_data);
+  }
+
+  Error readNull(bool &null)
+  {
+    skipTags();
+    // undefined is read as null as well
+    null = m_data != m_end && (uint8_t(*m_data) == 0xf6 || uint8_t(*m_data) == 0xf7);
+    if (null)
+      m_data++;
+    return Error::NoError;
+  }
+
+  Error readBool(bool &value)
+  {
+    skipTags();
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if (byte != 0xf4 && byte != 0xf5)
+      return Error::FailedToParseBoolean;
+    value = byte == 0xf5;
+    m_data++;
+    return Error::NoError;
+  }
+
+  template <typename I>
+  Error readInteger(I &value)
+  {
+    uint64_t bits;
+    bool negative;
+    Error error = readIntegerBits(bits, negative);
+    if (error != Error::NoError)
+      return error;
+    return assignBinaryInteger(bits, negative, value) ? Error::NoError : Error::FailedToParseInt;
+  }
+
+  template <typename F>
+  Error readFloat(F &value)
+  {
+    skipTags();
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if (byte >= 0xf9 && byte <= 0xfb)
+    {
+      const size_t size = size_t(2) << (byte - 0xf9);
+      if (remaining() < size + 1)
+        return Error::NeedMoreData;
+      if (size == 2)
+      {
+        value = F(halfToFloat(uint16_t(loadBigEndian<2>(m_data + 1))));
+      }
+      else if (size == 4)
+      {
+        const uint32_t bits = uint32_t(loadBigEndian<4>(m_data + 1));
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        value = F(f);
+      }
+      else
+      {
+        const uint64_t bits = loadBigEndian<8>(m_data + 1);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        value = F(d);
+      }
+      m_data += size + 1;
+      return Error::NoError;
+    }
+    uint64_t bits;
+    bool negative;
+    if (readIntegerBits(bits, negative) != Error::NoError)
+      return std::is_same<F, float>::value ? Error::FailedToParseFloat : Error::FailedToParseDouble;
+    value = negative ? F(int64_t(bits)) : F(bits);
+    return Error::NoError;
+  }
+
+  Error readString(std::string &value)
+  {
+    value.clear();
+    return appendString(value, 3);
+  }
+
+  Error readBytes(std::vector<uint8_t> &value)
+  {
+    std::string bytes;
+    Error error = appendString(bytes, 2);
+    if (error == Error::NoError)
+      value.assign(bytes.begin(), bytes.end());
+    return error;
+  }
+
+  Error beginArray(size_t &size)
+  {
+    return beginContainer(4, size, Error::ExpectedArrayStart);
+  }
+
+  Error beginMap(size_t &size)
+  {
+    return beginContainer(5, size, Error::ExpectedObjectStart);
+  }
+
+  Error beginObject(size_t member_count, size_t &size)
+  {
+    JS_UNUSED(member_count);
+    return beginMap(size);
+  }
+
+  // Counts down the elements of a definite length array or map, or looks for the break of an indefinite length one.
+  // Returns false after the last element.
+  bool next(size_t &remaining)
+  {
+    if (remaining == indefinite)
+    {
+      if (m_data == m_end || uint8_t(*m_data) != 0xff)
+        return true;
+      m_data++;
+      return false;
+    }
+    if (!remaining)
+      return false;
+    remaining--;
+    return true;
+  }
+
+  Error readMemberKey(BinaryKey &key)
+  {
+    skipTags();
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t major = uint8_t(*m_data) >> 5;
+    key.is_index = major == 0;
+    if (major == 0)
+    {
+      uint64_t bits;
+      bool negative;
+      Error error = readIntegerBits(bits, negative);
+      if (error != Error::NoError)
+        return error;
+      key.index = size_t(bits);
+      return Error::NoError;
+    }
+    if (major != 3)
+      return Error::IllegalPropertyName;
+    // Definite length names point into the data, only chunked names are copied
+    const uint8_t info = uint8_t(*m_data) & 0x1f;
+    if (info != 31)
+    {
+      uint64_t size;
+      Error error = readHead(3, size);
+      if (error != Error::NoError)
+        return error;
+      if (remaining() < size)
+        return Error::NeedMoreData;
+      key.name = DataRef(m_data, size_t(size));
+      m_data += size;
+      return Error::NoError;
+    }
+    m_key.clear();
+    Error error = appendString(m_key, 3);
+    key.name = DataRef(m_key.data(), m_key.size());
+    return error;
+  }
+
+  // Skips one value, including everything nested in it.
+  Error skip()
+  {
+    size_t pending = 1;
+    std::vector<size_t> outer;
+    while (true)
+    {
+      if (pending == 0)
+      {
+        if (outer.empty())
+          return Error::NoError;
+        pending = outer.back();
+        outer.pop_back();
+        continue;
+      }
+      if (m_data == m_end)
+        return Error::NeedMoreData;
+      const uint8_t byte = uint8_t(*m_data);
+      if (pending == indefinite && byte == 0xff)
+      {
+        m_data++;
+        pending = 0;
+        continue;
+      }
+      if (pending != indefinite)
+        pending--;
+      const uint8_t major = byte >> 5;
+      const uint8_t info = byte & 0x1f;
+      if (info == 31)
+      {
+        if (major < 2 || major > 5)
+          return Error::InvalidToken;
+        m_data++;
+        outer.push_back(pending);
+        pending = indefinite;
+        continue;
+      }
+      uint64_t argument;
+      Error error = readHead(major, argument);
+      if (error != Error::NoError)
+        return error;
+      if (major == 2 || major == 3)
+      {
+        if (remaining() < argument)
+          return Error::NeedMoreData;
+        m_data += argument;
+      }
+      else if (major == 4 || major == 5)
+      {
+        if (argument > uint64_t(indefinite - 1) / 2)
+          return Error::NeedMoreData;
+        outer.push_back(pending);
+        pending = size_t(major == 5 ? argument * 2 : argument);
+      }
+      else if (major == 6)
+      {
+        // The tagged value follows
+        outer.push_back(pending);
+        pending = 1;
+      }
+    }
+  }
+
+  bool atEnd() const
+  {
+    return m_data == m_end;
+  }
+
+private:
+  static const size_t indefinite = ~size_t(0);
+
+  void skipTags()
+  {
+    while (m_data != m_end && (uint8_t(*m_data) >> 5) == 6)
+    {
+      uint64_t tag;
+      if (readHead(6, tag) != Error::NoError)
+        return;
+    }
+  }
+
+  // Reads the initial byte of the given major type and its argument. Indefinite lengths are handled by the callers.
+  Error readHead(uint8_t major, uint64_t &argument)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if ((byte >> 5) != major)
+      return Error::IllegalDataValue;
+    const uint8_t info = byte & 0x1f;
+    if (info < 24)
+    {
+      argument = info;
+      m_data++;
+      return Error::NoError;
+    }
+    if (info > 27)
+      return Error::InvalidToken;
+    const size_t size = size_t(1) << (info - 24);
+    if (remaining() < size + 1)
+      return Error::NeedMoreData;
+    argument = size == 1   ? loadBigEndian<1>(m_data + 1)
+               : size == 2 ? loadBigEndian<2>(m_data + 1)
+               : size == 4 ? loadBigEndian<4>(m_data + 1)
+                           : loadBigEndian<8>(m_data + 1);
+    m_data += size + 1;
+    return Error::NoError;
+  }
+
+  Error readIntegerBits(uint64_t &bits, bool &negative)
+  {
+    skipTags();
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t major = uint8_t(*m_data) >> 5;
+    if (major > 1)
+      return Error::FailedToParseInt;
+    Error error = readHead(major, bits);
+    if (error != Error::NoError)
+      return error == Error::IllegalDataValue ? Error::FailedToParseInt : error;
+    negative = major == 1;
+    if (negative)
+    {
+      // -1 - argument, which has to fit an int64_t
+      if (bits > uint64_t(std::numeric_limits<int64_t>::max()))
+        return Error::FailedToParseInt;
+      bits = ~bits;
+    }
+    return Error::NoError;
+  }
+
+  // Appends a text string (major type 3) or a byte string (major type 2).
+  Error appendString(std::string &value, uint8_t major)
+  {
+    skipTags();
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    if (uint8_t(*m_data) != uint8_t((major << 5) | 31))
+    {
+      uint64_t size;
+      Error error = readHead(major, size);
+      if (error != Error::NoError)
+        return error;
+      if (remaining() < size)
+        return Error::NeedMoreData;
+      value.append(m_data, size_t(size));
+      m_data += size;
+      return Error::NoError;
+    }
+    // An indefinite length string is a list of definite length chunks ended by a break
+    m_data++;
+    while (true)
+    {
+      if (m_data == m_end)
+        return Error::NeedMoreData;
+      if (uint8_t(*m_data) == 0xff)
+      {
+        m_data++;
+        return Error::NoError;
+      }
+      uint64_t size;
+      Error error = readHead(major, size);
+      if (error != Error::NoError)
+        return error;
+      if (remaining() < size)
+        return Error::NeedMoreData;
+      value.append(m_data, size_t(size));
+      m_data += size;
+    }
+  }
+
+  Error beginContainer(uint8_t major, size_t &size, Error wrong_type)
+  {
+    skipTags();
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if ((byte >> 5) != major)
+      return wrong_type;
+    if ((byte & 0x1f) == 31)
+    {
+      size = indefinite;
+      m_data++;
+      return Error::NoError;
+    }
+    uint64_t argument;
+    Error error = readHead(major, argument);
+    if (error != Error::NoError)
+      return error;
+    // Each element takes at least one byte, so larger sizes are truncated data
+    if (argument > remaining())
+      return Error::NeedMoreData;
+    size = size_t(argument);
+    return Error::NoError;
+  }
+
+  const char *m_data;
+  const char *m_end;
+  std::string m_key;
+};
+} // namespace Internal
+
+/*!
+ * Serializes from_type to CBOR (RFC 8949), driven by the same JS_OBJ meta data as serializeStruct, see BinaryHandler
+ * and CborOptions.
+ */
+template <typename T>
+void serializeCbor(const T &from_type, std::string &out, const CborOptions &options = CborOptions())
+{
+  Internal::CborWriter writer(out, options);
+  BinaryHandler<T>::write(from_type, writer);
+  writer.finish();
+}
+
+template <typename T>
+JS_NODISCARD std::string serializeCbor(const T &from_type, const CborOptions &options = CborOptions())
+{
+  std::string out;
+  serializeCbor(from_type, out, options);
+  return out;
+}
+
+/*!
+ * Parses CBOR into to_type, with definite or indefinite lengths. Members are matched like parseMsgpack does it, by
+ * name or by index, and tags are ignored. Trailing data after the value is an error.
+ */
+template <typename T>
+JS_NODISCARD inline Error parseCbor(const char *data, size_t size, T &to_type)
+{
+  Internal::CborReader reader(data, size);
+  Error error = BinaryHandler<T>::read(to_type, reader);
+  if (error == Error::NoError && !reader.atEnd())
+    return Error::InvalidToken;
+  return error;
+}
+
+template <typename T>
+JS_NODISCARD inline Error parseCbor(const std::string &data, T &to_type)
+{
+  return parseCbor(data.data(), data.size(), to_type);
+}
+
+namespace Internal
+{
+/*!
+ * \private
+ * Writes the positional format of saveBinary. Members are written in index order without keys, numbers as fixed
+ * width little endian values, and strings, arrays and maps with a 64 bit length in front. Values that can be null have
+ * a presence byte.
+ */
+class BinarySnapshotWriter
+{
+public:
+  explicit BinarySnapshotWriter(std::string &out)
+    : m_buffer(out)
+  {
+  }
+
+  void writeNull(bool null)
+  {
+    *m_buffer.grow(1) = char(null ? 0 : 1);
+  }
+
+  void writeBool(bool value)
+  {
+    *m_buffer.grow(1) = char(value ? 1 : 0);
+  }
+
+  template <typename I>
+  void writeInteger(I value)
+  {
+    storeLittleEndian<sizeof(I)>(m_buffer.grow(sizeof(I)), uint64_t(value));
+  }
+
+  void writeFloat(float value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    storeLittleEndian<4>(m_buffer.grow(4), bits);
+  }
+
+  void writeFloat(double value)
+  {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    storeLittleEndian<8>(m_buffer.grow(8), bits);
+  }
+
+  void writeString(const char *data, size_t size)
+  {
+    writeSize(size);
+    m_buffer.append(data, size);
+  }
+
+  void writeBytes(const char *data, size_t size)
+  {
+    writeString(data, size);
+  }
+
+  void writeSize(uint64_t size)
+  {
+    storeLittleEndian<8>(m_buffer.grow(8), size);
+  }
+
+  void beginArray(size_t size)
+  {
+    writeSize(size);
+  }
+
+  void endArray()
+  {
+  }
+
+  void beginMap(size_t size)
+  {
+    writeSize(size);
+  }
+
+  void endMap()
+  {
+  }
+
+  void beginObject(size_t member_count)
+  {
+    JS_UNUSED(member_count);
+  }
+
+  void writeMemberKey(const char *name, size_t size, size_t index)
+  {
+    JS_UNUSED(name);
+    JS_UNUSED(size);
+    JS_UNUSED(index);
+  }
+
+  void endObject()
+  {
+  }
+
+  void append(const char *data, size_t size)
+  {
+    m_buffer.append(data, size);
+  }
+
+  void finish()
+  {
+    m_buffer.finish();
+  }
+
+private:
+  BinaryBuffer m_buffer;
+};
+
+/*!
+ * \private
+ * Reads the positional format of loadBinary. The layout is known from the types, so there is nothing to skip and no
+ * member keys to match, only the lengths and the bytes left are checked.
+ */
+class BinarySnapshotReader
+{
+public:
+  BinarySnapshotReader(const char *data, size_t size)
+    : m_data(data)
+    , m_end(data + size)
+  {
+  }
+
+  bool positional() const
+  {
+    return true;
+  }
+
+  size_t remaining() const
+  {
+    return size_t(m_end - m_data);
+  }
+
+  Error readNull(bool &null)
+  {
+    bool present = false;
+    Error error = readBool(present);
+    if (error != Error::NoError)
+      return error == Error::FailedToParseBoolean ? Error::IllegalDataValue : error;
+    null = !present;
+    return Error::NoError;
+  }
+
+  Error readBool(bool &value)
+  {
+    if (m_data == m_end)
+      return Error::NeedMoreData;
+    const uint8_t byte = uint8_t(*m_data);
+    if (byte > 1)
+      return Error::FailedToParseBoolean;
+    value = byte == 1;
+    m_data++;
+    return Error::NoError;
+  }
+
+  template <typename I>
+  Error readInteger(I &value)
+  {
+    if (remaining() < sizeof(I))
+      return Error::NeedMoreData;
+    value = I(loadLittleEndian<sizeof(I)>(m_data));
+    m_data += sizeof(I);
+    return Error::NoError;
+  }
+
+  Error readFloat(float &value)
+  {
+    uint32_t bits = 0;
+    Error error = readInteger(bits);
+    memcpy(&value, &bits, sizeof(value));
+    return error;
+  }
+
+  Error readFloat(double &value)
+  {
+    uint64_t bits = 0;
+    Error error = readInteger(bits);
+    memcpy(&value, &bits, sizeof(value));
+    return error;
+  }
+
+  Error readString(std::string &value)
+  {
+    uint64_t size;
+    Error error = readInteger(size);
+    if (error != Error::NoError)
+      return error;
+    if (remaining() < size)
+      return Error::NeedMoreData;
+    value.assign(m_data, size_t(size));
+    m_data += size;
+    return Error::NoError;
+  }
+
+  Error readBytes(std::vector<uint8_t> &value)
+  {
+    uint64_t size;
+    Error error = readInteger(size);
+    if (error != Error::NoError)
+      return error;
+    if (remaining() < size)
+      return Error::NeedMoreData;
+    value.assign(m_data, m_data + size_t(size));
+    m_data += size;
+    return Error::NoError;
+  }
+
+  Error beginArray(size_t &size)
+  {
+    return readSize(size);
+  }
+
+  Error beginMap(size_t &size)
+  {
+    return readSize(size);
+  }
+
+  Error beginObject(size_t member_count, size_t &size)
+  {
+    size = member_count;
+    return Error::NoError;
+  }
+
+  bool next(size_t &remaining)
+  {
+    if (!remaining)
+      return false;
+    remaining--;
+    return true;
+  }
+
+  // Objects are read with readAll, so there are no member keys and nothing to skip
+  Error readMemberKey(BinaryKey &key)
+  {
+    JS_UNUSED(key);
+    return Error::IllegalPropertyName;
+  }
+
+  Error skip()
+  {
+    return Error::InvalidToken;
+  }
+
+  Error readHeader(const char *magic, size_t magic_size, uint64_t &schema_hash)
+  {
+    if (remaining() < magic_size || memcmp(m_data, magic, magic_size) != 0)
+      return Error::InvalidToken;
+    m_data += magic_size;
+    return readInteger(schema_hash);
+  }
+
+  bool atEnd() const
+  {
+    return m_data == m_end;
+  }
+
+private:
+  Error readSize(size_t &size)
+  {
+    uint64_t value;
+    Error error = readInteger(value);
+    if (error != Error::NoError)
+      return error;
+    if (value > uint64_t(std::numeric_limits<size_t>::max()))
+      return Error::NeedMoreData;
+    size = size_t(value);
+    return Error::NoError;
+  }
+
+  const char *m_data;
+  const char *m_end;
+};
+
+static const char binary_snapshot_magic[4] = {'J', 'S', 'B', '1'};
+} // namespace Internal
+
+/*!
+ * Returns the schema hash saveBinary writes for T. It covers the member names, order and types of T and of everything
+ * it contains, so it changes whenever the binary layout of T does.
+ */
+template <typename T>
+JS_NODISCARD inline uint64_t binarySchemaHash()
+{
+  static const uint64_t hash = [] {
+    Internal::BinarySchema schema;
+    BinaryHandler<T>::schema(schema);
+    return schema.hash();
+  }();
+  return hash;
+}
+
+/*!
+ * Saves from_type as a binary snapshot, for fast reloading with loadBinary. The snapshot is a header with a magic
+ * number and binarySchemaHash<T>(), followed by the values in the order of the JS_OBJ meta data, without member
+ * names. Numbers have a fixed little endian layout, and strings, arrays and maps a length in front of them.
+ *
+ * Unlike JSON, MessagePack and CBOR the snapshot is not self describing, it is only meant to be read back into the
+ * same types.
+ */
+template <typename T>
+void saveBinary(const T &from_type, std::string &out)
+{
+  Internal::BinarySnapshotWriter writer(out);
+  writer.append(Internal::binary_snapshot_magic, sizeof(Internal::binary_snapshot_magic));
+  writer.writeInteger(binarySchemaHash<T>());
+  BinaryHandler<T>::write(from_type, writer);
+  writer.finish();
+}
+
+template <typename T>
+JS_NODISCARD std::string saveBinary(const T &from_type)
+{
+  std::string out;
+  saveBinary(from_type, out);
+  return out;
+}
+
+/*!
+ * Loads a snapshot written by saveBinary into to_type. Data without the snapshot header gives Error::InvalidToken,
+ * and a snapshot of a different version of the types, where the schema hash does not match, gives
+ * Error::IllegalPropertyType. Truncated data gives Error::NeedMoreData.
+ */
+template <typename T>
+JS_NODISCARD inline Error loadBinary(const char *data, size_t size, T &to_type)
+{
+  Internal::BinarySnapshotReader reader(data, size);
+  uint64_t schema_hash;
+  Error error =
+    reader.readHeader(Internal::binary_snapshot_magic, sizeof(Internal::binary_snapshot_magic), schema_hash);
+  if (error != Error::NoError)
+    return error == Error::NeedMoreData ? Error::InvalidToken : error;
+  if (schema_hash != binarySchemaHash<T>())
+    return Error::IllegalPropertyType;
+  error = BinaryHandler<T>::read(to_type, reader);
+  if (error == Error::NoError && !reader.atEnd())
+    return Error::InvalidToken;
+  return error;
+}
+
+template <typename T>
+JS_NODISCARD inline Error loadBinary(const std::string &data, T &to_type)
+{
+  return loadBinary(data.data(), data.size(), to_type);
+}
+} // namespace JS
+#endif // JSON_STRUCT_H
+
+#if defined(JS_STL_MAP) && !defined(JS_STL_MAP_INCLUDE)
+#define JS_STL_MAP_INCLUDE
+#include <map>
+namespace JS
+{
+template <typename Key, typename Value>
+struct TypeHandler<std::map<Key, Value>> : TypeHandlerMap<Key, Value, std::map<Key, Value>>
+{
+};
+
+/// \private
+template <typename Key, typename Value>
+struct BinaryHandler<std::map<Key, Value>> : Internal::BinaryMap<std::map<Key, Value>>
+{
+};
 } // namespace JS
 #endif
 
@@ -10223,6 +17200,12 @@ template <typename Key>
 struct TypeHandler<std::set<Key>> : TypeHandlerSet<Key, std::set<Key>>
 {
 };
+
+/// \private
+template <typename Key>
+struct BinaryHandler<std::set<Key>> : Internal::BinarySet<std::set<Key>>
+{
+};
 } // namespace JS
 #endif
 
@@ -10235,6 +17218,12 @@ template <typename Key>
 struct TypeHandler<std::unordered_set<Key>> : TypeHandlerSet<Key, std::unordered_set<Key>>
 {
 };
+
+/// \private
+template <typename Key>
+struct BinaryHandler<std::unordered_set<Key>> : Internal::BinarySet<std::unordered_set<Key>>
+{
+};
 } // namespace JS
 #endif
 
@@ -10252,8 +17241,15 @@ public:
     if (context.token.value_type != Type::ArrayStart)
       return JS::Error::ExpectedArrayStart;
 
-    context.nextToken();
-    for (size_t i = 0; i < N; i++)
+    size_t i = 0;
+    if (!Internal::NumberArray<T>::parse(context, [&to_type, &i](const T &value) -> bool {
+          if (i == N)
+            return false;
+          to_type[i++] = value;
+          return true;
+        }))
+      context.nextToken();
+    for (; i < N; i++)
     {
       if (context.error != JS::Error::NoError)
         return context.error;
@@ -10275,8 +17271,11 @@ public:
     serializer.write(token);
 
     token.name = DataRef("");
-    for (size_t i = 0; i < N; i++)
-      TypeHandler<T>::from(from[i], token, serializer);
+    if (!Internal::NumberArray<T>::serialize(&from[0], N, serializer))
+    {
+      for (size_t i = 0; i < N; i++)
+        TypeHandler<T>::from(from[i], token, serializer);
+    }
 
     token.name = DataRef("");
     token.value_type = Type::ArrayEnd;
@@ -10284,6 +17283,30 @@ public:
     serializer.write(token);
   }
 };
+
+/// \private
+template <typename T, size_t N>
+struct BinaryHandler<std::array<T, N>>
+{
+  template <typename Writer>
+  static inline void write(const std::array<T, N> &from_type, Writer &writer)
+  {
+    writer.beginArray(N);
+    for (const T &value : from_type)
+      BinaryHandler<T>::write(value, writer);
+    writer.endArray();
+  }
+  template <typename Reader>
+  static inline Error read(std::array<T, N> &to_type, Reader &reader)
+  {
+    return Internal::readBinaryArray<T, N>(to_type, reader);
+  }
+  static inline void schema(Internal::BinarySchema &schema)
+  {
+    schema.add("array");
+    BinaryHandler<T>::schema(schema);
+  }
+};
 } // namespace JS
 #endif
 
@@ -10313,3 +17336,434 @@ struct TypeHandler<js_uint128_t> : TypeHandlerIntType<js_uint128_t>
 };
 } // namespace JS
 #endif
+
+#if defined(JS_STD_THREAD) && !defined(JS_STD_THREAD_INCLUDE)
+#define JS_STD_THREAD_INCLUDE
+#include <iterator>
+#include <thread>
+namespace JS
+{
+/*!
+ * Result of JS::parseBatch. errors has one entry per document, while error_strings only has
+ * entries for the documents that failed, ordered by document index.
+ */
+struct BatchParseResult
+{
+  std::vector<Error> errors;
+  std::vector<std::pair<size_t, std::string>> error_strings;
+
+  bool ok() const
+  {
+    return error_strings.empty();
+  }
+};
+
+namespace Internal
+{
+struct BatchWorkRange
+{
+  std::atomic<size_t> next;
+  size_t end;
+  char padding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+template <typename T>
+struct BatchParser
+{
+  BatchParser(const DataRef *documents, size_t count, std::vector<T> &out, BatchParseResult &result,
+              size_t workers, const ParseContext &prototype)
+    : documents(documents)
+    , out(out)
+    , result(result)
+    , prototype(prototype)
+    , ranges(new BatchWorkRange[workers])
+    , workers(workers)
+    , chunk_size(std::max(size_t(1), std::min(size_t(64), count / (workers * 16))))
+    , failures(workers)
+  {
+    size_t per_worker = count / workers;
+    size_t remainder = count % workers;
+    size_t start = 0;
+    for (size_t i = 0; i < workers; i++)
+    {
+      size_t size = per_worker + (i < remainder ? 1 : 0);
+      ranges[i].next.store(start, std::memory_order_relaxed);
+      ranges[i].end = start + size;
+      start += size;
+    }
+  }
+
+  // Claims the next chunk from the worker's own range, and steals chunks from the other ranges when it runs dry.
+  bool claim(size_t worker, size_t &begin, size_t &end)
+  {
+    for (size_t i = 0; i < workers; i++)
+    {
+      BatchWorkRange &range = ranges[(worker + i) % workers];
+      if (range.next.load(std::memory_order_relaxed) >= range.end)
+        continue;
+      begin = range.next.fetch_add(chunk_size, std::memory_order_relaxed);
+      if (begin >= range.end)
+        continue;
+      end = std::min(begin + chunk_size, range.end);
+      return true;
+    }
+    return false;
+  }
+
+  void run(size_t worker)
+  {
+    ParseContext context(prototype);
+    // The workers would share the pool, and it is not thread safe
+    context.intern_pool = nullptr;
+    std::vector<std::pair<size_t, std::string>> &worker_failures = failures[worker];
+    size_t begin;
+    size_t end;
+    while (claim(worker, begin, end))
+    {
+      for (size_t i = begin; i < end; i++)
+      {
+        context.reset(documents[i].data, documents[i].size);
+        Error error = context.parseTo(out[i]);
+        result.errors[i] = error;
+        if (JSON_STRUCT_UNLIKELY(error != Error::NoError))
+          worker_failures.push_back(std::make_pair(i, context.makeErrorString()));
+      }
+    }
+  }
+
+  const DataRef *documents;
+  std::vector<T> &out;
+  BatchParseResult &result;
+  const ParseContext &prototype;
+  std::unique_ptr<BatchWorkRange[]> ranges;
+  size_t workers;
+  size_t chunk_size;
+  std::vector<std::vector<std::pair<size_t, std::string>>> failures;
+};
+} // namespace Internal
+
+/*!
+ * Parses count independent documents into out, which is resized to count. Each worker thread reuses a
+ * single ParseContext copied from prototype, so tokenizer options and the ParseContext flags carry over
+ * to every document. A thread_count of 0 uses std::thread::hardware_concurrency(). The calling thread
+ * takes part in the work. The intern_pool of prototype is not used, since InternPool is not thread safe,
+ * so InternedString members fail with Error::IllegalDataValue.
+ */
+template <typename T>
+BatchParseResult parseBatch(const DataRef *documents, size_t count, std::vector<T> &out, unsigned thread_count,
+                            const ParseContext &prototype)
+{
+  BatchParseResult result;
+  out.clear();
+  out.resize(count);
+  result.errors.resize(count, Error::NoError);
+  if (!count)
+    return result;
+
+  if (!thread_count)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  size_t workers = std::min(size_t(thread_count), count);
+
+  Internal::BatchParser<T> parser(documents, count, out, result, workers, prototype);
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (size_t i = 1; i < workers; i++)
+    threads.emplace_back(&Internal::BatchParser<T>::run, &parser, i);
+  parser.run(0);
+  for (auto &thread : threads)
+    thread.join();
+
+  for (auto &worker_failures : parser.failures)
+  {
+    for (auto &failure : worker_failures)
+      result.error_strings.push_back(std::move(failure));
+  }
+  std::sort(result.error_strings.begin(), result.error_strings.end(),
+            [](const std::pair<size_t, std::string> &a, const std::pair<size_t, std::string> &b) {
+              return a.first < b.first;
+            });
+  return result;
+}
+
+template <typename T>
+BatchParseResult parseBatch(const DataRef *documents, size_t count, std::vector<T> &out, unsigned thread_count = 0)
+{
+  ParseContext prototype;
+  return parseBatch(documents, count, out, thread_count, prototype);
+}
+
+template <typename T>
+BatchParseResult parseBatch(const std::vector<DataRef> &documents, std::vector<T> &out, unsigned thread_count = 0)
+{
+  return parseBatch(documents.data(), documents.size(), out, thread_count);
+}
+
+template <typename T>
+BatchParseResult parseBatch(const std::vector<DataRef> &documents, std::vector<T> &out, unsigned thread_count,
+                            const ParseContext &prototype)
+{
+  return parseBatch(documents.data(), documents.size(), out, thread_count, prototype);
+}
+
+namespace Internal
+{
+template <typename T>
+struct ParallelElement
+{
+  static const bool object = false;
+  static void write(const T &value, Token &token, Serializer &serializer)
+  {
+    token.name = DataRef("");
+    TypeHandler<T>::from(value, token, serializer);
+  }
+};
+
+template <typename V>
+struct ParallelElement<std::pair<const std::string, V>>
+{
+  static const bool object = true;
+  static void write(const std::pair<const std::string, V> &value, Token &token, Serializer &serializer)
+  {
+    token.name = DataRef(value.first);
+    token.name_type = Type::String;
+    TypeHandler<V>::from(value.second, token, serializer);
+  }
+};
+
+template <typename Iterator>
+struct ParallelSerializer
+{
+  typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+  ParallelSerializer(std::vector<Iterator> &&bounds, const SerializerOptions &options)
+    : bounds(std::move(bounds))
+    , chunks(this->bounds.size() - 1)
+    , options(options)
+    , next(0)
+  {
+  }
+
+  void run()
+  {
+    for (size_t chunk = next.fetch_add(1); chunk < chunks.size(); chunk = next.fetch_add(1))
+    {
+      SerializerContext context(chunks[chunk], options);
+      Token token;
+      for (Iterator it = bounds[chunk]; it != bounds[chunk + 1]; ++it)
+        ParallelElement<Value>::write(*it, token, context.serializer);
+      context.flush();
+    }
+  }
+
+  std::vector<Iterator> bounds;
+  std::vector<std::string> chunks;
+  const SerializerOptions &options;
+  std::atomic<size_t> next;
+};
+} // namespace Internal
+
+/*!
+ * Serializes a large container, a std::vector or another array like container, or a map with std::string keys, with
+ * thread_count threads and returns the same JSON as serializeStruct. The elements are split into ranges that are
+ * serialized into their own buffers, starting at the depth of the elements, and the buffers are then joined with the
+ * delimiters in between. A thread_count of 0 uses std::thread::hardware_concurrency(). The calling thread takes part
+ * in the work.
+ */
+template <typename Container>
+std::string serializeParallel(const Container &container, const SerializerOptions &options = SerializerOptions(),
+                              unsigned thread_count = 0)
+{
+  typedef typename Container::const_iterator Iterator;
+  typedef Internal::ParallelElement<typename std::iterator_traits<Iterator>::value_type> Element;
+  const size_t count = size_t(std::distance(container.begin(), container.end()));
+  if (!thread_count)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  // A few chunks per thread evens out elements of different size, and small chunks are not worth a buffer each
+  const size_t min_chunk_size = 64;
+  const size_t chunk_count = std::min(size_t(thread_count) * 4, count / min_chunk_size);
+  if (thread_count == 1 || chunk_count < 2)
+    return serializeStruct(container, options);
+
+  std::vector<Iterator> bounds;
+  bounds.reserve(chunk_count + 1);
+  Iterator it = container.begin();
+  for (size_t chunk = 0; chunk < chunk_count; chunk++)
+  {
+    bounds.push_back(it);
+    std::advance(it, count / chunk_count + (chunk < count % chunk_count ? 1 : 0));
+  }
+  bounds.push_back(it);
+
+  SerializerOptions chunk_options = options;
+  chunk_options.setDepth(options.depth() + 1);
+  Internal::ParallelSerializer<Iterator> parallel(std::move(bounds), chunk_options);
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(size_t(thread_count), chunk_count);
+  threads.reserve(workers - 1);
+  for (size_t i = 1; i < workers; i++)
+    threads.emplace_back(&Internal::ParallelSerializer<Iterator>::run, &parallel);
+  parallel.run();
+  for (auto &thread : threads)
+    thread.join();
+
+  size_t size = 0;
+  for (auto &chunk : parallel.chunks)
+    size += chunk.size() + 2 + options.postfix().size();
+  std::string ret_string;
+  ret_string.reserve(size + 64);
+  SerializerContext context(ret_string, options);
+  Token token;
+  token.value_type = Element::object ? Type::ObjectStart : Type::ArrayStart;
+  token.value = Element::object ? DataRef("{") : DataRef("[");
+  context.serializer.write(token);
+  // A chunk starts with the indentation of its first element, so it still needs what goes before that
+  const std::string delimiter =
+    (options.tokenDelimiter().empty() ? std::string() : std::string(",")) + options.postfix();
+  for (size_t chunk = 0; chunk < parallel.chunks.size(); chunk++)
+  {
+    if (chunk)
+      context.serializer.write(delimiter.data(), delimiter.size());
+    else
+      context.serializer.write(options.postfix().data(), options.postfix().size());
+    context.serializer.write(parallel.chunks[chunk].data(), parallel.chunks[chunk].size());
+    std::string().swap(parallel.chunks[chunk]);
+  }
+  token.value_type = Element::object ? Type::ObjectEnd : Type::ArrayEnd;
+  token.value = Element::object ? DataRef("}") : DataRef("]");
+  context.serializer.write(token);
+  context.flush();
+  return ret_string;
+}
+} // namespace JS
+#endif
+
+#if defined(JS_POSIX_SINKS) && !defined(JS_POSIX_SINKS_INCLUDE)
+#define JS_POSIX_SINKS_INCLUDE
+#include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
+namespace JS
+{
+/*!
+ * Writes to a file descriptor with write(2) every time its buffer fills up. Short writes and EINTR are retried.
+ */
+class FdSink : public OutputSink
+{
+public:
+  explicit FdSink(int fd, size_t buffer_size = 64 * 1024)
+    : m_fd(fd)
+    , m_buffer(new char[std::max(buffer_size, size_t(1))])
+    , m_buffer_size(std::max(buffer_size, size_t(1)))
+    , m_written(0)
+  {
+  }
+
+  size_t written() const
+  {
+    return m_written;
+  }
+
+protected:
+  SerializerBuffer nextBuffer() override;
+  bool commit(const char *data, size_t size) override;
+
+private:
+  int m_fd;
+  std::unique_ptr<char[]> m_buffer;
+  size_t m_buffer_size;
+  size_t m_written;
+};
+
+/*!
+ * Writes into a caller owned iovec list, filling the buffers in order, for example the free buffers of a network
+ * stack. The sink fails when the output does not fit in the list. usedCount() and lastUsed() tell how much of the list
+ * holds output.
+ */
+class IovecSink : public OutputSink
+{
+public:
+  IovecSink(const struct iovec *iov, size_t count)
+    : m_iov(iov)
+    , m_count(count)
+    , m_next(0)
+    , m_current_used(0)
+    , m_used_count(0)
+    , m_last_used(0)
+    , m_size(0)
+  {
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+  // The number of iovecs up to and including the last one that holds output.
+  size_t usedCount() const
+  {
+    return m_used_count;
+  }
+  // The bytes of output in the last iovec that holds output. The ones before it are full.
+  size_t lastUsed() const
+  {
+    return m_last_used;
+  }
+
+protected:
+  SerializerBuffer nextBuffer() override;
+  bool commit(const char *data, size_t size) override;
+
+private:
+  const struct iovec *m_iov;
+  size_t m_count;
+  size_t m_next;
+  size_t m_current_used;
+  size_t m_used_count;
+  size_t m_last_used;
+  size_t m_size;
+};
+
+inline SerializerBuffer FdSink::nextBuffer()
+{
+  return SerializerBuffer(m_buffer.get(), m_buffer_size);
+}
+
+inline bool FdSink::commit(const char *data, size_t size)
+{
+  while (size)
+  {
+    ssize_t written = ::write(m_fd, data, size);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += written;
+    size -= size_t(written);
+    m_written += size_t(written);
+  }
+  return true;
+}
+
+inline SerializerBuffer IovecSink::nextBuffer()
+{
+  while (m_next < m_count && m_iov[m_next].iov_len == 0)
+    m_next++;
+  if (m_next == m_count)
+    return SerializerBuffer();
+  m_current_used = 0;
+  const struct iovec &iov = m_iov[m_next++];
+  return SerializerBuffer(static_cast<char *>(iov.iov_base), iov.iov_len);
+}
+
+inline bool IovecSink::commit(const char *data, size_t size)
+{
+  JS_UNUSED(data);
+  m_current_used += size;
+  m_size += size;
+  m_used_count = m_next;
+  m_last_used = m_current_used;
+  return true;
+}
+} // namespace JS
+#endif
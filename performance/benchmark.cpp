@@ -2,6 +2,9 @@
 #include "generated.json.h"
 #include <json_struct/json_struct.h>
 #include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
 
 #include "catch2/catch_all.hpp"
 
@@ -432,3 +435,991 @@ TEST_CASE("Benchmarks", "[performance]")
 
 }
 
+
+namespace
+{
+enum class FloatCorpus
+{
+  Geo,
+  Telemetry,
+  RandomBits
+};
+
+std::string makeFloatCorpus(FloatCorpus kind, size_t count)
+{
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::string json = "[";
+  char buffer[64];
+  for (size_t i = 0; i < count; i++)
+  {
+    double value = 0.0;
+    const char *format = "%.17g";
+    switch (kind)
+    {
+    case FloatCorpus::Geo:
+      value = (i % 2 ? 360.0 : 180.0) * unit(rng) - (i % 2 ? 180.0 : 90.0);
+      format = "%.7f";
+      break;
+    case FloatCorpus::Telemetry:
+      value = (unit(rng) - 0.5) * std::pow(10.0, double(int(rng() % 40) - 20));
+      format = "%.15e";
+      break;
+    case FloatCorpus::RandomBits:
+      do
+      {
+        uint64_t bits = rng();
+        memcpy(&value, &bits, sizeof(value));
+      } while (!std::isfinite(value));
+      break;
+    }
+    snprintf(buffer, sizeof(buffer), format, value);
+    if (i)
+      json += ',';
+    json += buffer;
+  }
+  json += "]";
+  return json;
+}
+} // namespace
+
+TEST_CASE("Benchmarks_Float", "[performance]")
+{
+  const std::string geo = makeFloatCorpus(FloatCorpus::Geo, 100000);
+  const std::string telemetry = makeFloatCorpus(FloatCorpus::Telemetry, 100000);
+  const std::string random_bits = makeFloatCorpus(FloatCorpus::RandomBits, 100000);
+
+  BENCHMARK("JsonStruct_Double_Geo")
+  {
+    std::vector<double> values;
+    JS::ParseContext context(geo);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("JsonStruct_Float_Geo")
+  {
+    std::vector<float> values;
+    JS::ParseContext context(geo);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("RapidJson_Double_Geo")
+  {
+    rapidjson::Document d;
+    d.Parse(geo.data(), geo.size());
+    return d.Size();
+  };
+
+  BENCHMARK("JsonStruct_Double_Telemetry")
+  {
+    std::vector<double> values;
+    JS::ParseContext context(telemetry);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("JsonStruct_Float_Telemetry")
+  {
+    std::vector<float> values;
+    JS::ParseContext context(telemetry);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("RapidJson_Double_Telemetry")
+  {
+    rapidjson::Document d;
+    d.Parse(telemetry.data(), telemetry.size());
+    return d.Size();
+  };
+
+  BENCHMARK("JsonStruct_Double_RandomBits")
+  {
+    std::vector<double> values;
+    JS::ParseContext context(random_bits);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("JsonStruct_Float_RandomBits")
+  {
+    std::vector<float> values;
+    JS::ParseContext context(random_bits);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("RapidJson_Double_RandomBits")
+  {
+    rapidjson::Document d;
+    d.Parse(random_bits.data(), random_bits.size());
+    return d.Size();
+  };
+
+  std::vector<double> geo_values;
+  JS::ParseContext geo_context(geo);
+  if (geo_context.parseTo(geo_values) != JS::Error::NoError)
+    fprintf(stderr, "Failed to parse document\n");
+
+  BENCHMARK("JsonStruct_Serialize_Double_Shortest")
+  {
+    return JS::serializeStruct(geo_values, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Double_FixedDecimals6")
+  {
+    JS::SerializerOptions options(JS::SerializerOptions::Compact);
+    options.setFloatFormat(JS::FloatFormat::FixedDecimals, 6);
+    return JS::serializeStruct(geo_values, options);
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Double_SignificantDigits6")
+  {
+    JS::SerializerOptions options(JS::SerializerOptions::Compact);
+    options.setFloatFormat(JS::FloatFormat::SignificantDigits, 6);
+    return JS::serializeStruct(geo_values, options);
+  };
+}
+
+#if defined(__SIZEOF_INT128__)
+#define JS_INT_128
+#include <json_struct/json_struct.h>
+#endif
+
+namespace
+{
+template <typename T>
+std::vector<T> makeIntegerCorpus(size_t count)
+{
+  std::mt19937_64 rng(42);
+  std::vector<T> values;
+  values.reserve(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    // Spread over every digit count so the length dispatch is exercised, not just the longest numbers.
+    int digits = 1 + int(rng() % uint64_t(std::numeric_limits<T>::digits10));
+    T value = 0;
+    for (int d = 0; d < digits; d++)
+      value = T(value * 10 + T(rng() % 10));
+    values.push_back(i % 3 == 0 ? T(-value) : value);
+  }
+  return values;
+}
+} // namespace
+
+TEST_CASE("Benchmarks_Integer", "[performance]")
+{
+  const std::vector<int32_t> int32_values = makeIntegerCorpus<int32_t>(100000);
+  const std::vector<int64_t> int64_values = makeIntegerCorpus<int64_t>(100000);
+  const std::string int64_json = JS::serializeStruct(int64_values);
+
+  BENCHMARK("JsonStruct_Serialize_Int32")
+  {
+    return JS::serializeStruct(int32_values);
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Int64")
+  {
+    return JS::serializeStruct(int64_values);
+  };
+
+  BENCHMARK("JsonStruct_ToBuffer_Int64")
+  {
+    char buffer[24];
+    int total = 0;
+    for (int64_t value : int64_values)
+      total += JS::Internal::ft::integer::to_buffer(value, buffer, int(sizeof(buffer)));
+    return total;
+  };
+
+  BENCHMARK("JsonStruct_Parse_Int64")
+  {
+    std::vector<int64_t> values;
+    JS::ParseContext context(int64_json);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("RapidJson_Parse_Int64")
+  {
+    rapidjson::Document d;
+    d.Parse(int64_json.data(), int64_json.size());
+    return d.Size();
+  };
+
+#if defined(__SIZEOF_INT128__)
+  const std::vector<JS::js_int128_t> int128_values = makeIntegerCorpus<JS::js_int128_t>(100000);
+  BENCHMARK("JsonStruct_Serialize_Int128")
+  {
+    return JS::serializeStruct(int128_values);
+  };
+#endif
+}
+
+TEST_CASE("Benchmarks_NumericArray", "[performance]")
+{
+  // Large flat arrays, where the bulk array path replaces one token per element.
+  const std::vector<int64_t> int64_values = makeIntegerCorpus<int64_t>(1000000);
+  std::vector<double> double_values;
+  double_values.reserve(int64_values.size());
+  for (int64_t value : int64_values)
+    double_values.push_back(double(value % 100000000) / 1000.0);
+  const JS::SerializerOptions compact(JS::SerializerOptions::Compact);
+  const std::string int64_json = JS::serializeStruct(int64_values, compact);
+  const std::string double_json = JS::serializeStruct(double_values, compact);
+
+  BENCHMARK("JsonStruct_Parse_Vector_Int64")
+  {
+    std::vector<int64_t> values;
+    JS::ParseContext context(int64_json);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("JsonStruct_Parse_Vector_Double")
+  {
+    std::vector<double> values;
+    JS::ParseContext context(double_json);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("RapidJson_Parse_Vector_Double")
+  {
+    rapidjson::Document d;
+    d.Parse(double_json.data(), double_json.size());
+    return d.Size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Vector_Int64")
+  {
+    return JS::serializeStruct(int64_values, compact);
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Vector_Double")
+  {
+    return JS::serializeStruct(double_values, compact);
+  };
+}
+
+TEST_CASE("Benchmarks_Base64", "[performance]")
+{
+  // A thumbnail sized blob, as base64 and as the array of numbers a std::vector<uint8_t> turns into.
+  std::mt19937 rng(42);
+  JS::Base64Bytes blob;
+  blob.data.resize(1 << 20);
+  for (auto &byte : blob.data)
+    byte = uint8_t(rng());
+  const JS::SerializerOptions compact(JS::SerializerOptions::Compact);
+  const std::string base64_json = JS::serializeStruct(blob, compact);
+  const std::string array_json = JS::serializeStruct(blob.data, compact);
+
+  BENCHMARK("JsonStruct_Serialize_Base64")
+  {
+    return JS::serializeStruct(blob, compact);
+  };
+
+  BENCHMARK("JsonStruct_Parse_Base64")
+  {
+    JS::Base64Bytes parsed;
+    JS::ParseContext context(base64_json);
+    if (context.parseTo(parsed) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return parsed.data.size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_ByteArray")
+  {
+    return JS::serializeStruct(blob.data, compact);
+  };
+
+  BENCHMARK("JsonStruct_Parse_ByteArray")
+  {
+    std::vector<uint8_t> parsed;
+    JS::ParseContext context(array_json);
+    if (context.parseTo(parsed) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return parsed.size();
+  };
+}
+
+JS_ENUM(CountryCode,
+        AD, AE, AF, AG, AI, AL, AM, AO, AQ, AR, AS, AT, AU, AW, AX, AZ, BA, BB, BD, BE, BF, BG, BH, BI, BJ, BL, BM,
+        BN, BO, BQ, BR, BS, BT, BV, BW, BY, BZ, CA, CC, CD, CF, CG, CH, CI, CK, CL, CM, CN, CO, CR, CU, CV, CW, CX,
+        CY, CZ, DE, DJ, DK, DM, DO, DZ, EC, EE, EG, EH, ER, ES, ET, FI, FJ, FK, FM, FO, FR, GA, GB, GD, GE, GF, GG,
+        GH, GI, GL, GM, GN, GP, GQ, GR, GS, GT, GU, GW, GY, HK, HM, HN, HR, HT, HU, ID, IE, IL, IM, IN, IO, IQ, IR,
+        IS, IT, JE, JM, JO, JP, KE, KG, KH, KI, KM, KN, KP, KR, KW, KY, KZ, LA, LB, LC, LI, LK, LR, LS, LT, LU, LV,
+        LY, MA, MC, MD, ME, MF, MG, MH, MK, ML, MM, MN, MO, MP, MQ, MR, MS, MT, MU, MV, MW, MX, MY, MZ, NA, NC, NE,
+        NF, NG, NI, NL, NO, NP, NR, NU, NZ, OM, PA, PE, PF, PG, PH, PK, PL, PM, PN, PR, PS, PT, PW, PY, QA, RE, RO,
+        RS, RU, RW, SA, SB, SC, SD, SE, SG, SH, SI, SJ, SK, SL, SM, SN, SO, SR, SS, ST, SV, SX, SY, SZ, TC, TD, TF,
+        TG, TH, TJ, TK, TL, TM, TN, TO, TR, TT, TV, TW, TZ, UA, UG, UM, US, UY, UZ, VA, VC, VE, VG, VI, VN, VU, WF,
+        WS, YE, YT, ZA, ZM, ZW)
+JS_ENUM_DECLARE_STRING_PARSER(CountryCode)
+
+TEST_CASE("Benchmarks_Enum", "[performance]")
+{
+  // A country code per element: 249 names of the same length, where a linear name scan is at its worst.
+  std::mt19937 rng(42);
+  std::vector<CountryCode> codes;
+  for (int i = 0; i < 100000; i++)
+    codes.push_back(static_cast<CountryCode>(rng() % 249));
+  const JS::SerializerOptions compact(JS::SerializerOptions::Compact);
+  const std::string json = JS::serializeStruct(codes, compact);
+
+  BENCHMARK("JsonStruct_Parse_Enum_CountryCode")
+  {
+    std::vector<CountryCode> values;
+    JS::ParseContext context(json);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values;
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Enum_CountryCode")
+  {
+    return JS::serializeStruct(codes, compact);
+  };
+}
+
+TEST_CASE("Benchmarks_Map", "[performance]")
+{
+  // An attribute bag with thousands of short string entries.
+  std::string json = "{";
+  for (int i = 0; i < 5000; i++)
+    json += std::string(i ? "," : "") + "\"com.example.attribute." + std::to_string(i) + "\":\"value-" +
+            std::to_string(i * 7) + "\"";
+  json += "}";
+
+  BENCHMARK("JsonStruct_Parse_UnorderedMap_String")
+  {
+    std::unordered_map<std::string, std::string> values;
+    JS::ParseContext context(json);
+    if (context.parseTo(values) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return values.size();
+  };
+
+  BENCHMARK("RapidJson_Parse_UnorderedMap_String")
+  {
+    rapidjson::Document d;
+    d.Parse(json.data(), json.size());
+    return d.MemberCount();
+  };
+}
+
+namespace
+{
+struct RecordStrings
+{
+  int index = 0;
+  std::string eyeColor;
+  std::string gender;
+  std::string favoriteFruit;
+  JS_OBJ(index, eyeColor, gender, favoriteFruit);
+};
+
+struct RecordInterned
+{
+  int index = 0;
+  JS::InternedString eyeColor;
+  JS::InternedString gender;
+  JS::InternedString favoriteFruit;
+  JS_OBJ(index, eyeColor, gender, favoriteFruit);
+};
+} // namespace
+
+TEST_CASE("Benchmarks_Intern", "[performance]")
+{
+  // Low cardinality fields, as in generated.json.h, where every record repeats one of a few values.
+  const char *eye_colors[] = {"brown", "blue", "green"};
+  const char *genders[] = {"female", "male"};
+  const char *fruits[] = {"strawberry_with_cream", "banana_from_ecuador", "granny_smith_apple"};
+  std::string json = "[";
+  for (int i = 0; i < 100000; i++)
+  {
+    json += std::string(i ? "," : "") + "{\"index\":" + std::to_string(i) + ",\"eyeColor\":\"" + eye_colors[i % 3] +
+            "\",\"gender\":\"" + genders[i % 2] + "\",\"favoriteFruit\":\"" + fruits[(i / 3) % 3] + "\"}";
+  }
+  json += "]";
+
+  BENCHMARK("JsonStruct_Parse_Records_String")
+  {
+    std::vector<RecordStrings> records;
+    JS::ParseContext context(json);
+    if (context.parseTo(records) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return records.size();
+  };
+
+  BENCHMARK("JsonStruct_Parse_Records_Interned")
+  {
+    JS::InternPool pool;
+    std::vector<RecordInterned> records;
+    JS::ParseContext context(json);
+    context.intern_pool = &pool;
+    if (context.parseTo(records) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return records.size();
+  };
+}
+
+namespace
+{
+struct FriendsCompact
+{
+  int id;
+  JS::CompactString name;
+  JS_OBJ(id, name);
+};
+
+struct JPersonCompact
+{
+  JS::CompactString _id;
+  int index;
+  JS::CompactString guid;
+  bool isActive;
+  JS::CompactString balance;
+  JS::CompactString picture;
+  int age;
+  JS::CompactString eyeColor;
+  JS::CompactString name;
+  JS::CompactString gender;
+  JS::CompactString company;
+  JS::CompactString email;
+  JS::CompactString phone;
+  JS::CompactString address;
+  JS::CompactString about;
+  JS::CompactString registered;
+  float latitude;
+  float longitude;
+  std::vector<JS::CompactString> tags;
+  std::vector<FriendsCompact> friends;
+  JS::CompactString greeting;
+  JS::CompactString favoriteFruit;
+  JS_OBJ(_id, index, guid, isActive, balance, picture, age, eyeColor, name, gender, company, email, phone, address,
+         about, registered, latitude, longitude, tags, friends, greeting, favoriteFruit);
+};
+} // namespace
+
+TEST_CASE("Benchmarks_CompactString", "[performance]")
+{
+  BENCHMARK("JsonStruct_Parse_JPerson_String")
+  {
+    JS::ParseContext context(generatedJsonArray, sizeof(generatedJsonArray) - 1);
+    std::vector<JPerson> people;
+    if (context.parseTo(people) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return people.size();
+  };
+
+  BENCHMARK("JsonStruct_Parse_JPerson_CompactString")
+  {
+    JS::ParseContext context(generatedJsonArray, sizeof(generatedJsonArray) - 1);
+    std::vector<JPersonCompact> people;
+    if (context.parseTo(people) != JS::Error::NoError)
+      fprintf(stderr, "Failed to parse document\n");
+    return people.size();
+  };
+
+  std::vector<JPerson> people;
+  std::vector<JPersonCompact> compact_people;
+  JS::ParseContext string_context(generatedJsonArray, sizeof(generatedJsonArray) - 1);
+  JS::ParseContext compact_context(generatedJsonArray, sizeof(generatedJsonArray) - 1);
+  if (string_context.parseTo(people) != JS::Error::NoError ||
+      compact_context.parseTo(compact_people) != JS::Error::NoError)
+    fprintf(stderr, "Failed to parse document\n");
+
+  BENCHMARK("JsonStruct_Serialize_JPerson_String")
+  {
+    return JS::serializeStruct(people).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_JPerson_CompactString")
+  {
+    return JS::serializeStruct(compact_people).size();
+  };
+}
+
+TEST_CASE("Benchmarks_CompactSerialize", "[performance]")
+{
+  std::vector<JPerson> people;
+  JS::ParseContext context(generatedJsonArray, sizeof(generatedJsonArray) - 1);
+  if (context.parseTo(people) != JS::Error::NoError)
+    fprintf(stderr, "Failed to parse document\n");
+  std::vector<std::vector<JPerson>> batches(50, people);
+
+  BENCHMARK("JsonStruct_Serialize_JPerson_Compact")
+  {
+    return JS::serializeStruct(batches, JS::SerializerOptions(JS::SerializerOptions::Compact)).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_JPerson_Pretty")
+  {
+    return JS::serializeStruct(batches).size();
+  };
+}
+
+namespace
+{
+struct WideRecord
+{
+  int id = 1;
+  int parent_id = 2;
+  int revision = 3;
+  bool active = true;
+  bool deleted = false;
+  int created_at = 1700000000;
+  int updated_at = 1700000001;
+  int owner = 4;
+  int group = 5;
+  int permissions = 644;
+  int size_in_bytes = 4096;
+  int block_count = 8;
+  int link_count = 1;
+  bool is_directory = false;
+  bool is_symlink = false;
+  int checksum_crc32 = 12345678;
+  JS_OBJ(id, parent_id, revision, active, deleted, created_at, updated_at, owner, group, permissions, size_in_bytes,
+         block_count, link_count, is_directory, is_symlink, checksum_crc32);
+};
+} // namespace
+
+TEST_CASE("Benchmarks_MemberKeys", "[performance]")
+{
+  std::vector<WideRecord> records(20000);
+
+  BENCHMARK("JsonStruct_Serialize_WideRecord_Compact")
+  {
+    return JS::serializeStruct(records, JS::SerializerOptions(JS::SerializerOptions::Compact)).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_WideRecord_Pretty")
+  {
+    return JS::serializeStruct(records).size();
+  };
+}
+
+TEST_CASE("Benchmarks_SerializedSize", "[performance]")
+{
+  std::vector<JPerson> people;
+  JS::ParseContext context(generatedJsonArray, sizeof(generatedJsonArray) - 1);
+  if (context.parseTo(people) != JS::Error::NoError)
+    fprintf(stderr, "Failed to parse document\n");
+  std::vector<std::vector<JPerson>> batches(2000, people);
+  JS::SerializerOptions options(JS::SerializerOptions::Compact);
+
+  BENCHMARK("JsonStruct_Serialize_Large_Growing")
+  {
+    return JS::serializeStruct(batches, options).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Large_ExactSize")
+  {
+    std::string json(JS::serializedSize(batches, options), '\0');
+    return JS::serializeTo(batches, &json[0], json.size(), options);
+  };
+}
+
+TEST_CASE("Benchmarks_OutputSink", "[performance]")
+{
+  std::vector<JPerson> people;
+  JS::ParseContext context(generatedJsonArray, sizeof(generatedJsonArray) - 1);
+  if (context.parseTo(people) != JS::Error::NoError)
+    fprintf(stderr, "Failed to parse document\n");
+  std::vector<std::vector<JPerson>> batches(2000, people);
+  JS::SerializerOptions options(JS::SerializerOptions::Compact);
+
+  BENCHMARK("JsonStruct_Serialize_Large_String")
+  {
+    return JS::serializeStruct(batches, options).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Large_BufferSink")
+  {
+    JS::BufferSink sink;
+    JS::Serializer serializer;
+    serializer.setOptions(options);
+    sink.attach(serializer);
+    JS::Token token;
+    JS::TypeHandler<std::vector<std::vector<JPerson>>>::from(batches, token, serializer);
+    sink.finish(serializer);
+    return sink.size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Large_SegmentedSink")
+  {
+    JS::SegmentedSink sink;
+    JS::Serializer serializer;
+    serializer.setOptions(options);
+    sink.attach(serializer);
+    JS::Token token;
+    JS::TypeHandler<std::vector<std::vector<JPerson>>>::from(batches, token, serializer);
+    sink.finish(serializer);
+    return sink.size();
+  };
+}
+
+namespace
+{
+struct ExportRow
+{
+  int id = 0;
+  std::string label;
+  double value = 0;
+  JS_OBJ(id, label, value);
+};
+
+bool nextExportRow(int &next, int count, ExportRow &row)
+{
+  if (next == count)
+    return false;
+  row.id = next;
+  row.label = "export row number " + std::to_string(next);
+  row.value = next * 0.5;
+  next++;
+  return true;
+}
+} // namespace
+
+TEST_CASE("Benchmarks_StreamSerializer", "[performance]")
+{
+  const int count = 200000;
+  FILE *null_file = fopen("/dev/null", "wb");
+  if (!null_file)
+    return;
+
+  BENCHMARK("JsonStruct_Export_Vector")
+  {
+    std::vector<ExportRow> rows;
+    ExportRow row;
+    int next = 0;
+    while (nextExportRow(next, count, row))
+      rows.push_back(row);
+    std::string json = JS::serializeStruct(rows, JS::SerializerOptions(JS::SerializerOptions::Compact));
+    return fwrite(json.data(), 1, json.size(), null_file);
+  };
+
+  BENCHMARK("JsonStruct_Export_Stream")
+  {
+    JS::FileSink sink(null_file);
+    JS::StreamSerializer stream(sink, JS::SerializerOptions(JS::SerializerOptions::Compact));
+    int next = 0;
+    stream.writeArrayFrom<ExportRow>([&](ExportRow &row) { return nextExportRow(next, count, row); });
+    return stream.finish();
+  };
+  fclose(null_file);
+}
+
+namespace
+{
+struct LogRecord
+{
+  int64_t timestamp = 0;
+  std::string message;
+  std::string source;
+  JS_OBJ(timestamp, message, source);
+};
+} // namespace
+
+TEST_CASE("Benchmarks_EscapeOut", "[performance]")
+{
+  std::vector<LogRecord> records(20000);
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    records[i].timestamp = int64_t(1700000000000 + i);
+    records[i].message = "request \"GET /api/items/" + std::to_string(i) +
+                         "\" failed:\n\tstatus=503\n\tbody={\"error\":\"upstream timeout\"}\n";
+    records[i].source = "C:\\services\\gateway\\worker-" + std::to_string(i % 16) + ".log";
+  }
+
+  BENCHMARK("JsonStruct_Serialize_Escaped_Logs")
+  {
+    return JS::serializeStruct(records, JS::SerializerOptions(JS::SerializerOptions::Compact)).size();
+  };
+}
+
+TEST_CASE("Benchmarks_EscapeNonAscii", "[performance]")
+{
+  std::vector<LogRecord> records(20000);
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    records[i].timestamp = int64_t(1700000000000 + i);
+    records[i].message = "Benutzer " + std::to_string(i) +
+                         " hat die Bestellung aufgegeben, Lieferung nach M\xc3\xbcnchen, Betrag 42 \xe2\x82\xac";
+    records[i].source = "shop-frontend-" + std::to_string(i % 16);
+  }
+  JS::SerializerOptions options(JS::SerializerOptions::Compact);
+  JS::SerializerOptions ascii_options(JS::SerializerOptions::Compact);
+  ascii_options.setEscapeNonAscii(true);
+
+  BENCHMARK("JsonStruct_Serialize_Utf8")
+  {
+    return JS::serializeStruct(records, options).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Ascii_Only")
+  {
+    return JS::serializeStruct(records, ascii_options).size();
+  };
+}
+
+#define JS_STD_THREAD
+#include <json_struct/json_struct.h>
+
+TEST_CASE("Benchmarks_SerializeParallel", "[performance]")
+{
+  std::vector<LogRecord> records(200000);
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    records[i].timestamp = int64_t(1700000000000 + i);
+    records[i].message = "export record " + std::to_string(i) + " with a payload of moderate length";
+    records[i].source = "exporter-" + std::to_string(i % 32);
+  }
+  JS::SerializerOptions options(JS::SerializerOptions::Compact);
+
+  BENCHMARK("JsonStruct_Serialize_Vector")
+  {
+    return JS::serializeStruct(records, options).size();
+  };
+
+  BENCHMARK("JsonStruct_SerializeParallel_Vector")
+  {
+    return JS::serializeParallel(records, options).size();
+  };
+}
+
+namespace
+{
+struct TrackedUnit
+{
+  JS::Tracked<double> x, y, z, heading, speed, fuel, armor, ammo;
+  JS::Tracked<int> health, shield, kills, deaths, score, level, team, state;
+  JS::Tracked<std::string> name, callsign, squad, target;
+  JS_OBJ(x, y, z, heading, speed, fuel, armor, ammo, health, shield, kills, deaths, score, level, team, state, name,
+         callsign, squad, target);
+};
+
+struct TrackedWorld
+{
+  TrackedUnit u0, u1, u2, u3, u4, u5, u6, u7, u8, u9;
+  JS::Tracked<int64_t> tick;
+  JS_OBJ(u0, u1, u2, u3, u4, u5, u6, u7, u8, u9, tick);
+};
+} // namespace
+
+TEST_CASE("Benchmarks_Delta", "[performance]")
+{
+  TrackedWorld world;
+  TrackedUnit *units[] = {&world.u0, &world.u1, &world.u2, &world.u3, &world.u4,
+                          &world.u5, &world.u6, &world.u7, &world.u8, &world.u9};
+  for (int i = 0; i < 10; i++)
+  {
+    units[i]->name = "unit " + std::to_string(i);
+    units[i]->callsign = "alpha-" + std::to_string(i);
+    units[i]->health = 100;
+  }
+  JS::clearDirty(world);
+  JS::SerializerOptions options(JS::SerializerOptions::Compact);
+  int64_t tick = 0;
+
+  BENCHMARK("JsonStruct_Serialize_Full_State")
+  {
+    world.tick = ++tick;
+    units[tick % 10]->x = double(tick);
+    return JS::serializeStruct(world, options).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Delta")
+  {
+    world.tick = ++tick;
+    units[tick % 10]->x = double(tick);
+    size_t size = JS::serializeDelta(world, options).size();
+    JS::clearDirty(world);
+    return size;
+  };
+}
+
+TEST_CASE("Benchmarks_Reformat", "[performance]")
+{
+  std::vector<LogRecord> records(50000);
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    records[i].timestamp = int64_t(1700000000000 + i);
+    records[i].message = "request " + std::to_string(i) + " completed with status \\\"ok\\\" after a short while";
+    records[i].source = "gateway-" + std::to_string(i % 16);
+  }
+  const std::string pretty = JS::serializeStruct(records);
+  const std::string compact = JS::serializeStruct(records, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  std::string out;
+
+  BENCHMARK("JsonStruct_Reformat_Minify")
+  {
+    JS::reformat(pretty, out, JS::SerializerOptions(JS::SerializerOptions::Compact));
+    return out.size();
+  };
+
+  BENCHMARK("JsonStruct_Reformat_Prettify")
+  {
+    JS::reformat(compact, out);
+    return out.size();
+  };
+}
+
+namespace
+{
+struct Telemetry
+{
+  int64_t timestamp = 0;
+  uint32_t sensor = 0;
+  double temperature = 0;
+  double pressure = 0;
+  float humidity = 0;
+  std::vector<int32_t> samples;
+  std::string unit;
+  JS_OBJ(timestamp, sensor, temperature, pressure, humidity, samples, unit);
+};
+} // namespace
+
+TEST_CASE("Benchmarks_Msgpack", "[performance]")
+{
+  std::vector<Telemetry> records(20000);
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    records[i].timestamp = int64_t(1700000000000 + i);
+    records[i].sensor = uint32_t(i % 512);
+    records[i].temperature = 20.0 + double(i % 100) / 7.0;
+    records[i].pressure = 101325.0 - double(i % 1000) * 0.37;
+    records[i].humidity = float(i % 100) / 3.0f;
+    records[i].samples = {int32_t(i), -int32_t(i % 300), 70000, 12};
+    records[i].unit = "celsius";
+  }
+  const JS::SerializerOptions compact(JS::SerializerOptions::Compact);
+  const std::string json = JS::serializeStruct(records, compact);
+  const std::string msgpack = JS::serializeMsgpack(records);
+  const std::string msgpack_indices = JS::serializeMsgpack(records, JS::KeyStyle::Indices);
+
+  BENCHMARK("JsonStruct_Serialize_Json")
+  {
+    return JS::serializeStruct(records, compact).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Msgpack")
+  {
+    return JS::serializeMsgpack(records).size();
+  };
+
+  BENCHMARK("JsonStruct_Parse_Json")
+  {
+    std::vector<Telemetry> parsed;
+    JS::ParseContext context(json);
+    JS::Error error = context.parseTo(parsed);
+    return error == JS::Error::NoError ? parsed.size() : 0;
+  };
+
+  BENCHMARK("JsonStruct_Parse_Msgpack")
+  {
+    std::vector<Telemetry> parsed;
+    JS::Error error = JS::parseMsgpack(msgpack, parsed);
+    return error == JS::Error::NoError ? parsed.size() : 0;
+  };
+
+  BENCHMARK("JsonStruct_Parse_Msgpack_Indices")
+  {
+    std::vector<Telemetry> parsed;
+    JS::Error error = JS::parseMsgpack(msgpack_indices, parsed);
+    return error == JS::Error::NoError ? parsed.size() : 0;
+  };
+}
+
+TEST_CASE("Benchmarks_Cbor", "[performance]")
+{
+  std::vector<Telemetry> records(20000);
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    records[i].timestamp = int64_t(1700000000000 + i);
+    records[i].sensor = uint32_t(i % 512);
+    records[i].temperature = 20.0 + double(i % 100) / 7.0;
+    records[i].pressure = 101325.0 - double(i % 1000) * 0.37;
+    records[i].humidity = float(i % 100) / 3.0f;
+    records[i].samples = {int32_t(i), -int32_t(i % 300), 70000, 12};
+    records[i].unit = "celsius";
+  }
+  JS::CborOptions deterministic;
+  deterministic.setDeterministic(true);
+  JS::CborOptions indefinite;
+  indefinite.setIndefiniteLengths(true);
+  const std::string cbor = JS::serializeCbor(records);
+  const std::string cbor_indefinite = JS::serializeCbor(records, indefinite);
+
+  BENCHMARK("JsonStruct_Serialize_Cbor")
+  {
+    return JS::serializeCbor(records).size();
+  };
+
+  BENCHMARK("JsonStruct_Serialize_Cbor_Deterministic")
+  {
+    return JS::serializeCbor(records, deterministic).size();
+  };
+
+  BENCHMARK("JsonStruct_Parse_Cbor")
+  {
+    std::vector<Telemetry> parsed;
+    JS::Error error = JS::parseCbor(cbor, parsed);
+    return error == JS::Error::NoError ? parsed.size() : 0;
+  };
+
+  BENCHMARK("JsonStruct_Parse_Cbor_Indefinite")
+  {
+    std::vector<Telemetry> parsed;
+    JS::Error error = JS::parseCbor(cbor_indefinite, parsed);
+    return error == JS::Error::NoError ? parsed.size() : 0;
+  };
+}
+
+TEST_CASE("Benchmarks_BinarySnapshot", "[performance]")
+{
+  std::vector<Telemetry> records(20000);
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    records[i].timestamp = int64_t(1700000000000 + i);
+    records[i].sensor = uint32_t(i % 512);
+    records[i].temperature = 20.0 + double(i % 100) / 7.0;
+    records[i].pressure = 101325.0 - double(i % 1000) * 0.37;
+    records[i].humidity = float(i % 100) / 3.0f;
+    records[i].samples = {int32_t(i), -int32_t(i % 300), 70000, 12};
+    records[i].unit = "celsius";
+  }
+  const std::string json = JS::serializeStruct(records, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  const std::string snapshot = JS::saveBinary(records);
+
+  BENCHMARK("JsonStruct_Save_Binary")
+  {
+    return JS::saveBinary(records).size();
+  };
+
+  BENCHMARK("JsonStruct_Load_Json")
+  {
+    std::vector<Telemetry> loaded;
+    JS::ParseContext context(json);
+    JS::Error error = context.parseTo(loaded);
+    return error == JS::Error::NoError ? loaded.size() : 0;
+  };
+
+  BENCHMARK("JsonStruct_Load_Binary")
+  {
+    std::vector<Telemetry> loaded;
+    JS::Error error = JS::loadBinary(snapshot, loaded);
+    return error == JS::Error::NoError ? loaded.size() : 0;
+  };
+}
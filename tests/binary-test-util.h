@@ -0,0 +1,16 @@
+#ifndef BINARY_TEST_UTIL_H
+#define BINARY_TEST_UTIL_H
+
+#include <initializer_list>
+#include <string>
+
+// Builds the expected output of the binary formats from a list of byte values.
+inline std::string bytes(std::initializer_list<int> list)
+{
+  std::string str;
+  for (int b : list)
+    str.push_back(char(b));
+  return str;
+}
+
+#endif
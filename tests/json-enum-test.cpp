@@ -1,6 +1,8 @@
 #include "catch2/catch_all.hpp"
 #include <json_struct/json_struct.h>
 #include <stdio.h>
+#include <string>
+#include <vector>
 
 JS_ENUM(Colors, Red, Green, Blue, Yellow4, Purple)
 
@@ -94,3 +96,90 @@ TEST_CASE("check_enum_parser_namespace", "[json_struct][enum]")
 }
 
 } // namespace
+
+JS_ENUM(StatusCode,
+        Continue, SwitchingProtocols, Ok, Created, Accepted, NoContent, MovedPermanently, Found,
+        NotModified, BadRequest, Unauthorized, Forbidden, NotFound, MethodNotAllowed, Conflict, Gone,
+        PayloadTooLarge, TooManyRequests, InternalServerError, NotImplemented, BadGateway,
+        ServiceUnavailable, GatewayTimeout, Http_505, _reserved, A, B2, C_3)
+
+namespace
+{
+struct StatusContainer
+{
+  std::vector<StatusCode> codes;
+  JS_OBJ(codes);
+};
+} // namespace
+JS_ENUM_DECLARE_STRING_PARSER(StatusCode)
+
+namespace
+{
+TEST_CASE("check_enum_name_table", "[json_struct][enum]")
+{
+  const std::vector<JS::DataRef> &strings = js_StatusCode_string_struct::strings();
+  REQUIRE(strings.size() == size_t(StatusCode::C_3) + 1);
+  REQUIRE(std::string(strings[size_t(StatusCode::Http_505)].data, strings[size_t(StatusCode::Http_505)].size) ==
+          "Http_505");
+  REQUIRE(std::string(strings[size_t(StatusCode::_reserved)].data, strings[size_t(StatusCode::_reserved)].size) ==
+          "_reserved");
+
+  StatusContainer container;
+  for (size_t i = 0; i < strings.size(); i++)
+    container.codes.push_back(static_cast<StatusCode>(i));
+  std::string json = JS::serializeStruct(container, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(json.find("\"NotFound\",\"MethodNotAllowed\"") != std::string::npos);
+  REQUIRE(json.find("\"_reserved\",\"A\",\"B2\",\"C_3\"]") != std::string::npos);
+
+  StatusContainer parsed;
+  JS::ParseContext pc(json);
+  REQUIRE(pc.parseTo(parsed) == JS::Error::NoError);
+  REQUIRE(parsed.codes == container.codes);
+}
+
+TEST_CASE("check_enum_unknown_name", "[json_struct][enum]")
+{
+  const char *invalid[] = {R"json({ "codes": [ "NotFoun" ] })json", R"json({ "codes": [ "NotFoundX" ] })json",
+                           R"json({ "codes": [ "" ] })json", R"json({ "codes": [ "ok" ] })json"};
+  for (const char *json : invalid)
+  {
+    StatusContainer parsed;
+    JS::ParseContext pc(json);
+    REQUIRE(pc.parseTo(parsed) == JS::Error::IllegalDataValue);
+  }
+}
+} // namespace
+
+JS_ENUM(Priority, Low = 1, Medium, High)
+JS_ENUM_DECLARE_VALUE_PARSER(Priority)
+
+namespace
+{
+struct PriorityContainer
+{
+  Priority priority;
+  JS_OBJ(priority);
+};
+
+TEST_CASE("check_enum_initializer", "[json_struct][enum]")
+{
+  // The name table is indexed by enum value, so a JS_ENUM with initializers fails to compile with a string parser.
+  // It can still be used with the value parser.
+  static_assert(JS::Internal::enumNamesHaveInitializer(js_Priority_string_struct::names(), 0,
+                                                       js_Priority_string_struct::size()),
+                "Initializer not found");
+  static_assert(!JS::Internal::enumNamesHaveInitializer(js_StatusCode_string_struct::names(), 0,
+                                                        js_StatusCode_string_struct::size()),
+                "Unexpected initializer");
+
+  PriorityContainer container;
+  container.priority = Priority::Medium;
+  std::string json = JS::serializeStruct(container, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(json == R"json({"priority":2})json");
+
+  PriorityContainer parsed;
+  JS::ParseContext pc(json);
+  REQUIRE(pc.parseTo(parsed) == JS::Error::NoError);
+  REQUIRE(parsed.priority == Priority::Medium);
+}
+} // namespace
@@ -0,0 +1,93 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Blobs
+{
+  JS::Base64Bytes standard;
+  JS::Base64UrlBytes url;
+  JS_OBJ(standard, url);
+};
+
+static std::vector<uint8_t> bytes(const char *str)
+{
+  return std::vector<uint8_t>(str, str + strlen(str));
+}
+
+TEST_CASE("base64_serialize", "[json_struct][base64]")
+{
+  Blobs blobs;
+  blobs.standard.data = bytes("foob");
+  blobs.url.data = {0xfb, 0xff, 0xbf, 0x3e};
+  std::string json = JS::serializeStruct(blobs, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(json == R"({"standard":"Zm9vYg==","url":"-_-_Pg"})");
+
+  blobs.standard.data = bytes("fooba");
+  blobs.url.data.clear();
+  json = JS::serializeStruct(blobs, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(json == R"({"standard":"Zm9vYmE=","url":""})");
+}
+
+TEST_CASE("base64_parse", "[json_struct][base64]")
+{
+  const char json[] = R"json({
+  "standard": "Zm9vYmFy",
+  "url": "-_-_Pg=="
+})json";
+  Blobs blobs;
+  JS::ParseContext context(json);
+  REQUIRE(context.parseTo(blobs) == JS::Error::NoError);
+  REQUIRE(blobs.standard.data == bytes("foobar"));
+  REQUIRE(blobs.url.data == std::vector<uint8_t>{0xfb, 0xff, 0xbf, 0x3e});
+
+  const char escaped[] = R"json({ "standard": "+\/+\/", "url": "Zg" })json";
+  JS::ParseContext escaped_context(escaped);
+  REQUIRE(escaped_context.parseTo(blobs) == JS::Error::NoError);
+  REQUIRE(blobs.standard.data == std::vector<uint8_t>{0xfb, 0xff, 0xbf});
+  REQUIRE(blobs.url.data == bytes("f"));
+}
+
+TEST_CASE("base64_roundtrip", "[json_struct][base64]")
+{
+  Blobs blobs;
+  for (size_t i = 0; i < 1000; i++)
+  {
+    blobs.standard.data.push_back(uint8_t(i * 7 + 3));
+    blobs.url.data.push_back(uint8_t(i * 13 + 5));
+  }
+  for (size_t size = 990; size <= 1000; size++)
+  {
+    Blobs sized;
+    sized.standard.data.assign(blobs.standard.data.begin(), blobs.standard.data.begin() + size);
+    sized.url.data.assign(blobs.url.data.begin(), blobs.url.data.begin() + size);
+    std::string json = JS::serializeStruct(sized);
+
+    Blobs parsed;
+    JS::ParseContext context(json);
+    REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+    REQUIRE(parsed.standard.data == sized.standard.data);
+    REQUIRE(parsed.url.data == sized.url.data);
+  }
+}
+
+TEST_CASE("base64_invalid", "[json_struct][base64]")
+{
+  const char *invalid[] = {
+    R"json({ "standard": "Zm9vY" })json",
+    R"json({ "standard": "Zm9v=mFy" })json",
+    R"json({ "standard": "Zm9vYmE==" })json",
+    R"json({ "standard": "Zm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFy*m9vYmFy" })json",
+    R"json({ "standard": 42 })json",
+  };
+  for (const char *json : invalid)
+  {
+    Blobs blobs;
+    JS::ParseContext context(json);
+    REQUIRE(context.parseTo(blobs) == JS::Error::IllegalDataValue);
+  }
+}
+} // namespace
@@ -0,0 +1,254 @@
+#define JS_STL_MAP
+#define JS_STL_ARRAY
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+#include "binary-test-util.h"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+JS_ENUM(Phase, Starting, Running, Stopping);
+JS_ENUM_DECLARE_STRING_PARSER(Phase);
+
+namespace
+{
+struct Point
+{
+  int32_t x = 0;
+  int32_t y = 0;
+  JS_OBJ(x, y);
+};
+
+// The same layout and names as Point, which gives the same schema
+struct OtherPoint
+{
+  int32_t x = 0;
+  int32_t y = 0;
+  JS_OBJ(x, y);
+};
+
+struct PointWithZ
+{
+  int32_t x = 0;
+  int32_t y = 0;
+  int32_t z = 0;
+  JS_OBJ(x, y, z);
+};
+
+struct WidePoint
+{
+  int32_t x = 0;
+  int64_t y = 0;
+  JS_OBJ(x, y);
+};
+
+struct RenamedPoint
+{
+  int32_t x = 0;
+  int32_t height = 0;
+  JS_OBJ(x, height);
+};
+
+struct SwappedPoint
+{
+  int32_t y = 0;
+  int32_t x = 0;
+  JS_OBJ(y, x);
+};
+
+struct Record
+{
+  std::string name;
+  std::vector<int16_t> values;
+  std::unique_ptr<uint8_t> flag;
+  JS_OBJ(name, values, flag);
+};
+
+struct Tree
+{
+  std::string label;
+  std::vector<Tree> children;
+  JS_OBJ(label, children);
+};
+
+struct Service
+{
+  std::string host;
+  uint16_t port = 0;
+  JS_OBJ(host, port);
+};
+
+struct State : Service
+{
+  Phase phase = Phase::Starting;
+  bool healthy = false;
+  double load = 0;
+  float ratio = 0;
+  int64_t uptime = 0;
+  char grade = 'a';
+  std::vector<Point> points;
+  std::map<std::string, std::vector<double>> series;
+  JS::OptionalChecked<std::string> owner;
+  JS::Nullable<int> retries;
+  JS::NullableChecked<int> limit;
+  std::shared_ptr<State> previous;
+  uint16_t ports[3] = {0, 0, 0};
+  std::array<bool, 2> switches = {{false, false}};
+  JS::CompactString zone;
+  JS::Tracked<int> generation;
+  Tree tree;
+  JS_OBJ_SUPER(JS_SUPER_CLASSES(JS_SUPER_CLASS(Service)), phase, healthy, load, ratio, uptime, grade, points, series,
+               owner, retries, limit, previous, ports, switches, zone, generation, tree);
+};
+
+std::string header(uint64_t hash)
+{
+  std::string str = "JSB1";
+  for (int i = 0; i < 8; i++)
+    str.push_back(char(uint8_t(hash >> (8 * i))));
+  return str;
+}
+
+const char state_json[] = R"json({
+  "host": "10.0.0.1",
+  "port": 8443,
+  "phase": "Running",
+  "healthy": true,
+  "load": 0.1,
+  "ratio": -2.5,
+  "uptime": -86400000000,
+  "grade": 98,
+  "points": [ { "x": -1 }, { "y": 2147483647 } ],
+  "series": { "cpu": [ 0.5, 1e-300, -0.0 ], "mem": [] },
+  "owner": "ops",
+  "retries": 3,
+  "limit": null,
+  "previous": { "host": "10.0.0.2" },
+  "ports": [ 0, 65535, 0 ],
+  "switches": [ false, true ],
+  "zone": "a zone name that is longer than the inline capacity",
+  "generation": 7,
+  "tree": { "label": "root", "children": [ {}, { "label": "leaf", "children": [ {} ] } ] }
+})json";
+
+TEST_CASE("binary_snapshot_layout", "[json_struct][binary]")
+{
+  Point point;
+  point.x = 1;
+  point.y = -2;
+  const std::string data = JS::saveBinary(point);
+  REQUIRE(data == header(JS::binarySchemaHash<Point>()) + bytes({1, 0, 0, 0, 0xfe, 0xff, 0xff, 0xff}));
+
+  // Strings and arrays have a 64 bit length in front, and pointers a presence byte
+  Record record;
+  record.name = "ab";
+  record.values = {1, -1};
+  REQUIRE(JS::saveBinary(record).substr(12) ==
+          bytes({2, 0, 0, 0, 0, 0, 0, 0, 'a', 'b', 2, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0xff, 0xff, 0}));
+  record.flag.reset(new uint8_t(9));
+  REQUIRE(JS::saveBinary(record).substr(12 + 22) == bytes({1, 9}));
+
+  JS::Base64Bytes blob({7, 8});
+  REQUIRE(JS::saveBinary(blob).substr(12) == bytes({2, 0, 0, 0, 0, 0, 0, 0, 7, 8}));
+  JS::Base64Bytes loaded_blob;
+  REQUIRE(JS::loadBinary(JS::saveBinary(blob), loaded_blob) == JS::Error::NoError);
+  REQUIRE(loaded_blob.data == blob.data);
+
+  std::string out = "previous";
+  JS::saveBinary(point, out);
+  REQUIRE(out == data);
+
+  Point loaded;
+  REQUIRE(JS::loadBinary(data, loaded) == JS::Error::NoError);
+  REQUIRE(loaded.x == 1);
+  REQUIRE(loaded.y == -2);
+}
+
+TEST_CASE("binary_snapshot_roundtrip", "[json_struct][binary]")
+{
+  State state;
+  JS::ParseContext context(state_json);
+  REQUIRE(context.parseTo(state) == JS::Error::NoError);
+  const std::string data = JS::saveBinary(state);
+  State loaded;
+  loaded.points.resize(5);
+  loaded.series["stale"] = {1};
+  REQUIRE(JS::loadBinary(data, loaded) == JS::Error::NoError);
+  REQUIRE(JS::serializeStruct(loaded) == JS::serializeStruct(state));
+  REQUIRE(loaded.owner.assigned);
+  REQUIRE(loaded.limit.null);
+  REQUIRE(!loaded.previous->previous);
+  REQUIRE(loaded.tree.children[1].children.size() == 1);
+  REQUIRE(JS::saveBinary(loaded) == data);
+
+  // The snapshot does not repeat the member names, so it is smaller than the other binary formats
+  REQUIRE(data.size() < JS::serializeMsgpack(state).size());
+}
+
+TEST_CASE("binary_snapshot_schema_hash", "[json_struct][binary]")
+{
+  const uint64_t point = JS::binarySchemaHash<Point>();
+  REQUIRE(point == JS::binarySchemaHash<Point>());
+  REQUIRE(point == JS::binarySchemaHash<OtherPoint>());
+  REQUIRE(point != JS::binarySchemaHash<PointWithZ>());
+  REQUIRE(point != JS::binarySchemaHash<WidePoint>());
+  REQUIRE(point != JS::binarySchemaHash<RenamedPoint>());
+  REQUIRE(point != JS::binarySchemaHash<SwappedPoint>());
+  REQUIRE(JS::binarySchemaHash<std::vector<Point>>() != point);
+  REQUIRE(JS::binarySchemaHash<int32_t>() != JS::binarySchemaHash<uint32_t>());
+  REQUIRE(JS::binarySchemaHash<std::vector<int>>() != JS::binarySchemaHash<std::unique_ptr<int>>());
+  REQUIRE(JS::binarySchemaHash<Tree>() != JS::binarySchemaHash<State>());
+
+  // A snapshot of a different version of the struct is rejected before anything is read
+  Point value;
+  value.x = 5;
+  const std::string data = JS::saveBinary(value);
+  OtherPoint other;
+  REQUIRE(JS::loadBinary(data, other) == JS::Error::NoError);
+  REQUIRE(other.x == 5);
+  PointWithZ with_z;
+  REQUIRE(JS::loadBinary(data, with_z) == JS::Error::IllegalPropertyType);
+  WidePoint wide;
+  REQUIRE(JS::loadBinary(data, wide) == JS::Error::IllegalPropertyType);
+  SwappedPoint swapped;
+  REQUIRE(JS::loadBinary(data, swapped) == JS::Error::IllegalPropertyType);
+  REQUIRE(swapped.x == 0);
+}
+
+TEST_CASE("binary_snapshot_invalid_data", "[json_struct][binary]")
+{
+  State state;
+  JS::ParseContext context(state_json);
+  REQUIRE(context.parseTo(state) == JS::Error::NoError);
+  const std::string data = JS::saveBinary(state);
+
+  // Every truncation is an error, and never reads past the end
+  for (size_t size = 0; size < data.size(); size++)
+  {
+    std::vector<char> copy(data.begin(), data.begin() + ptrdiff_t(size));
+    State loaded;
+    REQUIRE(JS::loadBinary(copy.data(), copy.size(), loaded) != JS::Error::NoError);
+  }
+
+  State loaded;
+  REQUIRE(JS::loadBinary(data + bytes({0}), loaded) == JS::Error::InvalidToken);
+  REQUIRE(JS::loadBinary("{\"x\":1,\"y\":2}", loaded) == JS::Error::InvalidToken);
+  REQUIRE(JS::loadBinary(JS::serializeMsgpack(state), loaded) == JS::Error::InvalidToken);
+
+  const std::string prefix = header(JS::binarySchemaHash<Record>());
+  Record record;
+  REQUIRE(JS::loadBinary(prefix + bytes({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2}), record) ==
+          JS::Error::IllegalDataValue);
+  REQUIRE(JS::loadBinary(prefix + bytes({0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 'a'}), record) ==
+          JS::Error::NeedMoreData);
+  REQUIRE(JS::loadBinary(prefix + bytes({0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f, 0}),
+                         record) == JS::Error::NeedMoreData);
+
+  bool flag;
+  REQUIRE(JS::loadBinary(header(JS::binarySchemaHash<bool>()) + bytes({2}), flag) == JS::Error::FailedToParseBoolean);
+}
+
+} // namespace
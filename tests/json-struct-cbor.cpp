@@ -0,0 +1,380 @@
+#define JS_STL_MAP
+#define JS_STL_ARRAY
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+#include "binary-test-util.h"
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+JS_ENUM(Mode, Idle, Sampling, Sleeping);
+JS_ENUM_DECLARE_STRING_PARSER(Mode);
+
+namespace
+{
+struct Sample
+{
+  int64_t time = 0;
+  double value = 0;
+  JS_OBJ(time, value);
+};
+
+struct Device
+{
+  std::string serial;
+  uint16_t firmware = 0;
+  JS_OBJ(serial, firmware);
+};
+
+struct Sensor : Device
+{
+  Mode mode = Mode::Idle;
+  float threshold = 0.0f;
+  bool enabled = false;
+  std::vector<Sample> samples;
+  std::map<std::string, std::vector<int8_t>> calibration;
+  std::unordered_map<std::string, int> counters;
+  JS::OptionalChecked<uint32_t> battery;
+  std::unique_ptr<Sensor> backup;
+  std::array<uint8_t, 4> address = {{0, 0, 0, 0}};
+  JS_OBJ_SUPER(JS_SUPER_CLASSES(JS_SUPER_CLASS(Device)), mode, threshold, enabled, samples, calibration, counters,
+               battery, backup, address);
+};
+
+struct Unsorted
+{
+  int zz = 1;
+  int b = 2;
+  int aa = 3;
+  JS_OBJ(zz, b, aa);
+};
+
+struct FunAmt
+{
+  bool Fun = false;
+  int Amt = 0;
+  JS_OBJ(Fun, Amt);
+};
+
+struct Labels
+{
+  std::string a;
+  std::vector<int> b;
+  JS_OBJ(a, b);
+};
+
+JS::CborOptions deterministic()
+{
+  JS::CborOptions options;
+  options.setDeterministic(true);
+  return options;
+}
+
+JS::CborOptions indefinite()
+{
+  JS::CborOptions options;
+  options.setIndefiniteLengths(true);
+  return options;
+}
+
+const char sensor_json[] = R"json({
+  "serial": "SN-0042",
+  "firmware": 513,
+  "mode": "Sampling",
+  "threshold": 0.75,
+  "enabled": true,
+  "samples": [
+    { "time": 1700000000000, "value": 21.5 },
+    { "time": -1, "value": 1.1 },
+    { "time": -9223372036854775808, "value": -1e300 }
+  ],
+  "calibration": { "offset": [ -128, 0, 127 ], "gain": [] },
+  "counters": { "resets": 3, "errors": -70000, "uploads": 1000000 },
+  "battery": 87,
+  "backup": { "serial": "SN-0043" },
+  "address": [ 10, 0, 0, 255 ]
+})json";
+
+TEST_CASE("cbor_rfc_integers", "[json_struct][cbor]")
+{
+  // The examples of RFC 8949 appendix A
+  REQUIRE(JS::serializeCbor(0) == bytes({0x00}));
+  REQUIRE(JS::serializeCbor(23) == bytes({0x17}));
+  REQUIRE(JS::serializeCbor(24) == bytes({0x18, 0x18}));
+  REQUIRE(JS::serializeCbor(100) == bytes({0x18, 0x64}));
+  REQUIRE(JS::serializeCbor(1000) == bytes({0x19, 0x03, 0xe8}));
+  REQUIRE(JS::serializeCbor(1000000) == bytes({0x1a, 0x00, 0x0f, 0x42, 0x40}));
+  REQUIRE(JS::serializeCbor(int64_t(1000000000000)) == bytes({0x1b, 0x00, 0x00, 0x00, 0xe8, 0xd4, 0xa5, 0x10, 0x00}));
+  REQUIRE(JS::serializeCbor(std::numeric_limits<uint64_t>::max()) ==
+          bytes({0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}));
+  REQUIRE(JS::serializeCbor(-1) == bytes({0x20}));
+  REQUIRE(JS::serializeCbor(-10) == bytes({0x29}));
+  REQUIRE(JS::serializeCbor(-100) == bytes({0x38, 0x63}));
+  REQUIRE(JS::serializeCbor(-1000) == bytes({0x39, 0x03, 0xe7}));
+
+  for (int64_t value : {int64_t(0), int64_t(-1), int64_t(23), int64_t(-24), int64_t(-25), int64_t(255), int64_t(-256),
+                        int64_t(-257), int64_t(65536), int64_t(4294967296), std::numeric_limits<int64_t>::min(),
+                        std::numeric_limits<int64_t>::max()})
+  {
+    int64_t parsed = 1;
+    REQUIRE(JS::parseCbor(JS::serializeCbor(value), parsed) == JS::Error::NoError);
+    REQUIRE(parsed == value);
+  }
+
+  // -2^64 does not fit any integer type, and values are range checked against the type they are read into
+  int64_t big;
+  REQUIRE(JS::parseCbor(bytes({0x3b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}), big) ==
+          JS::Error::FailedToParseInt);
+  uint8_t small;
+  REQUIRE(JS::parseCbor(bytes({0x19, 0x01, 0x00}), small) == JS::Error::FailedToParseInt);
+  REQUIRE(JS::parseCbor(bytes({0x20}), small) == JS::Error::FailedToParseInt);
+  REQUIRE(JS::parseCbor(bytes({0x18, 0xff}), small) == JS::Error::NoError);
+  REQUIRE(small == 255);
+}
+
+TEST_CASE("cbor_rfc_floats", "[json_struct][cbor]")
+{
+  // Without the deterministic mode floating point values keep the width of their type
+  REQUIRE(JS::serializeCbor(1.5) == bytes({0xfb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0}));
+  REQUIRE(JS::serializeCbor(1.5f) == bytes({0xfa, 0x3f, 0xc0, 0, 0}));
+
+  // With it they get the shortest exact form, like the examples of RFC 8949 appendix A
+  const JS::CborOptions options = deterministic();
+  REQUIRE(JS::serializeCbor(0.0, options) == bytes({0xf9, 0x00, 0x00}));
+  REQUIRE(JS::serializeCbor(-0.0, options) == bytes({0xf9, 0x80, 0x00}));
+  REQUIRE(JS::serializeCbor(1.0, options) == bytes({0xf9, 0x3c, 0x00}));
+  REQUIRE(JS::serializeCbor(1.1, options) == bytes({0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a}));
+  REQUIRE(JS::serializeCbor(1.5, options) == bytes({0xf9, 0x3e, 0x00}));
+  REQUIRE(JS::serializeCbor(65504.0, options) == bytes({0xf9, 0x7b, 0xff}));
+  REQUIRE(JS::serializeCbor(100000.0, options) == bytes({0xfa, 0x47, 0xc3, 0x50, 0x00}));
+  REQUIRE(JS::serializeCbor(3.4028234663852886e+38, options) == bytes({0xfa, 0x7f, 0x7f, 0xff, 0xff}));
+  REQUIRE(JS::serializeCbor(1.0e+300, options) == bytes({0xfb, 0x7e, 0x37, 0xe4, 0x3c, 0x88, 0x00, 0x75, 0x9c}));
+  REQUIRE(JS::serializeCbor(5.960464477539063e-8, options) == bytes({0xf9, 0x00, 0x01}));
+  REQUIRE(JS::serializeCbor(0.00006103515625, options) == bytes({0xf9, 0x04, 0x00}));
+  REQUIRE(JS::serializeCbor(-4.0, options) == bytes({0xf9, 0xc4, 0x00}));
+  REQUIRE(JS::serializeCbor(-4.1, options) == bytes({0xfb, 0xc0, 0x10, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66}));
+  REQUIRE(JS::serializeCbor(std::numeric_limits<double>::infinity(), options) == bytes({0xf9, 0x7c, 0x00}));
+  REQUIRE(JS::serializeCbor(-std::numeric_limits<double>::infinity(), options) == bytes({0xf9, 0xfc, 0x00}));
+  REQUIRE(JS::serializeCbor(std::numeric_limits<double>::quiet_NaN(), options) == bytes({0xf9, 0x7e, 0x00}));
+  REQUIRE(JS::serializeCbor(1e-40, options).size() == 9);
+  REQUIRE(JS::serializeCbor(std::numeric_limits<double>::max(), options).size() == 9);
+
+  for (double value : {0.0, 1.5, 1.1, 65504.0, 100000.0, 5.960464477539063e-8, 0.00006103515625, -4.1, 1e-40,
+                       -1e300, std::numeric_limits<double>::infinity()})
+  {
+    double parsed = 0;
+    REQUIRE(JS::parseCbor(JS::serializeCbor(value, options), parsed) == JS::Error::NoError);
+    REQUIRE(parsed == value);
+  }
+  double nan = 0;
+  REQUIRE(JS::parseCbor(bytes({0xf9, 0x7e, 0x00}), nan) == JS::Error::NoError);
+  REQUIRE(std::isnan(nan));
+
+  // Integers are accepted where floating point values are expected
+  float f = 0;
+  REQUIRE(JS::parseCbor(bytes({0x38, 0x63}), f) == JS::Error::NoError);
+  REQUIRE(f == -100.0f);
+  REQUIRE(JS::parseCbor(bytes({0xf5}), f) == JS::Error::FailedToParseFloat);
+}
+
+TEST_CASE("cbor_rfc_other_values", "[json_struct][cbor]")
+{
+  REQUIRE(JS::serializeCbor(false) == bytes({0xf4}));
+  REQUIRE(JS::serializeCbor(true) == bytes({0xf5}));
+  std::unique_ptr<int> null;
+  REQUIRE(JS::serializeCbor(null) == bytes({0xf6}));
+  REQUIRE(JS::serializeCbor(std::string()) == bytes({0x60}));
+  REQUIRE(JS::serializeCbor(std::string("IETF")) == bytes({0x64, 'I', 'E', 'T', 'F'}));
+  REQUIRE(JS::serializeCbor(std::vector<int>()) == bytes({0x80}));
+  REQUIRE(JS::serializeCbor(std::vector<int>{1, 2, 3}) == bytes({0x83, 0x01, 0x02, 0x03}));
+  REQUIRE(JS::serializeCbor(std::vector<std::vector<int>>{{1}, {2, 3}, {4, 5}}) ==
+          bytes({0x83, 0x81, 0x01, 0x82, 0x02, 0x03, 0x82, 0x04, 0x05}));
+  REQUIRE(JS::serializeCbor(std::vector<int>(25, 1)).substr(0, 2) == bytes({0x98, 0x19}));
+  REQUIRE(JS::serializeCbor(std::map<std::string, int>()) == bytes({0xa0}));
+  REQUIRE(JS::serializeCbor(Mode::Sleeping) == bytes({0x02}));
+  REQUIRE(JS::serializeCbor(JS::Base64Bytes({1, 2, 3, 4})) == bytes({0x44, 0x01, 0x02, 0x03, 0x04}));
+  JS::Base64Bytes blob;
+  REQUIRE(JS::parseCbor(bytes({0x5f, 0x42, 0x01, 0x02, 0x41, 0x03, 0xff}), blob) == JS::Error::NoError);
+  REQUIRE(blob.data == std::vector<uint8_t>({1, 2, 3}));
+  REQUIRE(JS::parseCbor(bytes({0x62, 'a', 'b'}), blob) == JS::Error::IllegalDataValue);
+
+  Labels labels;
+  labels.a = "a";
+  labels.b = {2, 3};
+  REQUIRE(JS::serializeCbor(labels) == bytes({0xa2, 0x61, 'a', 0x61, 'a', 0x61, 'b', 0x82, 0x02, 0x03}));
+  REQUIRE(JS::serializeCbor(labels, JS::CborOptions(JS::KeyStyle::Indices)) ==
+          bytes({0xa2, 0x00, 0x61, 'a', 0x01, 0x82, 0x02, 0x03}));
+
+  // undefined is read as null
+  std::unique_ptr<int> parsed(new int(1));
+  REQUIRE(JS::parseCbor(bytes({0xf7}), parsed) == JS::Error::NoError);
+  REQUIRE(!parsed);
+}
+
+TEST_CASE("cbor_indefinite_lengths", "[json_struct][cbor]")
+{
+  // The streaming examples of RFC 8949 appendix A
+  std::string str;
+  REQUIRE(JS::parseCbor(bytes({0x7f, 0x65, 's', 't', 'r', 'e', 'a', 0x64, 'm', 'i', 'n', 'g', 0xff}), str) ==
+          JS::Error::NoError);
+  REQUIRE(str == "streaming");
+
+  std::vector<int> empty = {1};
+  REQUIRE(JS::parseCbor(bytes({0x9f, 0xff}), empty) == JS::Error::NoError);
+  REQUIRE(empty.empty());
+
+  std::vector<std::vector<int>> nested;
+  REQUIRE(JS::parseCbor(bytes({0x9f, 0x81, 0x01, 0x82, 0x02, 0x03, 0x9f, 0x04, 0x05, 0xff, 0xff}), nested) ==
+          JS::Error::NoError);
+  REQUIRE(nested == std::vector<std::vector<int>>{{1}, {2, 3}, {4, 5}});
+
+  Labels labels;
+  REQUIRE(JS::parseCbor(bytes({0xbf, 0x61, 'a', 0x61, 'x', 0x61, 'b', 0x9f, 0x02, 0x03, 0xff, 0xff}), labels) ==
+          JS::Error::NoError);
+  REQUIRE(labels.a == "x");
+  REQUIRE(labels.b == std::vector<int>{2, 3});
+
+  FunAmt fun;
+  REQUIRE(JS::parseCbor(bytes({0xbf, 0x63, 'F', 'u', 'n', 0xf5, 0x63, 'A', 'm', 't', 0x21, 0xff}), fun) ==
+          JS::Error::NoError);
+  REQUIRE(fun.Fun);
+  REQUIRE(fun.Amt == -2);
+
+  // Chunked member names, and unknown members with indefinite lengths that are skipped
+  fun = FunAmt();
+  REQUIRE(JS::parseCbor(bytes({0xbf, 0x7f, 0x61, 'F', 0x62, 'u', 'n', 0xff, 0xf5, 0x61, 'x', 0x9f, 0xbf, 0x61, 'y',
+                               0x7f, 0xff, 0xff, 0x5f, 0x41, 0x00, 0xff, 0xff, 0x63, 'A', 'm', 't', 0x05, 0xff}),
+                        fun) == JS::Error::NoError);
+  REQUIRE(fun.Fun);
+  REQUIRE(fun.Amt == 5);
+
+  // The writer ends every container with a break
+  const JS::CborOptions options = indefinite();
+  REQUIRE(JS::serializeCbor(std::vector<int>{1, 2}, options) == bytes({0x9f, 0x01, 0x02, 0xff}));
+  REQUIRE(JS::serializeCbor(labels, options) ==
+          bytes({0xbf, 0x61, 'a', 0x61, 'x', 0x61, 'b', 0x9f, 0x02, 0x03, 0xff, 0xff}));
+}
+
+TEST_CASE("cbor_deterministic", "[json_struct][cbor]")
+{
+  // Map entries are sorted by their encoded keys, so shorter names come first
+  Unsorted unsorted;
+  REQUIRE(JS::serializeCbor(unsorted) ==
+          bytes({0xa3, 0x62, 'z', 'z', 0x01, 0x61, 'b', 0x02, 0x62, 'a', 'a', 0x03}));
+  REQUIRE(JS::serializeCbor(unsorted, deterministic()) ==
+          bytes({0xa3, 0x61, 'b', 0x02, 0x62, 'a', 'a', 0x03, 0x62, 'z', 'z', 0x01}));
+
+  // Indefinite lengths are not used in deterministic mode
+  JS::CborOptions options = deterministic();
+  options.setIndefiniteLengths(true);
+  REQUIRE(JS::serializeCbor(unsorted, options) == JS::serializeCbor(unsorted, deterministic()));
+
+  // The same value gives the same bytes, whatever the order of the unordered map
+  Sensor first;
+  JS::ParseContext first_context(sensor_json);
+  REQUIRE(first_context.parseTo(first) == JS::Error::NoError);
+  Sensor second;
+  JS::ParseContext second_context(sensor_json);
+  REQUIRE(second_context.parseTo(second) == JS::Error::NoError);
+  second.counters.clear();
+  second.counters.reserve(64);
+  second.counters["uploads"] = 1000000;
+  second.counters["errors"] = -70000;
+  second.counters["resets"] = 3;
+  const std::string data = JS::serializeCbor(first, deterministic());
+  REQUIRE(JS::serializeCbor(second, deterministic()) == data);
+
+  Sensor parsed;
+  REQUIRE(JS::parseCbor(data, parsed) == JS::Error::NoError);
+  REQUIRE(JS::serializeCbor(parsed, deterministic()) == data);
+  REQUIRE(parsed.counters == first.counters);
+
+  // Index keys are sorted as well, the super class members have the highest indices
+  const std::string indexed = JS::serializeCbor(first, JS::CborOptions(JS::KeyStyle::Indices));
+  JS::CborOptions indexed_options = deterministic();
+  indexed_options.setKeys(JS::KeyStyle::Indices);
+  const std::string sorted = JS::serializeCbor(first, indexed_options);
+  REQUIRE(sorted.substr(0, 2) == bytes({0xab, 0x00}));
+  REQUIRE(sorted.size() < indexed.size());
+  REQUIRE(JS::parseCbor(sorted, parsed) == JS::Error::NoError);
+  REQUIRE(JS::serializeCbor(parsed, deterministic()) == data);
+}
+
+TEST_CASE("cbor_roundtrip", "[json_struct][cbor]")
+{
+  // The unordered map makes the JSON depend on the insertion order, so the deterministic CBOR is compared instead
+  Sensor sensor;
+  JS::ParseContext context(sensor_json);
+  REQUIRE(context.parseTo(sensor) == JS::Error::NoError);
+  const std::string canonical = JS::serializeCbor(sensor, deterministic());
+
+  for (auto keys : {JS::KeyStyle::Names, JS::KeyStyle::Indices})
+  {
+    JS::CborOptions options(keys);
+    for (int mode = 0; mode < 3; mode++)
+    {
+      options.setDeterministic(mode == 1);
+      options.setIndefiniteLengths(mode == 2);
+      const std::string data = JS::serializeCbor(sensor, options);
+      Sensor parsed;
+      REQUIRE(JS::parseCbor(data, parsed) == JS::Error::NoError);
+      REQUIRE(JS::serializeCbor(parsed, deterministic()) == canonical);
+      REQUIRE(parsed.battery.assigned);
+      REQUIRE(!parsed.backup->battery.assigned);
+      REQUIRE(!parsed.backup->backup);
+
+      std::string out = "previous";
+      JS::serializeCbor(sensor, out, options);
+      REQUIRE(out == data);
+
+      // Every truncation is an error, and never reads past the end
+      for (size_t size = 0; size < data.size(); size++)
+      {
+        std::vector<char> copy(data.begin(), data.begin() + ptrdiff_t(size));
+        Sensor truncated;
+        REQUIRE(JS::parseCbor(copy.data(), copy.size(), truncated) != JS::Error::NoError);
+      }
+    }
+  }
+
+  // MessagePack and CBOR share the handlers, so both give the same struct
+  Sensor from_msgpack;
+  REQUIRE(JS::parseMsgpack(JS::serializeMsgpack(sensor), from_msgpack) == JS::Error::NoError);
+  REQUIRE(JS::serializeCbor(from_msgpack, deterministic()) == canonical);
+}
+
+TEST_CASE("cbor_tags_and_invalid_data", "[json_struct][cbor]")
+{
+  // Tags are skipped, also in front of member names and inside skipped values
+  int64_t epoch = 0;
+  REQUIRE(JS::parseCbor(bytes({0xc1, 0x1a, 0x51, 0x4b, 0x67, 0xb0}), epoch) == JS::Error::NoError);
+  REQUIRE(epoch == 1363896240);
+  FunAmt fun;
+  REQUIRE(JS::parseCbor(bytes({0xa2, 0xd8, 0x20, 0x63, 'A', 'm', 't', 0x07, 0x61, 'x', 0xc2, 0x41, 0x01}), fun) ==
+          JS::Error::NoError);
+  REQUIRE(fun.Amt == 7);
+
+  REQUIRE(JS::parseCbor(JS::serializeCbor(fun) + bytes({0x00}), fun) == JS::Error::InvalidToken);
+  REQUIRE(JS::parseCbor(bytes({0x82, 0x01, 0x02}), fun) == JS::Error::ExpectedObjectStart);
+  REQUIRE(JS::parseCbor(bytes({0xa1, 0x63, 'A', 'm', 't', 0x61, '1'}), fun) == JS::Error::FailedToParseInt);
+  REQUIRE(JS::parseCbor(bytes({0xa1, 0xf5, 0x01}), fun) == JS::Error::IllegalPropertyName);
+  REQUIRE(JS::parseCbor(bytes({0xa1, 0x61, 'x', 0x1c}), fun) == JS::Error::InvalidToken);
+  REQUIRE(JS::parseCbor(bytes({0xa1, 0x61, 'x', 0x1f}), fun) == JS::Error::InvalidToken);
+
+  std::vector<int> list;
+  REQUIRE(JS::parseCbor(bytes({0x9b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01}), list) ==
+          JS::Error::NeedMoreData);
+  REQUIRE(JS::parseCbor(bytes({0x9f, 0x01}), list) == JS::Error::NeedMoreData);
+  std::string str;
+  REQUIRE(JS::parseCbor(bytes({0x01}), str) == JS::Error::IllegalDataValue);
+  REQUIRE(JS::parseCbor(bytes({0x7f, 0x01, 0xff}), str) == JS::Error::IllegalDataValue);
+  bool flag;
+  REQUIRE(JS::parseCbor(bytes({0x01}), flag) == JS::Error::FailedToParseBoolean);
+}
+
+} // namespace
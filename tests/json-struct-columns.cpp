@@ -0,0 +1,113 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Person
+{
+  int index = 0;
+  std::string name;
+  float latitude = 0.0f;
+  bool active = false;
+  std::vector<int> tags;
+  JS_OBJ(index, name, latitude, active, tags);
+};
+
+const char people[] = R"json([
+  { "index": 0, "name": "Alice", "latitude": 59.5, "active": true, "tags": [ 1, 2 ] },
+  { "name": "B\"ob\n", "index": 1, "latitude": -12.25, "tags": [] },
+  { "index": 2, "unknown": { "nested": [ 1, 2, 3 ] }, "active": false, "name": "" }
+])json";
+
+TEST_CASE("parse_columns_basic", "[json_struct][columns]")
+{
+  JS::Columns<Person> columns;
+  REQUIRE(JS::parseColumns(people, sizeof(people) - 1, columns) == JS::Error::NoError);
+  REQUIRE(columns.rows() == 3);
+
+  const std::vector<int> &index = columns.column(&Person::index);
+  REQUIRE(index == std::vector<int>({0, 1, 2}));
+
+  const JS::StringColumn &name = columns.column(&Person::name);
+  REQUIRE(name.size() == 3);
+  REQUIRE(name.str(0) == "Alice");
+  REQUIRE(name.str(1) == "B\"ob\n");
+  REQUIRE(name.str(2).empty());
+  REQUIRE(name.arena() == "AliceB\"ob\n");
+
+  const std::vector<float> &latitude = columns.get<2>();
+  REQUIRE(latitude[0] == 59.5f);
+  REQUIRE(latitude[1] == -12.25f);
+  REQUIRE(latitude[2] == 0.0f);
+
+  const std::vector<bool> &active = columns.column(&Person::active);
+  REQUIRE(active[0]);
+  REQUIRE(!active[1]);
+  REQUIRE(!active[2]);
+
+  const std::vector<std::vector<int>> &tags = columns.column(&Person::tags);
+  REQUIRE(tags[0] == std::vector<int>({1, 2}));
+  REQUIRE(tags[1].empty());
+}
+
+TEST_CASE("parse_columns_roundtrip", "[json_struct][columns]")
+{
+  JS::Columns<Person> columns;
+  REQUIRE(JS::parseColumns(people, sizeof(people) - 1, columns) == JS::Error::NoError);
+  std::string json = JS::serializeStruct(columns);
+
+  std::vector<Person> rows;
+  JS::ParseContext context(json);
+  REQUIRE(context.parseTo(rows) == JS::Error::NoError);
+  REQUIRE(rows.size() == 3);
+  REQUIRE(rows[1].name == "B\"ob\n");
+  REQUIRE(rows[0].tags == std::vector<int>({1, 2}));
+
+  JS::Columns<Person> again;
+  REQUIRE(JS::parseColumns(json.data(), json.size(), again) == JS::Error::NoError);
+  REQUIRE(JS::serializeStruct(again) == json);
+}
+
+TEST_CASE("parse_columns_strict_members", "[json_struct][columns]")
+{
+  JS::Columns<Person> columns;
+  JS::ParseContext context(people);
+  context.allow_missing_members = false;
+  REQUIRE(JS::parseColumns(context, columns) == JS::Error::MissingPropertyMember);
+  REQUIRE(context.missing_members.size() == 1);
+  REQUIRE(context.missing_members[0] == "unknown");
+}
+
+struct Holder
+{
+  JS::Columns<Person> people;
+  int count = 0;
+  JS_OBJ(people, count);
+};
+
+TEST_CASE("parse_columns_as_member", "[json_struct][columns]")
+{
+  const char json[] = R"json({ "people": [ { "index": 7, "name": "x" } ], "count": 1 })json";
+  Holder holder;
+  JS::ParseContext context(json);
+  REQUIRE(context.parseTo(holder) == JS::Error::NoError);
+  REQUIRE(holder.count == 1);
+  REQUIRE(holder.people.rows() == 1);
+  REQUIRE(holder.people.get<0>()[0] == 7);
+  REQUIRE(holder.people.get<1>().str(0) == "x");
+}
+
+TEST_CASE("parse_columns_errors", "[json_struct][columns]")
+{
+  JS::Columns<Person> columns;
+  const char not_array[] = R"json({ "index": 1 })json";
+  REQUIRE(JS::parseColumns(not_array, sizeof(not_array) - 1, columns) == JS::Error::ExpectedArrayStart);
+  const char not_object[] = R"json([ 1, 2 ])json";
+  REQUIRE(JS::parseColumns(not_object, sizeof(not_object) - 1, columns) == JS::Error::ExpectedObjectStart);
+  const char bad_value[] = R"json([ { "index": "x" } ])json";
+  REQUIRE(JS::parseColumns(bad_value, sizeof(bad_value) - 1, columns) == JS::Error::FailedToParseInt);
+}
+} // namespace
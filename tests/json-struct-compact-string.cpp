@@ -0,0 +1,107 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+struct Account
+{
+  JS::CompactString id;
+  JS::CompactString code;
+  JS::CompactString description;
+  JS_OBJ(id, code, description);
+};
+
+TEST_CASE("compact_string_inline_and_heap", "[json_struct][compact_string]")
+{
+  REQUIRE(sizeof(JS::CompactString) == 32);
+
+  JS::CompactString empty;
+  REQUIRE(empty.empty());
+  REQUIRE(empty.isInline());
+  REQUIRE(std::string(empty.c_str()) == "");
+
+  std::string thirty_one(31, 'a');
+  JS::CompactString full(thirty_one);
+  REQUIRE(full.isInline());
+  REQUIRE(full.size() == 31);
+  REQUIRE(full.toString() == thirty_one);
+  REQUIRE(full.c_str()[31] == 0);
+
+  full.push_back('b');
+  REQUIRE(!full.isInline());
+  REQUIRE(full.size() == 32);
+  REQUIRE(full.toString() == thirty_one + "b");
+
+  JS::CompactString copy(full);
+  REQUIRE(copy == full);
+  REQUIRE(copy.data() != full.data());
+
+  JS::CompactString moved(std::move(copy));
+  REQUIRE(moved == full);
+  REQUIRE(copy.empty());
+  REQUIRE(copy.isInline());
+
+  moved = JS::CompactString("short");
+  REQUIRE(moved == "short");
+  REQUIRE(moved.isInline());
+
+  full.assign("reused", 6);
+  REQUIRE(full == "reused");
+  REQUIRE(full.capacity() >= 32);
+
+  JS::CompactString self("0123456789abcdefghijklmnopqrst");
+  self.append(self.data(), self.size());
+  REQUIRE(self == "0123456789abcdefghijklmnopqrst0123456789abcdefghijklmnopqrst");
+
+  JS::BasicCompactString<47> wide(std::string(47, 'c'));
+  REQUIRE(wide.isInline());
+  REQUIRE(wide.size() == 47);
+}
+
+const char account_json[] = R"json({
+  "id": "8d0f43a4-9a6f-4c2e-9e68-1b1f5e5fdd2c",
+  "code": "ACC-2024-000123",
+  "description": "Tab\tand \"quotes\" æ \/ \\"
+})json";
+
+TEST_CASE("compact_string_parse_serialize", "[json_struct][compact_string]")
+{
+  Account account;
+  JS::ParseContext context(account_json);
+  REQUIRE(context.parseTo(account) == JS::Error::NoError);
+
+  REQUIRE(account.id == "8d0f43a4-9a6f-4c2e-9e68-1b1f5e5fdd2c");
+  REQUIRE(!account.id.isInline());
+  REQUIRE(account.code == "ACC-2024-000123");
+  REQUIRE(account.code.isInline());
+  REQUIRE(account.description == "Tab\tand \"quotes\" \xc3\xa6 / \\");
+
+  std::string json = JS::serializeStruct(account, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(json == R"({"id":"8d0f43a4-9a6f-4c2e-9e68-1b1f5e5fdd2c","code":"ACC-2024-000123",)"
+                  R"("description":"Tab\tand \"quotes\" )"
+                  "\xc3\xa6"
+                  R"( / \\"})");
+
+  Account roundtrip;
+  JS::ParseContext roundtrip_context(json);
+  REQUIRE(roundtrip_context.parseTo(roundtrip) == JS::Error::NoError);
+  REQUIRE(roundtrip.description == account.description);
+}
+
+TEST_CASE("compact_string_vector", "[json_struct][compact_string]")
+{
+  std::vector<JS::CompactString> codes;
+  JS::ParseContext context(R"(["a", "bb", "a-much-longer-value-that-lives-on-the-heap", ""])");
+  REQUIRE(context.parseTo(codes) == JS::Error::NoError);
+  REQUIRE(codes.size() == 4);
+  REQUIRE(codes[1] == "bb");
+  REQUIRE(codes[2] == "a-much-longer-value-that-lives-on-the-heap");
+  REQUIRE(codes[3].empty());
+  REQUIRE(JS::serializeStruct(codes, JS::SerializerOptions(JS::SerializerOptions::Compact)) ==
+          R"(["a","bb","a-much-longer-value-that-lives-on-the-heap",""])");
+}
+} // namespace
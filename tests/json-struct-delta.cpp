@@ -0,0 +1,155 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Vec3
+{
+  JS::Tracked<double> x;
+  JS::Tracked<double> y;
+  JS::Tracked<double> z;
+  JS_OBJ(x, y, z);
+};
+
+struct Inventory
+{
+  JS::Tracked<std::vector<int>> items;
+  JS::Tracked<int> gold;
+  JS_OBJ(items, gold);
+};
+
+struct Entity
+{
+  JS::Tracked<std::string> name;
+  int id = 0;
+  JS_OBJ(name, id);
+};
+
+struct Player : Entity
+{
+  JS::Tracked<int> health;
+  Vec3 position;
+  JS::Tracked<Inventory> inventory;
+  JS_OBJ_SUPER(JS_SUPER_CLASSES(JS_SUPER_CLASS(Entity)), health, position, inventory);
+};
+
+const char player_json[] = R"json({
+  "name": "ranger",
+  "id": 7,
+  "health": 100,
+  "position": { "x": 1 },
+  "inventory": { "items": [1, 2, 3], "gold": 10 }
+})json";
+
+TEST_CASE("delta_clean_object", "[json_struct][delta]")
+{
+  Player player;
+  JS::ParseContext context(player_json);
+  REQUIRE(context.parseTo(player) == JS::Error::NoError);
+  JS::clearDirty(player);
+  REQUIRE(!JS::isDirty(player));
+  REQUIRE(!player.inventory.isDirty());
+  REQUIRE(!player.inventory.get().gold.isDirty());
+  REQUIRE(JS::serializeDelta(player, JS::SerializerOptions(JS::SerializerOptions::Compact)) == "{}");
+}
+
+TEST_CASE("delta_dirty_members", "[json_struct][delta]")
+{
+  const JS::SerializerOptions compact(JS::SerializerOptions::Compact);
+  Player player;
+  JS::ParseContext context(player_json);
+  REQUIRE(context.parseTo(player) == JS::Error::NoError);
+  JS::clearDirty(player);
+
+  player.health = 90;
+  REQUIRE(JS::isDirty(player));
+  REQUIRE(JS::serializeDelta(player, compact) == R"({"health":90})");
+
+  player.position.y = 2.5;
+  REQUIRE(JS::serializeDelta(player, compact) == R"({"health":90,"position":{"y":2.5}})");
+
+  player.name = "scout";
+  REQUIRE(JS::serializeDelta(player, compact) == R"({"health":90,"position":{"y":2.5},"name":"scout"})");
+
+  JS::clearDirty(player);
+  REQUIRE(JS::serializeDelta(player, compact) == "{}");
+
+  // set() only marks the value dirty when it changes
+  REQUIRE(!player.health.set(90));
+  REQUIRE(!JS::isDirty(player));
+  REQUIRE(player.health.set(80));
+  REQUIRE(JS::serializeDelta(player, compact) == R"({"health":80})");
+}
+
+TEST_CASE("delta_tracked_objects", "[json_struct][delta]")
+{
+  const JS::SerializerOptions compact(JS::SerializerOptions::Compact);
+  Player player;
+  JS::ParseContext context(player_json);
+  REQUIRE(context.parseTo(player) == JS::Error::NoError);
+  JS::clearDirty(player);
+
+  // A dirty Tracked object is written in full, also its clean members
+  Inventory copy = player.inventory.get();
+  copy.gold = 11;
+  JS::clearDirty(copy);
+  player.inventory = copy;
+  REQUIRE(JS::serializeDelta(player, compact) == R"({"inventory":{"items":[1,2,3],"gold":11}})");
+
+  // A clean Tracked object with dirty members only writes those members
+  JS::clearDirty(player);
+  player.inventory.edit().gold = 12;
+  player.inventory.clearDirty();
+  REQUIRE(JS::serializeDelta(player, compact) == R"({"inventory":{"gold":12}})");
+
+  JS::clearDirty(player);
+  player.inventory.edit().items.edit().push_back(4);
+  player.inventory.clearDirty();
+  REQUIRE(JS::serializeDelta(player, compact) == R"({"inventory":{"items":[1,2,3,4]}})");
+}
+
+TEST_CASE("delta_apply", "[json_struct][delta]")
+{
+  Player server;
+  Player client;
+  JS::ParseContext server_context(player_json);
+  REQUIRE(server_context.parseTo(server) == JS::Error::NoError);
+  JS::ParseContext client_context(player_json);
+  REQUIRE(client_context.parseTo(client) == JS::Error::NoError);
+  JS::clearDirty(server);
+  JS::clearDirty(client);
+
+  server.health = 42;
+  server.position.z = -3;
+  server.inventory.edit().gold = 99;
+  server.inventory.clearDirty();
+  server.id = 8; // not tracked, so not sent
+
+  for (auto style : {JS::SerializerOptions::Pretty, JS::SerializerOptions::Compact})
+  {
+    const std::string delta = JS::serializeDelta(server, JS::SerializerOptions(style));
+    JS::ParseContext context(delta);
+    REQUIRE(context.parseTo(client) == JS::Error::NoError);
+  }
+  REQUIRE(client.health() == 42);
+  REQUIRE(client.position.z() == -3);
+  REQUIRE(client.position.x() == 1);
+  REQUIRE(client.inventory().gold() == 99);
+  REQUIRE(client.inventory().items() == std::vector<int>({1, 2, 3}));
+  REQUIRE(client.id == 7);
+  REQUIRE(client.name() == "ranger");
+
+  // Parsed values are dirty on the receiving side
+  REQUIRE(client.health.isDirty());
+  REQUIRE(!client.name.isDirty());
+
+  // serializeStruct is not affected by the tracking
+  REQUIRE(JS::serializeStruct(client, JS::SerializerOptions(JS::SerializerOptions::Compact)) ==
+          R"({"health":42,"position":{"x":1.0,"y":0.0,"z":-3.0},"inventory":{"items":[1,2,3],"gold":99},)"
+          R"("name":"ranger","id":7})");
+}
+
+} // namespace
@@ -0,0 +1,153 @@
+#define JS_STL_MAP
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Greeting
+{
+  std::string text;
+  JS::CompactString lang;
+  std::map<std::string, int> counts;
+  JS_OBJ(text, lang, counts);
+};
+
+JS::SerializerOptions asciiOptions(JS::SerializerOptions::Style style)
+{
+  JS::SerializerOptions options(style);
+  options.setEscapeNonAscii(true);
+  return options;
+}
+
+bool isSevenBit(const std::string &str)
+{
+  for (char c : str)
+  {
+    if (static_cast<unsigned char>(c) >= 0x80)
+      return false;
+  }
+  return true;
+}
+
+TEST_CASE("escape_non_ascii_code_points", "[json_struct][escape]")
+{
+  // U+00E9, U+20AC and U+1F600 are two, three and four byte UTF-8 sequences
+  std::string str = "caf\xc3\xa9 \"\xe2\x82\xac\"\n\xf0\x9f\x98\x80!";
+  std::string json = JS::serializeStruct(str, asciiOptions(JS::SerializerOptions::Compact));
+  REQUIRE(json == "\"caf\\u00e9 \\\"\\u20ac\\\"\\n\\ud83d\\ude00!\"");
+
+  REQUIRE(JS::serializeStruct(str, JS::SerializerOptions(JS::SerializerOptions::Compact)) ==
+          "\"caf\xc3\xa9 \\\"\xe2\x82\xac\\\"\\n\xf0\x9f\x98\x80!\"");
+}
+
+TEST_CASE("escape_non_ascii_invalid_utf8", "[json_struct][escape]")
+{
+  const JS::SerializerOptions options = asciiOptions(JS::SerializerOptions::Compact);
+  // Lone continuation byte, overlong '/', encoded surrogate, code point above 0x10ffff and a truncated sequence
+  REQUIRE(JS::serializeStruct(std::string("a\x80z"), options) == "\"a\\ufffdz\"");
+  REQUIRE(JS::serializeStruct(std::string("\xc0\xaf"), options) == "\"\\ufffd\\ufffd\"");
+  REQUIRE(JS::serializeStruct(std::string("\xed\xa0\x80"), options) == "\"\\ufffd\\ufffd\\ufffd\"");
+  REQUIRE(JS::serializeStruct(std::string("\xf4\x90\x80\x80"), options) == "\"\\ufffd\\ufffd\\ufffd\\ufffd\"");
+  REQUIRE(JS::serializeStruct(std::string("ok\xe2\x82"), options) == "\"ok\\ufffd\\ufffd\"");
+  REQUIRE(JS::serializeStruct(std::string("\xef\xbf\xbf\xf4\x8f\xbf\xbf"), options) == "\"\\uffff\\udbff\\udfff\"");
+}
+
+TEST_CASE("escape_non_ascii_block_boundaries", "[json_struct][escape]")
+{
+  const JS::SerializerOptions options = asciiOptions(JS::SerializerOptions::Compact);
+  for (size_t length : {1, 15, 16, 17, 31, 32, 33, 64, 65})
+  {
+    for (size_t pos = 0; pos < length; pos++)
+    {
+      std::string str(length, 'x');
+      str.insert(pos, "\xe2\x82\xac");
+      std::string expected = "\"" + std::string(length, 'x') + "\"";
+      expected.insert(pos + 1, "\\u20ac");
+      REQUIRE(JS::serializeStruct(str, options) == expected);
+    }
+  }
+}
+
+TEST_CASE("escape_non_ascii_roundtrip", "[json_struct][escape]")
+{
+  Greeting greeting;
+  for (int i = 0; i < 20; i++)
+    greeting.text += "Gr\xc3\xbc\xc3\x9f Gott \xe4\xbd\xa0\xe5\xa5\xbd \xf0\x9f\x8c\x8d\t";
+  greeting.lang = "de-\xc3\x96";
+  greeting.counts["\xc3\xa5r"] = 1;
+  greeting.counts["plain"] = 2;
+
+  for (auto style : {JS::SerializerOptions::Pretty, JS::SerializerOptions::Compact})
+  {
+    const JS::SerializerOptions options = asciiOptions(style);
+    const std::string json = JS::serializeStruct(greeting, options);
+    REQUIRE(isSevenBit(json));
+    REQUIRE(json.find("\"\\u00e5r\"") != std::string::npos);
+
+    for (size_t buffer_size : {1, 3, 7, 16})
+    {
+      std::vector<char> buffer(buffer_size);
+      std::string out;
+      JS::Serializer serializer(buffer.data(), buffer.size());
+      serializer.setOptions(options);
+      serializer.setRequestBufferCallback([&](JS::Serializer &s) {
+        out.append(buffer.data(), buffer.size());
+        s.setBuffer(buffer.data(), buffer.size());
+      });
+      JS::Token token;
+      JS::TypeHandler<Greeting>::from(greeting, token, serializer);
+      out.append(buffer.data(), serializer.currentBuffer().used);
+      REQUIRE(out == json);
+    }
+
+    Greeting parsed;
+    JS::ParseContext context(json);
+    REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+    REQUIRE(parsed.text == greeting.text);
+    REQUIRE(parsed.lang == greeting.lang);
+    REQUIRE(parsed.counts == greeting.counts);
+  }
+}
+
+struct Reading
+{
+  double temperature = 21.5;
+  std::string unit = "\xc2\xb0""C";
+  JS_OBJECT(JS_MEMBER_WITH_NAME(temperature, "temp\xc3\xa9rature"), JS_MEMBER(unit));
+};
+
+TEST_CASE("escape_non_ascii_member_names", "[json_struct][escape]")
+{
+  Reading reading;
+  REQUIRE(JS::serializeStruct(reading, asciiOptions(JS::SerializerOptions::Compact)) ==
+          "{\"temp\\u00e9rature\":21.5,\"unit\":\"\\u00b0C\"}");
+  REQUIRE(JS::serializeStruct(reading, asciiOptions(JS::SerializerOptions::Pretty)) ==
+          "{\n  \"temp\\u00e9rature\": 21.5,\n  \"unit\": \"\\u00b0C\"\n}");
+
+  // Without the option the pre-baked key is written as it is
+  REQUIRE(JS::serializeStruct(reading, JS::SerializerOptions(JS::SerializerOptions::Compact)) ==
+          "{\"temp\xc3\xa9rature\":21.5,\"unit\":\"\xc2\xb0""C\"}");
+
+  Reading parsed;
+  parsed.unit.clear();
+  const std::string json = JS::serializeStruct(reading, asciiOptions(JS::SerializerOptions::Pretty));
+  REQUIRE(isSevenBit(json));
+  JS::ParseContext context(json);
+  REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+  REQUIRE(parsed.unit == reading.unit);
+}
+
+TEST_CASE("escape_non_ascii_reformat", "[json_struct][escape]")
+{
+  // Strings taken from the input are already escaped, so only the non-ASCII bytes may change
+  const std::string input = "{\"n\xc3\xa4me\":\"a\\\"b\\u0041\xc3\xa9\",\"list\":[\"\xe2\x82\xac\",1]}";
+  std::string out;
+  REQUIRE(JS::reformat(input, out, asciiOptions(JS::SerializerOptions::Compact)) == JS::Error::NoError);
+  REQUIRE(out == "{\"n\\u00e4me\":\"a\\\"b\\u0041\\u00e9\",\"list\":[\"\\u20ac\",1]}");
+}
+
+} // namespace
@@ -0,0 +1,154 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+struct LogLine
+{
+  std::string message;
+  JS::CompactString tag;
+  int level = 0;
+  JS_OBJ(message, tag, level);
+};
+
+std::string escapeReference(const std::string &str)
+{
+  static const char hex[] = "0123456789abcdef";
+  std::string out;
+  for (char c : str)
+  {
+    unsigned char u = static_cast<unsigned char>(c);
+    switch (c)
+    {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\b':
+      out += "\\b";
+      break;
+    case '\f':
+      out += "\\f";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (u < 0x20)
+      {
+        out += "\\u00";
+        out += hex[u >> 4];
+        out += hex[u & 0xf];
+      }
+      else
+      {
+        out += c;
+      }
+    }
+  }
+  return out;
+}
+
+TEST_CASE("escape_out_all_control_characters", "[json_struct][escape]")
+{
+  std::string all;
+  for (int i = 0; i < 0x20; i++)
+    all.push_back(char(i));
+  all += "\"\\/abc";
+
+  std::string json = JS::serializeStruct(all, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(json == "\"" + escapeReference(all) + "\"");
+  REQUIRE(json.find("\\u000b") != std::string::npos);
+  REQUIRE(json.find("\\u001f") != std::string::npos);
+  for (char c : json)
+    REQUIRE(static_cast<unsigned char>(c) >= 0x20);
+
+  LogLine line;
+  line.message = all;
+  line.tag.assign(all.data(), all.size());
+  const std::string line_json = JS::serializeStruct(line);
+  LogLine parsed;
+  JS::ParseContext context(line_json);
+  REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+  REQUIRE(parsed.message == all);
+  REQUIRE(parsed.tag.toString() == all);
+}
+
+TEST_CASE("escape_out_block_boundaries", "[json_struct][escape]")
+{
+  for (size_t length : {1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100})
+  {
+    for (size_t pos = 0; pos < length; pos++)
+    {
+      for (char special : {'\n', '"', '\x1e'})
+      {
+        std::string str(length, 'x');
+        str[pos] = special;
+        std::string json = JS::serializeStruct(str, JS::SerializerOptions(JS::SerializerOptions::Compact));
+        REQUIRE(json == "\"" + escapeReference(str) + "\"");
+      }
+    }
+  }
+}
+
+TEST_CASE("escape_out_small_buffers", "[json_struct][escape]")
+{
+  LogLine line;
+  for (int i = 0; i < 40; i++)
+    line.message += "line \"" + std::to_string(i) + "\"\twith\\escapes\n";
+  line.tag = "tag\x01\x7f";
+  line.level = 3;
+
+  for (auto style : {JS::SerializerOptions::Pretty, JS::SerializerOptions::Compact})
+  {
+    const std::string expected = JS::serializeStruct(line, JS::SerializerOptions(style));
+    REQUIRE(expected.find(escapeReference(line.message)) != std::string::npos);
+    REQUIRE(expected.find("tag\\u0001\x7f") != std::string::npos);
+
+    for (size_t buffer_size : {1, 2, 3, 5, 7, 16, 33})
+    {
+      std::vector<char> buffer(buffer_size);
+      std::string out;
+      JS::Serializer serializer(buffer.data(), buffer.size());
+      serializer.setOptions(JS::SerializerOptions(style));
+      serializer.setRequestBufferCallback([&](JS::Serializer &s) {
+        out.append(buffer.data(), buffer.size());
+        s.setBuffer(buffer.data(), buffer.size());
+      });
+      JS::Token token;
+      JS::TypeHandler<LogLine>::from(line, token, serializer);
+      out.append(buffer.data(), serializer.currentBuffer().used);
+      REQUIRE(out == expected);
+    }
+
+    LogLine parsed;
+    JS::ParseContext context(expected);
+    REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+    REQUIRE(parsed.message == line.message);
+    REQUIRE(parsed.tag == line.tag);
+    REQUIRE(parsed.level == line.level);
+  }
+}
+
+TEST_CASE("escape_out_fixed_buffer_overflow", "[json_struct][escape]")
+{
+  std::string str(100, '\n');
+  char buffer[64];
+  const size_t size =
+    JS::serializeTo(str, buffer, sizeof(buffer), JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(size == 202);
+  REQUIRE(std::string(buffer, sizeof(buffer)) == ("\"" + escapeReference(str)).substr(0, sizeof(buffer)));
+}
+
+} // namespace
@@ -24,6 +24,14 @@
 
 #include "catch2/catch_all.hpp"
 
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
 namespace
 {
 const char json_data[] = R"json(
@@ -52,4 +60,165 @@ TEST_CASE("json_struct_float", "[json_struct][float]")
   // context.parseTo(missing);
   // std::string out = JS::serializeStruct(missing);
 }
+static double parseDouble(const std::string &str)
+{
+  double d = 0.0;
+  const char *end;
+  REQUIRE(JS::Internal::ft::to_double(str.data(), str.size(), d, end) == JS::Internal::ft::parse_string_error::ok);
+  REQUIRE(end == str.data() + str.size());
+  return d;
+}
+
+static float parseFloat(const std::string &str)
+{
+  float f = 0.0f;
+  const char *end;
+  REQUIRE(JS::Internal::ft::to_float(str.data(), str.size(), f, end) == JS::Internal::ft::parse_string_error::ok);
+  return f;
+}
+
+static bool sameBits(double a, double b)
+{
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static bool sameBits(float a, float b)
+{
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+TEST_CASE("json_struct_float_edge_cases", "[json_struct][float]")
+{
+  const char *inputs[] = {"0.0000000000000000000001",
+                          "0.000000000000000000000123",
+                          "00000000000000000000000000001",
+                          "123456789012345678901234",
+                          "12345678901234567890123.5",
+                          "9007199254740993.0000000000000000001",
+                          "9007199254740993",
+                          "1.7976931348623157e308",
+                          "1.7976931348623159e308",
+                          "2.2250738585072011e-308",
+                          "4.9e-324",
+                          "2.4e-324",
+                          "2.5e-324",
+                          "1e23",
+                          "0e400",
+                          "-0.0e-400",
+                          "1e-400",
+                          "59.3293371",
+                          "18.0685808",
+                          "-0.000123456789012345678"};
+  for (const char *input : inputs)
+  {
+    INFO(input);
+    REQUIRE(sameBits(parseDouble(input), strtod(input, nullptr)));
+    REQUIRE(sameBits(parseFloat(input), strtof(input, nullptr)));
+  }
+}
+
+TEST_CASE("json_struct_float_random_roundtrip", "[json_struct][float]")
+{
+  std::mt19937_64 rng(1234);
+  char buffer[64];
+  for (int i = 0; i < 20000; i++)
+  {
+    uint64_t bits = rng();
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    if (d != d || d - d != 0.0)
+      continue;
+    snprintf(buffer, sizeof(buffer), i % 2 ? "%.17g" : "%.15g", d);
+    INFO(buffer);
+    REQUIRE(sameBits(parseDouble(buffer), strtod(buffer, nullptr)));
+    REQUIRE(sameBits(parseFloat(buffer), strtof(buffer, nullptr)));
+  }
+}
+
+TEST_CASE("json_struct_float_random_digits", "[json_struct][float]")
+{
+  std::mt19937_64 rng(4321);
+  for (int i = 0; i < 20000; i++)
+  {
+    std::string number;
+    if (rng() % 2)
+      number += '-';
+    int digits = 1 + int(rng() % 30);
+    int point = int(rng() % uint64_t(digits));
+    for (int d = 0; d < digits; d++)
+    {
+      if (d == point && d)
+        number += '.';
+      number += char('0' + rng() % 10);
+    }
+    if (rng() % 2)
+      number += "e" + std::to_string(int(rng() % 700) - 350);
+    INFO(number);
+    REQUIRE(sameBits(parseDouble(number), strtod(number.c_str(), nullptr)));
+    REQUIRE(sameBits(parseFloat(number), strtof(number.c_str(), nullptr)));
+  }
+}
+struct FloatFormatStruct
+{
+  double value;
+  float single;
+  JS::FormattedFloat<double, JS::FloatFormat::FixedDecimals, 2> price;
+  std::vector<double> list;
+  JS_OBJ(value, single, price, list);
+};
+
+TEST_CASE("json_struct_float_format_options", "[json_struct][float]")
+{
+  FloatFormatStruct data;
+  data.value = 12.3456789;
+  data.single = 0.1f;
+  data.price = 3.14159;
+  data.list = {2.5, 999.9999999, -0.0000001, 1e21};
+
+  JS::SerializerOptions options(JS::SerializerOptions::Compact);
+  REQUIRE(JS::serializeStruct(data, options) ==
+          R"({"value":12.3456789,"single":0.1,"price":3.14,"list":[2.5,999.9999999,-0.0000001,1e21]})");
+
+  options.setFloatFormat(JS::FloatFormat::FixedDecimals, 6);
+  REQUIRE(JS::serializeStruct(data, options) ==
+          R"({"value":12.345679,"single":0.1,"price":3.14,"list":[2.5,1000.0,0.0,1e21]})");
+
+  options.setFloatFormat(JS::FloatFormat::FixedDecimals, 0);
+  REQUIRE(JS::serializeStruct(data, options) ==
+          R"({"value":12.0,"single":0.0,"price":3.14,"list":[2.0,1000.0,0.0,1e21]})");
+
+  options.setFloatFormat(JS::FloatFormat::SignificantDigits, 3);
+  REQUIRE(JS::serializeStruct(data, options) ==
+          R"({"value":12.3,"single":0.1,"price":3.14,"list":[2.5,1000.0,-0.0000001,1e21]})");
+
+  std::string json = JS::serializeStruct(data);
+  FloatFormatStruct parsed;
+  JS::ParseContext context(json);
+  REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+  REQUIRE(parsed.price() == 3.14);
+}
+
+TEST_CASE("json_struct_float_format_random", "[json_struct][float]")
+{
+  std::mt19937_64 rng(2468);
+  char buffer[64];
+  char expected[512];
+  for (int i = 0; i < 20000; i++)
+  {
+    double value = std::ldexp(double(rng() >> 11), int(rng() % 120) - 110);
+    if (rng() % 2)
+      value = -value;
+    bool fixed = rng() % 2;
+    int precision = fixed ? int(rng() % 12) : 1 + int(rng() % 17);
+    int size = JS::Internal::ft::ryu::to_buffer_rounded(value, fixed, precision, buffer, int(sizeof(buffer)));
+    std::string result(buffer, size_t(size));
+    if (fixed)
+      snprintf(expected, sizeof(expected), "%.*f", precision, value);
+    else
+      snprintf(expected, sizeof(expected), "%.*e", precision - 1, value);
+    INFO(result);
+    INFO(expected);
+    REQUIRE(strtod(result.c_str(), nullptr) == strtod(expected, nullptr));
+  }
+}
 } // namespace
@@ -0,0 +1,69 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Person
+{
+  std::string name;
+  JS::InternedString eyeColor;
+  JS::InternedString favoriteFruit;
+  JS_OBJ(name, eyeColor, favoriteFruit);
+};
+
+const char people_json[] = R"json([
+  { "name": "Ann", "eyeColor": "brown", "favoriteFruit": "apple" },
+  { "name": "Bob", "eyeColor": "blue", "favoriteFruit": "banana" },
+  { "name": "Cid", "eyeColor": "brown", "favoriteFruit": "banana" }
+])json";
+
+TEST_CASE("interned_string_parse", "[json_struct][intern]")
+{
+  JS::InternPool pool;
+  std::vector<Person> people;
+  JS::ParseContext context(people_json);
+  context.intern_pool = &pool;
+  REQUIRE(context.parseTo(people) == JS::Error::NoError);
+
+  REQUIRE(people.size() == 3);
+  REQUIRE(pool.size() == 4);
+  REQUIRE(people[0].eyeColor.str == people[2].eyeColor.str);
+  REQUIRE(people[1].favoriteFruit.str == people[2].favoriteFruit.str);
+  REQUIRE(people[2].favoriteFruit.toString() == "banana");
+  REQUIRE(people[0].eyeColor != people[1].eyeColor);
+  REQUIRE(sizeof(JS::InternedString) == sizeof(void *));
+
+  std::string json = JS::serializeStruct(people[2], JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(json == R"({"name":"Cid","eyeColor":"brown","favoriteFruit":"banana"})");
+}
+
+TEST_CASE("intern_pool_growth", "[json_struct][intern]")
+{
+  JS::InternPool pool;
+  std::vector<const std::string *> first;
+  for (int i = 0; i < 1000; i++)
+    first.push_back(pool.intern(std::to_string(i)));
+  REQUIRE(pool.size() == 1000);
+  for (int i = 0; i < 1000; i++)
+  {
+    REQUIRE(pool.intern(std::to_string(i)) == first[i]);
+    REQUIRE(*first[i] == std::to_string(i));
+  }
+  REQUIRE(pool.size() == 1000);
+}
+
+TEST_CASE("interned_string_without_pool", "[json_struct][intern]")
+{
+  Person person;
+  JS::ParseContext context(R"json({ "name": "Ann", "eyeColor": "brown" })json");
+  REQUIRE(context.parseTo(person) == JS::Error::IllegalDataValue);
+  REQUIRE(context.makeErrorString().find("intern_pool") != std::string::npos);
+
+  Person empty;
+  REQUIRE(JS::serializeStruct(empty, JS::SerializerOptions(JS::SerializerOptions::Compact)) ==
+          R"({"name":"","eyeColor":"","favoriteFruit":""})");
+}
+} // namespace
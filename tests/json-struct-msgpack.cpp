@@ -0,0 +1,301 @@
+#define JS_STL_MAP
+#define JS_STL_ARRAY
+#define JS_STL_SET
+#define JS_STL_UNORDERED_SET
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+#include "binary-test-util.h"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+JS_ENUM(Shape, Circle, Square, Triangle);
+JS_ENUM_DECLARE_STRING_PARSER(Shape);
+
+namespace
+{
+struct Point
+{
+  int x = 0;
+  int y = 0;
+  JS_OBJ(x, y);
+};
+
+struct Node
+{
+  std::string id;
+  uint32_t version = 0;
+  JS_OBJ(id, version);
+};
+
+struct Drawing : Node
+{
+  Shape shape = Shape::Circle;
+  double scale = 1.0;
+  float alpha = 1.0f;
+  bool visible = false;
+  int64_t stamp = 0;
+  std::vector<Point> points;
+  std::map<std::string, std::vector<int16_t>> layers;
+  JS::OptionalChecked<int> z_order;
+  std::unique_ptr<Drawing> overlay;
+  uint8_t rgb[3] = {0, 0, 0};
+  std::array<char, 2> flags = {{0, 0}};
+  JS::CompactString label;
+  JS::Tracked<int> revision;
+  JS_OBJ_SUPER(JS_SUPER_CLASSES(JS_SUPER_CLASS(Node)), shape, scale, alpha, visible, stamp, points, layers, z_order,
+               overlay, rgb, flags, label, revision);
+};
+
+struct Renamed
+{
+  int value = 0;
+  int other = 0;
+  JS_OBJECT(JS_MEMBER_ALIASES(value, "old_value"), JS_MEMBER(other));
+};
+
+struct Small
+{
+  uint8_t byte = 0;
+  JS_OBJ(byte);
+};
+
+#ifdef JS_STD_OPTIONAL
+struct WithOptional
+{
+  std::optional<std::string> name;
+  std::optional<int> count;
+  JS_OBJ(name, count);
+};
+#endif
+
+const char drawing_json[] = R"json({
+  "id": "drawing-1",
+  "version": 70000,
+  "shape": "Triangle",
+  "scale": -0.125,
+  "alpha": 0.5,
+  "visible": true,
+  "stamp": -5000000000,
+  "points": [ { "x": 1, "y": -2 }, { "x": 300, "y": -40000 }, { "x": 2147483647, "y": -2147483648 } ],
+  "layers": { "background": [ -1, 2, -32768, 32767 ], "empty": [] },
+  "z_order": 4,
+  "overlay": { "id": "overlay" },
+  "rgb": [ 255, 0, 128 ],
+  "flags": [ 0, 120 ],
+  "label": "a label that does not fit inline",
+  "revision": 12
+})json";
+
+TEST_CASE("msgpack_integer_encodings", "[json_struct][msgpack]")
+{
+  REQUIRE(JS::serializeMsgpack(0) == bytes({0x00}));
+  REQUIRE(JS::serializeMsgpack(127) == bytes({0x7f}));
+  REQUIRE(JS::serializeMsgpack(128) == bytes({0xcc, 0x80}));
+  REQUIRE(JS::serializeMsgpack(256) == bytes({0xcd, 0x01, 0x00}));
+  REQUIRE(JS::serializeMsgpack(65536) == bytes({0xce, 0x00, 0x01, 0x00, 0x00}));
+  REQUIRE(JS::serializeMsgpack(uint64_t(1) << 32) == bytes({0xcf, 0, 0, 0, 1, 0, 0, 0, 0}));
+  REQUIRE(JS::serializeMsgpack(-1) == bytes({0xff}));
+  REQUIRE(JS::serializeMsgpack(-32) == bytes({0xe0}));
+  REQUIRE(JS::serializeMsgpack(-33) == bytes({0xd0, 0xdf}));
+  REQUIRE(JS::serializeMsgpack(-129) == bytes({0xd1, 0xff, 0x7f}));
+  REQUIRE(JS::serializeMsgpack(-32769) == bytes({0xd2, 0xff, 0xff, 0x7f, 0xff}));
+  REQUIRE(JS::serializeMsgpack(int64_t(-2147483647) - 2) ==
+          bytes({0xd3, 0xff, 0xff, 0xff, 0xff, 0x7f, 0xff, 0xff, 0xff}));
+
+  for (int64_t value : {int64_t(0), int64_t(-1), int64_t(-32), int64_t(-33), int64_t(127), int64_t(128), int64_t(-128),
+                        int64_t(-129), int64_t(65535), int64_t(-32768), int64_t(4294967295), int64_t(-4294967296),
+                        std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()})
+  {
+    int64_t parsed = 1;
+    REQUIRE(JS::parseMsgpack(JS::serializeMsgpack(value), parsed) == JS::Error::NoError);
+    REQUIRE(parsed == value);
+  }
+  uint64_t max = 0;
+  REQUIRE(JS::parseMsgpack(JS::serializeMsgpack(std::numeric_limits<uint64_t>::max()), max) == JS::Error::NoError);
+  REQUIRE(max == std::numeric_limits<uint64_t>::max());
+
+  // Values are range checked against the type they are read into
+  Small small;
+  REQUIRE(JS::parseMsgpack(bytes({0x81, 0xa4, 'b', 'y', 't', 'e', 0xcd, 0x01, 0x00}), small) ==
+          JS::Error::FailedToParseInt);
+  REQUIRE(JS::parseMsgpack(bytes({0x81, 0xa4, 'b', 'y', 't', 'e', 0xff}), small) == JS::Error::FailedToParseInt);
+  REQUIRE(JS::parseMsgpack(bytes({0x81, 0xa4, 'b', 'y', 't', 'e', 0xd1, 0x00, 0xff}), small) == JS::Error::NoError);
+  REQUIRE(small.byte == 255);
+  int16_t narrow = 0;
+  REQUIRE(JS::parseMsgpack(bytes({0xd2, 0xff, 0xff, 0x7f, 0xff}), narrow) == JS::Error::FailedToParseInt);
+}
+
+TEST_CASE("msgpack_other_encodings", "[json_struct][msgpack]")
+{
+  REQUIRE(JS::serializeMsgpack(true) == bytes({0xc3}));
+  REQUIRE(JS::serializeMsgpack(1.5) == bytes({0xcb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0}));
+  REQUIRE(JS::serializeMsgpack(1.5f) == bytes({0xca, 0x3f, 0xc0, 0, 0}));
+  REQUIRE(JS::serializeMsgpack(std::string("abc")) == bytes({0xa3, 'a', 'b', 'c'}));
+  REQUIRE(JS::serializeMsgpack(std::string(31, 'x')).substr(0, 1) == bytes({0xbf}));
+  REQUIRE(JS::serializeMsgpack(std::string(32, 'x')).substr(0, 2) == bytes({0xd9, 0x20}));
+  REQUIRE(JS::serializeMsgpack(std::string(256, 'x')).substr(0, 3) == bytes({0xda, 0x01, 0x00}));
+  REQUIRE(JS::serializeMsgpack(std::string(65536, 'x')).substr(0, 5) == bytes({0xdb, 0x00, 0x01, 0x00, 0x00}));
+  REQUIRE(JS::serializeMsgpack(std::vector<int>(15, 1)).substr(0, 1) == bytes({0x9f}));
+  REQUIRE(JS::serializeMsgpack(std::vector<int>(16, 1)).substr(0, 3) == bytes({0xdc, 0x00, 0x10}));
+  REQUIRE(JS::serializeMsgpack(Shape::Square) == bytes({0x01}));
+
+  std::unique_ptr<int> null;
+  REQUIRE(JS::serializeMsgpack(null) == bytes({0xc0}));
+
+  // Integers are accepted where floating point values are expected
+  double d = 0;
+  REQUIRE(JS::parseMsgpack(bytes({0xd0, 0x80}), d) == JS::Error::NoError);
+  REQUIRE(d == -128.0);
+  float f = 0;
+  REQUIRE(JS::parseMsgpack(bytes({0xcb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0}), f) == JS::Error::NoError);
+  REQUIRE(f == 1.5f);
+}
+
+struct Attachment
+{
+  std::set<std::string> tags;
+  std::unordered_set<int> owners;
+  JS::Base64Bytes blob;
+  JS::InternedString kind;
+  JS_OBJ(tags, owners, blob, kind);
+};
+
+TEST_CASE("msgpack_sets_bytes_and_interned", "[json_struct][msgpack]")
+{
+  REQUIRE(JS::serializeMsgpack(JS::Base64Bytes({1, 2, 3})) == bytes({0xc4, 0x03, 0x01, 0x02, 0x03}));
+  REQUIRE(JS::serializeMsgpack(JS::Base64Bytes(std::vector<uint8_t>(256))).substr(0, 3) == bytes({0xc5, 0x01, 0x00}));
+  REQUIRE(JS::serializeMsgpack(std::set<int>{3, 1, 2}) == bytes({0x93, 0x01, 0x02, 0x03}));
+
+  JS::InternPool pool;
+  Attachment attachment;
+  attachment.tags = {"b", "a"};
+  attachment.owners = {7, 9};
+  attachment.blob.data = {0x00, 0xff, 0x10};
+  attachment.kind = JS::InternedString(pool.intern("image"));
+  const std::string data = JS::serializeMsgpack(attachment);
+  REQUIRE(data.find(bytes({0xa4, 'k', 'i', 'n', 'd', 0xa5, 'i', 'm', 'a', 'g', 'e'})) != std::string::npos);
+
+  // There is no InternPool to read InternedString into, the members before it are read
+  Attachment parsed;
+  parsed.tags.insert("stale");
+  REQUIRE(JS::parseMsgpack(data, parsed) == JS::Error::IllegalDataValue);
+  REQUIRE(parsed.tags == attachment.tags);
+  REQUIRE(parsed.owners == attachment.owners);
+  REQUIRE(parsed.blob.data == attachment.blob.data);
+
+  JS::Base64Bytes blob;
+  REQUIRE(JS::parseMsgpack(bytes({0xa1, 'x'}), blob) == JS::Error::IllegalDataValue);
+  REQUIRE(JS::parseMsgpack(bytes({0xc4, 0x02, 0x01}), blob) == JS::Error::NeedMoreData);
+}
+
+TEST_CASE("msgpack_member_keys", "[json_struct][msgpack]")
+{
+  Point point;
+  point.x = 1;
+  point.y = 2;
+  REQUIRE(JS::serializeMsgpack(point) == bytes({0x82, 0xa1, 'x', 0x01, 0xa1, 'y', 0x02}));
+  REQUIRE(JS::serializeMsgpack(point, JS::KeyStyle::Indices) == bytes({0x82, 0x00, 0x01, 0x01, 0x02}));
+
+  // Super class members are indexed after the members of the type itself
+  Drawing drawing;
+  const std::string indexed = JS::serializeMsgpack(drawing, JS::KeyStyle::Indices);
+  REQUIRE(indexed.find(bytes({0x0d, 0xa0, 0x0e, 0x00})) != std::string::npos);
+
+  // Members in any order, aliases, and unknown members of every kind that have to be skipped
+  const std::string data = bytes({0x86, 0xa5, 'o', 't', 'h', 'e', 'r', 0x07, 0xa7, 'u', 'n', 'k', 'n', 'o', 'w',
+                                  'n', 0x82, 0xa1, 'a', 0x93, 0xc0, 0xc3, 0xcb, 0, 0, 0, 0, 0, 0, 0, 0, 0xa1, 'b',
+                                  0xc4, 0x02, 0x01, 0x02, 0xa9, 'o', 'l', 'd', '_', 'v', 'a', 'l', 'u', 'e', 0x05,
+                                  0xa1, 'e', 0xd6, 0x01, 0, 0, 0, 0, 0xa1, 'f', 0xc7, 0x01, 0x02, 0x00, 0xa1, 'g',
+                                  0xdc, 0x00, 0x01, 0xd9, 0x01, 'h'});
+  Renamed renamed;
+  REQUIRE(JS::parseMsgpack(data, renamed) == JS::Error::NoError);
+  REQUIRE(renamed.value == 5);
+  REQUIRE(renamed.other == 7);
+
+  Renamed by_index;
+  REQUIRE(JS::parseMsgpack(bytes({0x82, 0x01, 0x03, 0x05, 0x04}), by_index) == JS::Error::NoError);
+  REQUIRE(by_index.value == 0);
+  REQUIRE(by_index.other == 3);
+}
+
+TEST_CASE("msgpack_roundtrip", "[json_struct][msgpack]")
+{
+  Drawing drawing;
+  JS::ParseContext context(drawing_json);
+  REQUIRE(context.parseTo(drawing) == JS::Error::NoError);
+  const std::string json = JS::serializeStruct(drawing);
+
+  for (auto keys : {JS::KeyStyle::Names, JS::KeyStyle::Indices})
+  {
+    const std::string data = JS::serializeMsgpack(drawing, keys);
+    Drawing parsed;
+    REQUIRE(JS::parseMsgpack(data, parsed) == JS::Error::NoError);
+    REQUIRE(JS::serializeStruct(parsed) == json);
+    REQUIRE(parsed.z_order.assigned);
+    REQUIRE(!parsed.overlay->z_order.assigned);
+    REQUIRE(!parsed.overlay->overlay);
+    REQUIRE(parsed.revision.isDirty());
+
+    // Appends to nothing, the output string is replaced
+    std::string out = "previous";
+    JS::serializeMsgpack(drawing, out, keys);
+    REQUIRE(out == data);
+  }
+  REQUIRE(JS::serializeMsgpack(drawing, JS::KeyStyle::Indices).size() < JS::serializeMsgpack(drawing).size());
+}
+
+TEST_CASE("msgpack_invalid_data", "[json_struct][msgpack]")
+{
+  Drawing drawing;
+  JS::ParseContext context(drawing_json);
+  REQUIRE(context.parseTo(drawing) == JS::Error::NoError);
+  const std::string data = JS::serializeMsgpack(drawing);
+
+  // Every truncation is an error, and never reads past the end
+  for (size_t size = 0; size < data.size(); size++)
+  {
+    std::vector<char> copy(data.begin(), data.begin() + ptrdiff_t(size));
+    Drawing parsed;
+    REQUIRE(JS::parseMsgpack(copy.data(), copy.size(), parsed) != JS::Error::NoError);
+  }
+
+  Drawing parsed;
+  REQUIRE(JS::parseMsgpack(data + bytes({0x00}), parsed) == JS::Error::InvalidToken);
+
+  Point point;
+  REQUIRE(JS::parseMsgpack(bytes({0x92, 0x01, 0x02}), point) == JS::Error::ExpectedObjectStart);
+  REQUIRE(JS::parseMsgpack(bytes({0x81, 0xa1, 'x', 0xa1, '1'}), point) == JS::Error::FailedToParseInt);
+  REQUIRE(JS::parseMsgpack(bytes({0x81, 0xa1, 'z', 0xc1}), point) == JS::Error::InvalidToken);
+  REQUIRE(JS::parseMsgpack(bytes({0x81, 0xc3, 0x01}), point) == JS::Error::IllegalPropertyName);
+
+  std::vector<int> list;
+  REQUIRE(JS::parseMsgpack(bytes({0xdd, 0xff, 0xff, 0xff, 0xff, 0x01}), list) == JS::Error::NeedMoreData);
+  bool flag;
+  REQUIRE(JS::parseMsgpack(bytes({0x01}), flag) == JS::Error::FailedToParseBoolean);
+  std::string str;
+  REQUIRE(JS::parseMsgpack(bytes({0x01}), str) == JS::Error::IllegalDataValue);
+}
+
+#ifdef JS_STD_OPTIONAL
+TEST_CASE("msgpack_std_optional", "[json_struct][msgpack]")
+{
+  WithOptional value;
+  value.count = 3;
+  REQUIRE(JS::serializeMsgpack(value) ==
+          bytes({0x82, 0xa4, 'n', 'a', 'm', 'e', 0xc0, 0xa5, 'c', 'o', 'u', 'n', 't', 0x03}));
+
+  WithOptional parsed;
+  parsed.name = "set";
+  REQUIRE(JS::parseMsgpack(JS::serializeMsgpack(value), parsed) == JS::Error::NoError);
+  REQUIRE(!parsed.name);
+  REQUIRE(parsed.count == 3);
+}
+#endif
+
+} // namespace
@@ -0,0 +1,147 @@
+#define JS_STL_ARRAY
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct NumberArrays
+{
+  std::vector<double> doubles;
+  std::vector<int64_t> integers;
+  std::vector<float> floats;
+  int fixed[3] = {};
+  std::array<uint16_t, 2> std_fixed = {};
+  JS_OBJ(doubles, integers, floats, fixed, std_fixed);
+};
+
+const char number_arrays_json[] = R"json({
+  "doubles": [ 1.5, -2.25e3, 0, 1e-7 ],
+  "integers": [-9223372036854775807, 42 ,0],
+  "floats": [],
+  "fixed": [1,2,3],
+  "std_fixed": [ 65535, 7 ]
+})json";
+
+TEST_CASE("number_array_parse", "[json_struct][array]")
+{
+  NumberArrays arrays;
+  arrays.doubles.push_back(99.0);
+  JS::ParseContext context(number_arrays_json);
+  REQUIRE(context.parseTo(arrays) == JS::Error::NoError);
+
+  REQUIRE(arrays.doubles == std::vector<double>{1.5, -2250.0, 0.0, 1e-7});
+  REQUIRE(arrays.integers == std::vector<int64_t>{-9223372036854775807, 42, 0});
+  REQUIRE(arrays.floats.empty());
+  REQUIRE(arrays.fixed[0] == 1);
+  REQUIRE(arrays.fixed[1] == 2);
+  REQUIRE(arrays.fixed[2] == 3);
+  REQUIRE(arrays.std_fixed[0] == 65535);
+  REQUIRE(arrays.std_fixed[1] == 7);
+}
+
+TEST_CASE("number_array_serialize", "[json_struct][array]")
+{
+  NumberArrays arrays;
+  arrays.doubles = {1.5, -2250.0, 0.0};
+  arrays.integers = {-9223372036854775807, 42};
+  arrays.fixed[1] = -4;
+  arrays.std_fixed[0] = 9;
+
+  std::string compact = JS::serializeStruct(arrays, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(compact == R"({"doubles":[1.5,-2250.0,0.0],"integers":[-9223372036854775807,42],"floats":[],"fixed":[0,-4,0],)"
+                     R"("std_fixed":[9,0]})");
+
+  std::string pretty = JS::serializeStruct(arrays);
+  NumberArrays parsed;
+  JS::ParseContext context(pretty);
+  REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+  REQUIRE(parsed.doubles == arrays.doubles);
+  REQUIRE(parsed.integers == arrays.integers);
+  REQUIRE(parsed.fixed[1] == -4);
+  REQUIRE(parsed.std_fixed[0] == 9);
+}
+
+TEST_CASE("number_array_large_roundtrip", "[json_struct][array]")
+{
+  std::vector<double> doubles;
+  std::vector<int64_t> integers;
+  for (int i = 0; i < 5000; i++)
+  {
+    doubles.push_back(i * 1.0001 - 17.5);
+    integers.push_back(int64_t(i) * 1000003 * (i % 2 ? -1 : 1));
+  }
+  NumberArrays arrays;
+  arrays.doubles = doubles;
+  arrays.integers = integers;
+  std::string json = JS::serializeStruct(arrays, JS::SerializerOptions(JS::SerializerOptions::Compact));
+
+  NumberArrays parsed;
+  JS::ParseContext context(json);
+  REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+  REQUIRE(parsed.doubles == doubles);
+  REQUIRE(parsed.integers == integers);
+}
+
+struct MixedArrays
+{
+  std::vector<double> values;
+  std::vector<int> more;
+  JS_OBJ(values, more);
+};
+
+TEST_CASE("number_array_falls_back_to_tokens", "[json_struct][array]")
+{
+  const char json[] = R"json({
+  "values": [ 1.0, 2.0,
+    3.0 ],
+  "more": [ 4, 5, ]
+})json";
+  MixedArrays arrays;
+  JS::ParseContext context(json);
+  context.tokenizer.allowSuperfluousComma(true);
+  REQUIRE(context.parseTo(arrays) == JS::Error::NoError);
+  REQUIRE(arrays.values == std::vector<double>{1.0, 2.0, 3.0});
+  REQUIRE(arrays.more == std::vector<int>{4, 5});
+}
+
+TEST_CASE("number_array_split_buffers", "[json_struct][array]")
+{
+  const char part1[] = R"json({ "values": [ 1.0, 2.5, 3)json";
+  const char part2[] = R"json(.75, 4 ], "more": [ 6, 7 ] })json";
+  MixedArrays arrays;
+  JS::ParseContext context;
+  context.tokenizer.addData(part1, sizeof(part1) - 1);
+  context.tokenizer.addData(part2, sizeof(part2) - 1);
+  REQUIRE(context.parseTo(arrays) == JS::Error::NoError);
+  REQUIRE(arrays.values == std::vector<double>{1.0, 2.5, 3.75, 4.0});
+  REQUIRE(arrays.more == std::vector<int>{6, 7});
+}
+
+TEST_CASE("number_array_errors", "[json_struct][array]")
+{
+  {
+    MixedArrays arrays;
+    JS::ParseContext context(R"json({ "values": [ 1.0, "x", 3.0 ], "more": [] })json");
+    REQUIRE(context.parseTo(arrays) != JS::Error::NoError);
+  }
+  {
+    NumberArrays arrays;
+    JS::ParseContext context(R"json({ "fixed": [ 1, 2, 3, 4 ] })json");
+    REQUIRE(context.parseTo(arrays) == JS::Error::ExpectedArrayEnd);
+  }
+  {
+    NumberArrays arrays;
+    JS::ParseContext context(R"json({ "fixed": [ 1, 2 ] })json");
+    REQUIRE(context.parseTo(arrays) == JS::Error::FailedToParseInt);
+  }
+  {
+    MixedArrays arrays;
+    JS::ParseContext context(R"json({ "values": [ 1.0, 2.0 )json");
+    REQUIRE(context.parseTo(arrays) != JS::Error::NoError);
+  }
+}
+} // namespace
@@ -0,0 +1,186 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define JS_POSIX_SINKS
+#endif
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Item
+{
+  std::string name;
+  int count = 0;
+  std::vector<double> values = {0.25, -1.5};
+  JS_OBJ(name, count, values);
+};
+
+template <typename Sink>
+bool serializeToSink(const std::vector<Item> &items, Sink &sink)
+{
+  JS::Serializer serializer;
+  serializer.setOptions(JS::SerializerOptions(JS::SerializerOptions::Compact));
+  sink.attach(serializer);
+  JS::Token token;
+  JS::TypeHandler<std::vector<Item>>::from(items, token, serializer);
+  return sink.finish(serializer);
+}
+
+std::string expectedJson(const std::vector<Item> &items)
+{
+  return JS::serializeStruct(items, JS::SerializerOptions(JS::SerializerOptions::Compact));
+}
+
+TEST_CASE("output_sink_buffer", "[json_struct][sink]")
+{
+  std::vector<Item> items(200);
+  for (size_t i = 0; i < items.size(); i++)
+    items[i].name = "item " + std::to_string(i);
+  JS::BufferSink sink(7);
+  REQUIRE(serializeToSink(items, sink));
+  REQUIRE(sink.toString() == expectedJson(items));
+
+  sink.clear();
+  std::vector<Item> small(2);
+  for (size_t i = 0; i < small.size(); i++)
+    small[i].name = "item " + std::to_string(i);
+  REQUIRE(serializeToSink(small, sink));
+  REQUIRE(sink.toString() == expectedJson(small));
+}
+
+TEST_CASE("output_sink_fixed_buffer", "[json_struct][sink]")
+{
+  std::vector<Item> items(20);
+  for (size_t i = 0; i < items.size(); i++)
+    items[i].name = "item " + std::to_string(i);
+  std::string expected = expectedJson(items);
+
+  std::vector<char> exact(expected.size());
+  JS::FixedBufferSink exact_sink(exact.data(), exact.size());
+  REQUIRE(serializeToSink(items, exact_sink));
+  REQUIRE(!exact_sink.overflow());
+  REQUIRE(std::string(exact.data(), exact_sink.size()) == expected);
+
+  std::vector<char> small(expected.size() - 1);
+  JS::FixedBufferSink small_sink(small.data(), small.size());
+  REQUIRE(!serializeToSink(items, small_sink));
+  REQUIRE(small_sink.overflow());
+  REQUIRE(small_sink.size() == small.size());
+  REQUIRE(std::string(small.data(), small.size()) == expected.substr(0, small.size()));
+}
+
+TEST_CASE("output_sink_segmented", "[json_struct][sink]")
+{
+  std::vector<Item> items(100);
+  for (size_t i = 0; i < items.size(); i++)
+    items[i].name = "item " + std::to_string(i);
+  std::string expected = expectedJson(items);
+  JS::SegmentedSink sink(64);
+  REQUIRE(serializeToSink(items, sink));
+  REQUIRE(sink.size() == expected.size());
+  REQUIRE(sink.segmentCount() == (expected.size() + 63) / 64);
+  std::string joined;
+  for (size_t i = 0; i < sink.segmentCount(); i++)
+    joined.append(sink.segment(i).data, sink.segment(i).size);
+  REQUIRE(joined == expected);
+  REQUIRE(sink.toString() == expected);
+}
+
+TEST_CASE("output_sink_string_serialize_repeated", "[json_struct][sink]")
+{
+  std::string json;
+  std::string expected;
+  {
+    JS::SerializerContext context(json, JS::SerializerOptions(JS::SerializerOptions::Compact));
+    for (size_t n = 1; n < 400; n += 80)
+    {
+      std::vector<Item> items(n);
+      for (size_t i = 0; i < items.size(); i++)
+        items[i].name = "item " + std::to_string(i);
+      context.serialize(items);
+      // The serializer separates consecutive values with a comma
+      if (!expected.empty())
+        expected += ',';
+      expected += expectedJson(items);
+      REQUIRE(json == expected);
+    }
+  }
+  REQUIRE(json == expected);
+}
+
+std::string readFile(FILE *file)
+{
+  std::string content;
+  rewind(file);
+  char buffer[512];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    content.append(buffer, read);
+  return content;
+}
+
+TEST_CASE("output_sink_file", "[json_struct][sink]")
+{
+  std::vector<Item> items(300);
+  for (size_t i = 0; i < items.size(); i++)
+    items[i].name = "item " + std::to_string(i);
+  FILE *file = tmpfile();
+  REQUIRE(file);
+  JS::FileSink sink(file, 100);
+  REQUIRE(serializeToSink(items, sink));
+  REQUIRE(sink.written() == expectedJson(items).size());
+  fflush(file);
+  REQUIRE(readFile(file) == expectedJson(items));
+  fclose(file);
+}
+
+#ifdef JS_POSIX_SINKS
+TEST_CASE("output_sink_fd", "[json_struct][sink]")
+{
+  std::vector<Item> items(300);
+  for (size_t i = 0; i < items.size(); i++)
+    items[i].name = "item " + std::to_string(i);
+  FILE *file = tmpfile();
+  REQUIRE(file);
+  JS::FdSink sink(fileno(file), 100);
+  REQUIRE(serializeToSink(items, sink));
+  REQUIRE(sink.written() == expectedJson(items).size());
+  REQUIRE(readFile(file) == expectedJson(items));
+  fclose(file);
+}
+
+TEST_CASE("output_sink_iovec", "[json_struct][sink]")
+{
+  std::vector<Item> items(10);
+  for (size_t i = 0; i < items.size(); i++)
+    items[i].name = "item " + std::to_string(i);
+  std::string expected = expectedJson(items);
+
+  std::vector<std::vector<char>> storage = {std::vector<char>(10), std::vector<char>(), std::vector<char>(33),
+                                            std::vector<char>(expected.size())};
+  std::vector<struct iovec> iov(storage.size());
+  for (size_t i = 0; i < storage.size(); i++)
+  {
+    iov[i].iov_base = storage[i].data();
+    iov[i].iov_len = storage[i].size();
+  }
+
+  JS::IovecSink sink(iov.data(), iov.size());
+  REQUIRE(serializeToSink(items, sink));
+  REQUIRE(sink.size() == expected.size());
+  REQUIRE(sink.usedCount() == 4);
+  REQUIRE(sink.lastUsed() == expected.size() - 43);
+  std::string gathered;
+  for (size_t i = 0; i < sink.usedCount(); i++)
+    gathered.append(storage[i].data(), i + 1 == sink.usedCount() ? sink.lastUsed() : storage[i].size());
+  REQUIRE(gathered == expected);
+
+  JS::IovecSink short_sink(iov.data(), 3);
+  REQUIRE(!serializeToSink(items, short_sink));
+  REQUIRE(short_sink.failed());
+  REQUIRE(short_sink.size() == 43);
+}
+#endif
+} // namespace
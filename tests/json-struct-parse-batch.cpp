@@ -0,0 +1,131 @@
+#define JS_STD_THREAD
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Message
+{
+  int id = 0;
+  std::string topic;
+  std::vector<double> values;
+  JS_OBJ(id, topic, values);
+};
+
+TEST_CASE("parse_batch_single_thread", "[json_struct][batch]")
+{
+  std::vector<std::string> documents;
+  for (size_t i = 0; i < 100; i++)
+    documents.push_back("{ \"id\": " + std::to_string(i) + ", \"topic\": \"topic-" + std::to_string(i % 7) +
+                        "\", \"values\": [ " + std::to_string(i) + ".5, 2.0 ] }");
+  std::vector<JS::DataRef> refs(documents.begin(), documents.end());
+  std::vector<Message> messages;
+  JS::BatchParseResult result = JS::parseBatch(refs, messages, 1);
+  REQUIRE(result.ok());
+  REQUIRE(result.errors.size() == 100);
+  REQUIRE(messages.size() == 100);
+  for (size_t i = 0; i < messages.size(); i++)
+  {
+    REQUIRE(result.errors[i] == JS::Error::NoError);
+    REQUIRE(messages[i].id == int(i));
+    REQUIRE(messages[i].topic == "topic-" + std::to_string(i % 7));
+    REQUIRE(messages[i].values.size() == 2);
+    REQUIRE(messages[i].values[0] == double(i) + 0.5);
+  }
+}
+
+TEST_CASE("parse_batch_many_threads", "[json_struct][batch]")
+{
+  std::vector<std::string> documents;
+  for (size_t i = 0; i < 5000; i++)
+    documents.push_back("{ \"id\": " + std::to_string(i) + ", \"values\": [ 1.5 ] }");
+  std::vector<JS::DataRef> refs(documents.begin(), documents.end());
+  std::vector<Message> messages;
+  JS::BatchParseResult result = JS::parseBatch(refs, messages, 4);
+  REQUIRE(result.ok());
+  REQUIRE(messages.size() == 5000);
+  for (size_t i = 0; i < messages.size(); i++)
+    REQUIRE(messages[i].id == int(i));
+}
+
+TEST_CASE("parse_batch_reports_failures_only", "[json_struct][batch]")
+{
+  std::vector<std::string> documents;
+  for (size_t i = 0; i < 64; i++)
+    documents.push_back("{ \"id\": " + std::to_string(i) + ", \"topic\": \"topic-" + std::to_string(i % 7) + "\" }");
+  documents[3] = "{ \"id\": 3, \"topic\": ";
+  documents[40] = "{ \"id\": \"not a number\" }";
+  std::vector<JS::DataRef> refs(documents.begin(), documents.end());
+  std::vector<Message> messages;
+  JS::BatchParseResult result = JS::parseBatch(refs, messages, 3);
+  REQUIRE(!result.ok());
+  REQUIRE(result.errors.size() == 64);
+  REQUIRE(result.errors[3] != JS::Error::NoError);
+  REQUIRE(result.errors[40] == JS::Error::FailedToParseInt);
+  REQUIRE(result.error_strings.size() == 2);
+  REQUIRE(result.error_strings[0].first == 3);
+  REQUIRE(result.error_strings[1].first == 40);
+  REQUIRE(!result.error_strings[1].second.empty());
+
+  // The documents after a failing one are parsed with a clean context
+  REQUIRE(result.errors[4] == JS::Error::NoError);
+  REQUIRE(messages[4].id == 4);
+  REQUIRE(messages[41].topic == "topic-" + std::to_string(41 % 7));
+}
+
+TEST_CASE("parse_batch_prototype_context", "[json_struct][batch]")
+{
+  std::vector<std::string> documents = {"{ \"id\": 1, \"extra\": true }", "{ \"id\": 2 }"};
+  std::vector<JS::DataRef> refs(documents.begin(), documents.end());
+  std::vector<Message> messages;
+
+  JS::ParseContext strict;
+  strict.allow_missing_members = false;
+  JS::BatchParseResult result = JS::parseBatch(refs, messages, 2, strict);
+  REQUIRE(result.errors[0] == JS::Error::MissingPropertyMember);
+  REQUIRE(result.errors[1] == JS::Error::NoError);
+  REQUIRE(result.error_strings.size() == 1);
+  REQUIRE(result.error_strings[0].second.find("extra") != std::string::npos);
+}
+
+struct Tagged
+{
+  JS::InternedString tag;
+  JS_OBJ(tag);
+};
+
+TEST_CASE("parse_batch_ignores_intern_pool", "[json_struct][batch]")
+{
+  std::vector<std::string> documents = {"{ \"tag\": \"a\" }", "{ \"tag\": \"b\" }", "{ \"tag\": \"a\" }"};
+  std::vector<JS::DataRef> refs(documents.begin(), documents.end());
+  std::vector<Tagged> tagged;
+
+  JS::InternPool pool;
+  JS::ParseContext prototype;
+  prototype.intern_pool = &pool;
+  JS::BatchParseResult result = JS::parseBatch(refs, tagged, 2, prototype);
+  REQUIRE(result.error_strings.size() == 3);
+  for (JS::Error error : result.errors)
+    REQUIRE(error == JS::Error::IllegalDataValue);
+  REQUIRE(result.error_strings[0].second.find("intern_pool") != std::string::npos);
+  REQUIRE(pool.size() == 0);
+}
+
+TEST_CASE("parse_context_reset", "[json_struct][batch]")
+{
+  JS::ParseContext context;
+  Message message;
+  std::string broken = "{ \"id\": [ 1, ";
+  context.reset(broken.data(), broken.size());
+  REQUIRE(context.parseTo(message) != JS::Error::NoError);
+
+  std::string valid = "{ \"id\": 7, \"topic\": \"t\" }";
+  context.reset(valid.data(), valid.size());
+  REQUIRE(context.parseTo(message) == JS::Error::NoError);
+  REQUIRE(message.id == 7);
+  REQUIRE(message.topic == "t");
+}
+} // namespace
@@ -0,0 +1,139 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <cmrc/cmrc.hpp>
+
+#include <string>
+#include <vector>
+
+CMRC_DECLARE(external_json);
+
+namespace
+{
+std::vector<JS::SerializerOptions> reformatOptions()
+{
+  std::vector<JS::SerializerOptions> options;
+  for (unsigned char shift : {0, 1, 2, 4})
+  {
+    for (auto style : {JS::SerializerOptions::Pretty, JS::SerializerOptions::Compact})
+    {
+      JS::SerializerOptions option(style);
+      option.setShiftSize(shift);
+      options.push_back(option);
+    }
+  }
+  return options;
+}
+
+// Checks that reformat gives the same result as the token path for every layout
+void requireSameAsTokens(const std::string &json)
+{
+  for (const JS::SerializerOptions &options : reformatOptions())
+  {
+    std::string out = "previous content";
+    std::string expected;
+    const JS::Error error = JS::reformat(json, out, options);
+    REQUIRE(error == JS::Internal::reformatTokens(json.data(), json.size(), expected, options));
+    REQUIRE(out == expected);
+  }
+}
+
+TEST_CASE("reformat_raw_generated", "[json_struct][reformat]")
+{
+  auto fs = cmrc::external_json::get_filesystem();
+  auto generated = fs.open("generated.json");
+  const std::string json(generated.begin(), generated.end());
+  requireSameAsTokens(json);
+
+  std::string raw;
+  REQUIRE(JS::Internal::reformatRaw(json.data(), json.size(), raw, JS::SerializerOptions()));
+
+  // Both outputs are strict JSON again
+  std::string compact;
+  std::string pretty;
+  REQUIRE(JS::reformat(json, compact, JS::SerializerOptions(JS::SerializerOptions::Compact)) == JS::Error::NoError);
+  REQUIRE(JS::reformat(compact, pretty) == JS::Error::NoError);
+  std::string compact_again;
+  REQUIRE(JS::reformat(pretty, compact_again, JS::SerializerOptions(JS::SerializerOptions::Compact)) ==
+          JS::Error::NoError);
+  REQUIRE(compact_again == compact);
+}
+
+TEST_CASE("reformat_raw_layout", "[json_struct][reformat]")
+{
+  std::string out;
+  REQUIRE(JS::reformat(" { \"a\" : [ 1 , { } , [ ] , \"x\" ] , \"b\" : { \"c\" : null } } ", out,
+                       JS::SerializerOptions(JS::SerializerOptions::Compact)) == JS::Error::NoError);
+  REQUIRE(out == R"({"a":[1,{},[],"x"],"b":{"c":null}})");
+
+  std::string pretty;
+  REQUIRE(JS::reformat(out, pretty) == JS::Error::NoError);
+  REQUIRE(pretty == "{\n  \"a\": [\n    1,\n    {\n    },\n    [\n    ],\n    \"x\"\n  ],\n"
+                    "  \"b\": {\n    \"c\": null\n  }\n}");
+
+  requireSameAsTokens("{}");
+  requireSameAsTokens("[]");
+  requireSameAsTokens("\t[ true,false ,null\r\n]\n");
+  requireSameAsTokens("[[[[[[[[1]]]]]]],{\"deep\":{\"deeper\":{\"deepest\":{\"end\":[{}]}}}}]");
+}
+
+TEST_CASE("reformat_raw_strings_and_numbers", "[json_struct][reformat]")
+{
+  requireSameAsTokens(R"({"escapes":"\"\\\/\b\f\n\r\t\u00e9\ud83d\ude00","empty":"","utf8":"caf)"
+                      "\xc3\xa9"
+                      R"(","key with spaces":"value"})");
+  requireSameAsTokens("[0,-0,1.5,-12.25e+10,3E-2,1e5,123456789012345678901234567890]");
+
+  // String lengths around the SIMD block sizes, with an escape at every position
+  for (size_t length : {1, 15, 16, 17, 31, 32, 33, 64, 65})
+  {
+    for (size_t pos = 0; pos < length; pos++)
+    {
+      std::string str(length, 'x');
+      str.replace(pos, 1, "\\n");
+      requireSameAsTokens("{\"" + str + "\":[\"" + str + "\"," + std::to_string(pos) + "]}");
+    }
+  }
+}
+
+TEST_CASE("reformat_raw_fallback", "[json_struct][reformat]")
+{
+  // Input the raw path does not take, which still has to give the token path result
+  requireSameAsTokens("{\"a\":1 // comment\n}");
+  requireSameAsTokens("{\"a\":1,}");
+  requireSameAsTokens("{a:1}");
+  requireSameAsTokens("{\"a\":1");
+  requireSameAsTokens("{\"a\":\"unterminated");
+  requireSameAsTokens("{\"a\":tru}");
+  requireSameAsTokens("{\"a\":01}");
+  requireSameAsTokens("{\"a\":1}}");
+  requireSameAsTokens("{\"a\" 1}");
+  requireSameAsTokens("[1 2]");
+  requireSameAsTokens("{\"a\":\"raw\ttab\"}");
+  requireSameAsTokens("\"top level string\"");
+  requireSameAsTokens("42");
+  requireSameAsTokens("");
+  requireSameAsTokens("{} {}");
+
+  std::string out;
+  REQUIRE(JS::reformat("{\"a\":1,}", out, JS::SerializerOptions(JS::SerializerOptions::Compact)) !=
+          JS::Error::NoError);
+
+  // Options the raw path does not write are handled by the Serializer
+  JS::SerializerOptions options(JS::SerializerOptions::Compact);
+  options.skipDelimiter(true);
+  REQUIRE(JS::reformat("[1,2]", out, options) == JS::Error::NoError);
+  REQUIRE(out == "[12]");
+
+  options = JS::SerializerOptions(JS::SerializerOptions::Pretty);
+  options.setEscapeNonAscii(true);
+  REQUIRE(JS::reformat("[\"\xc3\xa9\"]", out, options) == JS::Error::NoError);
+  REQUIRE(out == "[\n  \"\\u00e9\"\n]");
+
+  options = JS::SerializerOptions(JS::SerializerOptions::Pretty);
+  options.setDepth(1);
+  REQUIRE(JS::reformat("[1]", out, options) == JS::Error::NoError);
+  REQUIRE(out == "  [\n    1\n  ]");
+}
+
+} // namespace
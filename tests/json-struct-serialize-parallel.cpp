@@ -0,0 +1,102 @@
+#define JS_STD_THREAD
+#define JS_STL_MAP
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+struct Item
+{
+  int id = 0;
+  std::string name;
+  std::vector<double> weights;
+  JS_OBJ(id, name, weights);
+};
+
+TEST_CASE("serialize_parallel_vector", "[json_struct][parallel]")
+{
+  for (size_t count : {0, 1, 100, 1000, 4321})
+  {
+    std::vector<Item> items(count);
+    for (size_t i = 0; i < items.size(); i++)
+    {
+      items[i].id = int(i);
+      items[i].name = "item \"" + std::to_string(i) + "\"";
+      items[i].weights.assign(i % 4, double(i) / 4);
+    }
+    for (auto style : {JS::SerializerOptions::Pretty, JS::SerializerOptions::Compact})
+    {
+      JS::SerializerOptions options(style);
+      for (unsigned threads : {1u, 2u, 3u, 8u})
+        REQUIRE(JS::serializeParallel(items, options, threads) == JS::serializeStruct(items, options));
+    }
+  }
+}
+
+TEST_CASE("serialize_parallel_options", "[json_struct][parallel]")
+{
+  std::vector<Item> items(2000);
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    items[i].id = int(i);
+    items[i].name = "item \"" + std::to_string(i) + "\"";
+    items[i].weights.assign(i % 4, double(i) / 4);
+  }
+
+  JS::SerializerOptions shifted;
+  shifted.setShiftSize(4);
+  REQUIRE(JS::serializeParallel(items, shifted, 4) == JS::serializeStruct(items, shifted));
+
+  // Deeper than the indentation literals of the pretty fast path
+  JS::SerializerOptions deep;
+  deep.setDepth(6);
+  REQUIRE(JS::serializeParallel(items, deep, 4) == JS::serializeStruct(items, deep));
+
+  JS::SerializerOptions no_delimiter;
+  no_delimiter.skipDelimiter(true);
+  REQUIRE(JS::serializeParallel(items, no_delimiter, 4) == JS::serializeStruct(items, no_delimiter));
+
+  std::vector<int> numbers(5000);
+  for (size_t i = 0; i < numbers.size(); i++)
+    numbers[i] = int(i * 7);
+  REQUIRE(JS::serializeParallel(numbers, JS::SerializerOptions(), 4) == JS::serializeStruct(numbers));
+}
+
+TEST_CASE("serialize_parallel_map", "[json_struct][parallel]")
+{
+  std::map<std::string, Item> map;
+  std::unordered_map<std::string, int> unordered;
+  std::vector<Item> items(1500);
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    items[i].id = int(i);
+    items[i].name = "item \"" + std::to_string(i) + "\"";
+    items[i].weights.assign(i % 4, double(i) / 4);
+  }
+  for (auto &item : items)
+  {
+    map["key_" + std::to_string(item.id)] = item;
+    unordered["key_" + std::to_string(item.id)] = item.id;
+  }
+
+  for (auto style : {JS::SerializerOptions::Pretty, JS::SerializerOptions::Compact})
+  {
+    JS::SerializerOptions options(style);
+    const std::string json = JS::serializeParallel(map, options, 4);
+    REQUIRE(json == JS::serializeStruct(map, options));
+    REQUIRE(JS::serializeParallel(unordered, options, 4) == JS::serializeStruct(unordered, options));
+
+    std::map<std::string, Item> parsed;
+    JS::ParseContext context(json);
+    REQUIRE(context.parseTo(parsed) == JS::Error::NoError);
+    REQUIRE(parsed.size() == map.size());
+    REQUIRE(parsed["key_1499"].name == map["key_1499"].name);
+  }
+}
+
+} // namespace
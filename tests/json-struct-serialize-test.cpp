@@ -156,6 +156,95 @@ TEST_CASE("serialize_test_compact", "[json_struct][serialize]")
   REQUIRE(output == expected3);
 }
 
+const char compact_tokens_json[] = R"json({
+  "name": "compact",
+  "empty": "",
+  "nothing": null,
+  "flags": [true, false, null],
+  "nested": { "a": [1, 2, { "b": [] }], "c": {} },
+  "escaped": "a\"b"
+})json";
+const char compact_tokens_expected[] =
+  R"json({"name":"compact","empty":"","nothing":null,"flags":[true,false,null],"nested":{"a":[1,2,{"b":[]}],"c":{}},"escaped":"a\"b"})json";
+
+TEST_CASE("serialize_compact_small_buffers", "[json_struct][serialize]")
+{
+  JS::JsonTokens tokens;
+  JS::ParseContext context(compact_tokens_json);
+  REQUIRE(context.parseTo(tokens) == JS::Error::NoError);
+
+  std::string output = JS::serializeStruct(tokens, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  REQUIRE(output == compact_tokens_expected);
+
+  // Every token crosses a buffer boundary at some point with 5 byte buffers.
+  std::string chunked;
+  char buffer[5];
+  JS::Serializer serializer(buffer, sizeof(buffer));
+  serializer.setOptions(JS::SerializerOptions(JS::SerializerOptions::Compact));
+  // The callback is only asked for a new buffer when the current one is full.
+  serializer.setRequestBufferCallback([&chunked, &buffer](JS::Serializer &serializer_p) {
+    chunked.append(buffer, sizeof(buffer));
+    serializer_p.setBuffer(buffer, sizeof(buffer));
+  });
+  JS::Token token;
+  JS::TypeHandler<JS::JsonTokens>::from(tokens, token, serializer);
+  chunked.append(buffer, serializer.currentBuffer().used);
+  REQUIRE(chunked == compact_tokens_expected);
+}
+
+struct KeyLengths
+{
+  int a = 1;
+  int thirteen_char = 2;
+  int fourteen_chars = 3;
+  int a_member_name_that_is_longer_than_32 = 4;
+  std::vector<int> list = {5, 6};
+  JS_OBJECT(JS_MEMBER(a), JS_MEMBER(thirteen_char), JS_MEMBER(fourteen_chars),
+            JS_MEMBER(a_member_name_that_is_longer_than_32), JS_MEMBER_WITH_NAME(list, "renamed list"));
+};
+
+const char key_lengths_compact[] =
+  R"json({"a":1,"thirteen_char":2,"fourteen_chars":3,"a_member_name_that_is_longer_than_32":4,"renamed list":[5,6]})json";
+const char key_lengths_pretty[] = R"json({
+  "a": 1,
+  "thirteen_char": 2,
+  "fourteen_chars": 3,
+  "a_member_name_that_is_longer_than_32": 4,
+  "renamed list": [
+    5,
+    6
+  ]
+})json";
+
+TEST_CASE("serialize_member_keys", "[json_struct][serialize]")
+{
+  KeyLengths key_lengths;
+  REQUIRE(JS::serializeStruct(key_lengths, JS::SerializerOptions(JS::SerializerOptions::Compact)) ==
+          key_lengths_compact);
+  REQUIRE(JS::serializeStruct(key_lengths) == key_lengths_pretty);
+
+  for (size_t buffer_size = 1; buffer_size < 48; buffer_size++)
+  {
+    std::string chunked;
+    std::vector<char> buffer(buffer_size);
+    JS::Serializer serializer(buffer.data(), buffer.size());
+    serializer.setOptions(JS::SerializerOptions(JS::SerializerOptions::Compact));
+    serializer.setRequestBufferCallback([&chunked, &buffer](JS::Serializer &serializer_p) {
+      chunked.append(buffer.data(), buffer.size());
+      serializer_p.setBuffer(buffer.data(), buffer.size());
+    });
+    JS::Token token;
+    JS::TypeHandler<KeyLengths>::from(key_lengths, token, serializer);
+    chunked.append(buffer.data(), serializer.currentBuffer().used);
+    REQUIRE(chunked == key_lengths_compact);
+  }
+
+  JS::SerializerOptions unquoted(JS::SerializerOptions::Compact);
+  unquoted.setConvertAsciiToString(false);
+  REQUIRE(JS::serializeStruct(key_lengths, unquoted) ==
+          "{a:1,thirteen_char:2,fourteen_chars:3,a_member_name_that_is_longer_than_32:4,renamed list:[5,6]}");
+}
+
 TEST_CASE("test_serialize_big", "[json_struct][serialize]")
 {
   auto fs = cmrc::external_json::get_filesystem();
@@ -0,0 +1,76 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Entry
+{
+  std::string name;
+  int value = 0;
+  std::vector<double> samples;
+  JS_OBJ(name, value, samples);
+};
+
+TEST_CASE("serialized_size_matches_output", "[json_struct][serialize]")
+{
+  for (size_t count : {size_t(0), size_t(1), size_t(10), size_t(1000)})
+  {
+    std::vector<Entry> entries(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      entries[i].name = "entry \"" + std::to_string(i) + "\"";
+      entries[i].value = int(i * 37);
+      entries[i].samples = {double(i) / 3, 1e10 + double(i)};
+    }
+    REQUIRE(JS::serializedSize(entries) == JS::serializeStruct(entries).size());
+    JS::SerializerOptions compact(JS::SerializerOptions::Compact);
+    REQUIRE(JS::serializedSize(entries, compact) == JS::serializeStruct(entries, compact).size());
+  }
+}
+
+const char entries_json[] = R"json([
+  {
+    "name": "entry \"0\"",
+    "value": 0,
+    "samples": [0.5, 10000000000.0]
+  },
+  {
+    "name": "entry \"1\"",
+    "value": -37,
+    "samples": [0.3333333333333333, 1e-300]
+  },
+  {
+    "name": "",
+    "value": 2147483647,
+    "samples": []
+  }
+])json";
+
+TEST_CASE("serialize_to_exact_buffer", "[json_struct][serialize]")
+{
+  std::vector<Entry> entries;
+  JS::ParseContext context(entries_json);
+  REQUIRE(context.parseTo(entries) == JS::Error::NoError);
+  JS::SerializerOptions compact(JS::SerializerOptions::Compact);
+  std::string expected = JS::serializeStruct(entries, compact);
+
+  std::string exact(JS::serializedSize(entries, compact), '\0');
+  REQUIRE(JS::serializeTo(entries, &exact[0], exact.size(), compact) == exact.size());
+  REQUIRE(exact == expected);
+}
+
+TEST_CASE("serialize_to_truncated_buffer", "[json_struct][serialize]")
+{
+  std::vector<Entry> entries;
+  JS::ParseContext context(entries_json);
+  REQUIRE(context.parseTo(entries) == JS::Error::NoError);
+  std::string expected = JS::serializeStruct(entries);
+
+  std::vector<char> buffer(expected.size() / 2, 'x');
+  REQUIRE(JS::serializeTo(entries, buffer.data(), buffer.size()) == expected.size());
+  REQUIRE(std::string(buffer.data(), buffer.size()) == expected.substr(0, buffer.size()));
+}
+} // namespace
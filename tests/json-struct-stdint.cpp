@@ -21,6 +21,8 @@
  */
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 #include <json_struct/json_struct.h>
 
 #include "catch2/catch_all.hpp"
@@ -78,6 +80,89 @@ TEST_CASE("large_number_roundtrip", "json_struct")
 
   REQUIRE(to_serialize.uint64 == to_struct.uint64);
 }
+
+struct integer_limits
+{
+  int8_t int8;
+  int32_t int32;
+  int64_t int64_min;
+  int64_t int64_max;
+  uint64_t uint64;
+  std::vector<int64_t> values;
+  JS_OBJ(int8, int32, int64_min, int64_max, uint64, values);
+};
+
+TEST_CASE("integer_parse_digit_counts", "json_struct")
+{
+  const char json[] = R"json({
+  "int8": 300,
+  "int32": -00012345678,
+  "int64_min": -9223372036854775808,
+  "int64_max": 9223372036854775807,
+  "uint64": 18446744073709551615,
+  "values": [ 0, -0, 7, 12345678, 87654321, 1234567890123456, 1234567890123456789, -999999999999999999, 2e3, 15.0 ]
+})json";
+
+  integer_limits to_struct = {};
+  JS::ParseContext context(json);
+  auto error = context.parseTo(to_struct);
+  REQUIRE(error == JS::Error::NoError);
+  REQUIRE(to_struct.int8 == 127);
+  REQUIRE(to_struct.int32 == -12345678);
+  REQUIRE(to_struct.int64_min == INT64_MIN);
+  REQUIRE(to_struct.int64_max == INT64_MAX);
+  REQUIRE(to_struct.uint64 == UINT64_MAX);
+  REQUIRE(to_struct.values.size() == 10);
+  REQUIRE(to_struct.values[0] == 0);
+  REQUIRE(to_struct.values[1] == 0);
+  REQUIRE(to_struct.values[2] == 7);
+  REQUIRE(to_struct.values[3] == 12345678);
+  REQUIRE(to_struct.values[4] == 87654321);
+  REQUIRE(to_struct.values[5] == 1234567890123456);
+  REQUIRE(to_struct.values[6] == 1234567890123456789);
+  REQUIRE(to_struct.values[7] == -999999999999999999);
+  REQUIRE(to_struct.values[8] == 2000);
+  REQUIRE(to_struct.values[9] == 15);
+
+  std::string serialized = JS::serializeStruct(to_struct);
+  integer_limits roundtrip = {};
+  JS::ParseContext roundtrip_context(serialized);
+  REQUIRE(roundtrip_context.parseTo(roundtrip) == JS::Error::NoError);
+  REQUIRE(roundtrip.int64_min == INT64_MIN);
+  REQUIRE(roundtrip.int64_max == INT64_MAX);
+  REQUIRE(roundtrip.values == to_struct.values);
+}
+
+TEST_CASE("integer_to_buffer", "json_struct")
+{
+  char buffer[32];
+  int digits_truncated = -1;
+  int size = JS::Internal::ft::integer::to_buffer(int64_t(0), buffer, int(sizeof(buffer)), &digits_truncated);
+  REQUIRE(std::string(buffer, size_t(size)) == "0");
+  REQUIRE(digits_truncated == 0);
+
+  size = JS::Internal::ft::integer::to_buffer(INT64_MIN, buffer, int(sizeof(buffer)), &digits_truncated);
+  REQUIRE(std::string(buffer, size_t(size)) == "-9223372036854775808");
+
+  size = JS::Internal::ft::integer::to_buffer(UINT64_MAX, buffer, int(sizeof(buffer)), &digits_truncated);
+  REQUIRE(std::string(buffer, size_t(size)) == "18446744073709551615");
+
+  uint64_t value = 1;
+  std::string expected = "1";
+  for (int i = 0; i < 19; i++)
+  {
+    size = JS::Internal::ft::integer::to_buffer(value, buffer, int(sizeof(buffer)), &digits_truncated);
+    REQUIRE(std::string(buffer, size_t(size)) == expected);
+    size = JS::Internal::ft::integer::to_buffer(value - 1, buffer, int(sizeof(buffer)), &digits_truncated);
+    REQUIRE(size == (i == 0 ? 1 : i));
+    value *= 10;
+    expected += '0';
+  }
+
+  size = JS::Internal::ft::integer::to_buffer(int32_t(-123456789), buffer, 5, &digits_truncated);
+  REQUIRE(std::string(buffer, size_t(size)) == "-1234");
+  REQUIRE(digits_truncated == 5);
+}
 }
 
 #if defined(__SIZEOF_INT128__)
@@ -0,0 +1,84 @@
+#include <json_struct/json_struct.h>
+#include "catch2/catch_all.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Row
+{
+  int id = 0;
+  std::string label;
+  JS_OBJ(id, label);
+};
+
+struct Export
+{
+  int count = 0;
+  std::vector<Row> rows;
+  JS_OBJ(count, rows);
+};
+
+TEST_CASE("stream_serializer_generator", "[json_struct][stream]")
+{
+  Export expected;
+  expected.count = 1000;
+  expected.rows.resize(1000);
+  for (int i = 0; i < expected.count; i++)
+  {
+    expected.rows[size_t(i)].id = i;
+    expected.rows[size_t(i)].label = "row " + std::to_string(i);
+  }
+
+  for (auto style : {JS::SerializerOptions::Pretty, JS::SerializerOptions::Compact})
+  {
+    JS::SegmentedSink sink(128);
+    JS::StreamSerializer stream(sink, JS::SerializerOptions(style));
+    stream.beginObject();
+    stream.write("count", expected.count);
+    int next = 0;
+    stream.writeArrayFrom<Row>("rows", [&](Row &row) {
+      if (next == expected.count)
+        return false;
+      row.id = next;
+      row.label = "row " + std::to_string(next++);
+      return true;
+    });
+    stream.endObject();
+    REQUIRE(stream.finish());
+    REQUIRE(sink.toString() == JS::serializeStruct(expected, JS::SerializerOptions(style)));
+  }
+}
+
+TEST_CASE("stream_serializer_range", "[json_struct][stream]")
+{
+  std::list<Row> rows(3);
+  rows.front().label = "first";
+  rows.back().id = 2;
+
+  JS::BufferSink sink;
+  JS::StreamSerializer stream(sink, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  stream.writeArray(rows);
+  REQUIRE(stream.finish());
+  REQUIRE(sink.toString() == R"([{"id":0,"label":"first"},{"id":0,"label":""},{"id":2,"label":""}])");
+}
+
+TEST_CASE("stream_serializer_sink_failure", "[json_struct][stream]")
+{
+  char buffer[64];
+  JS::FixedBufferSink sink(buffer, sizeof(buffer));
+  JS::StreamSerializer stream(sink, JS::SerializerOptions(JS::SerializerOptions::Compact));
+  int next = 0;
+  stream.writeArrayFrom<Row>([&](Row &row) {
+    row.id = next++;
+    return next < 100;
+  });
+  REQUIRE(!stream.finish());
+  REQUIRE(stream.failed());
+  REQUIRE(next < 10);
+  REQUIRE(sink.size() == sizeof(buffer));
+  REQUIRE(std::string(buffer, 8) == R"([{"id":0)");
+}
+} // namespace
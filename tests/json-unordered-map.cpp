@@ -1,6 +1,8 @@
 #include <json_struct/json_struct.h>
 #include "catch2/catch_all.hpp"
 
+#include <string>
+
 #define JS_STL_UNORDERED_SET
 #include <json_struct/json_struct.h>
 
@@ -66,4 +68,38 @@ TEST_CASE("unordered_map_complex_value", "json_struct")
 
   REQUIRE(dataStruct2.unordered_map == dataStruct.unordered_map);
 }
+
+struct Point
+{
+  int x = 0;
+  int y = 0;
+  JS_OBJ(x, y);
+};
+
+TEST_CASE("map_duplicate_and_escaped_keys", "json_struct")
+{
+  const char attributes_json[] = R"json({
+  "a": "first",
+  "b\"quoted\"": "escaped",
+  "a": "second",
+  "\u00e6": "unicode"
+})json";
+  std::unordered_map<std::string, std::string> attributes;
+  attributes["kept"] = "value";
+  JS::ParseContext attributes_context(attributes_json);
+  REQUIRE(attributes_context.parseTo(attributes) == JS::Error::NoError);
+  REQUIRE(attributes.size() == 4);
+  REQUIRE(attributes["a"] == "second");
+  REQUIRE(attributes["b\"quoted\""] == "escaped");
+  REQUIRE(attributes["\xc3\xa6"] == "unicode");
+  REQUIRE(attributes["kept"] == "value");
+
+  // A repeated key starts from a default value instead of merging into the previous one.
+  const char points_json[] = R"json({ "p": { "x": 1, "y": 2 }, "p": { "y": 3 } })json";
+  std::map<std::string, Point> points;
+  JS::ParseContext points_context(points_json);
+  REQUIRE(points_context.parseTo(points) == JS::Error::NoError);
+  REQUIRE(points["p"].x == 0);
+  REQUIRE(points["p"].y == 3);
+}
 } // namespace